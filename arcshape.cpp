@@ -1,13 +1,93 @@
 #include "arcshape.h"
 #include "drawengine.h"
+#include "stroker.h"
+#include "scanlinefiller.h"
 #include <cmath>
 #include <QtMath>
 
+namespace {
+
+// draw() 中 8 个对称点各自所在 45° 扇区的起始角（°），顺序与 points 一致：
+// (x, y) (-x, y) (x, -y) (-x, -y) (y, x) (-y, x) (y, -x) (-y, -x)，其中 0 <= x <= y
+const int OCTANT_START[8] = {45, 90, 270, 225, 0, 135, 315, 180};
+
+/**
+ * @brief 圆弧角度范围的八分区判定
+ * 起止角只换算一次：每个扇区预先分为整段绘制、整段跳过与逐点判断三类，
+ * 只有包含起止角的扇区需要逐点判断，用整数叉积代替 atan2：
+ * 边界方向放大 2^30 取整，cross(u, v) >= 0 即 v 的方位角不小于边界角（扇区只有 45°，两者相差不超过 180°）
+ * 角度约定与原先的 atan2 判定一致：方位角取 [0°, 360°)，(r, 0) 的方位角为 0°
+ */
+class ArcRange
+{
+public:
+    enum Mode { Skip, Draw, Test };
+
+    ArcRange(double startDeg, double endDeg, bool fullCircle)
+        : wrap(startDeg > endDeg)
+    {
+        double s = std::fmod(startDeg, 360.0);
+        double e = std::fmod(endDeg, 360.0);
+        if (s < 0) s += 360.0;
+        if (e < 0) e += 360.0;
+        startDir = direction(s);
+        endDir = direction(e);
+
+        for (int k = 0; k < 8; ++k)
+        {
+            if (fullCircle)
+            {
+                modes[k] = Draw;
+                continue;
+            }
+            const int a = OCTANT_START[k];
+            afterStart[k] = s <= a ? 1 : (s > a + 45 ? 0 : -1);         // -1：逐点判断
+            beforeEnd[k] = e >= a + 45 ? 1 : (e < a ? 0 : -1);
+            if (afterStart[k] < 0 || beforeEnd[k] < 0)
+                modes[k] = Test;
+            else
+                modes[k] = combine(afterStart[k] != 0, beforeEnd[k] != 0) ? Draw : Skip;
+        }
+    }
+
+    Mode mode(int k) const { return modes[k]; }
+
+    // 扇区 k 内相对圆心偏移 (dx, dy) 的点是否在圆弧范围内（mode(k) == Test 时使用）
+    bool contains(int k, int dx, int dy) const
+    {
+        const bool s = afterStart[k] >= 0 ? afterStart[k] != 0 : cross(startDir, dx, dy) >= 0;
+        const bool e = beforeEnd[k] >= 0 ? beforeEnd[k] != 0 : cross(endDir, dx, dy) <= 0;
+        return combine(s, e);
+    }
+
+private:
+    struct Dir { qint64 x, y; };
+
+    static Dir direction(double deg)
+    {
+        const double rad = qDegreesToRadians(deg);
+        const double scale = double(1 << 30);
+        return {std::llround(std::cos(rad) * scale), std::llround(std::sin(rad) * scale)};
+    }
+    static qint64 cross(const Dir& u, int dx, int dy) { return u.x * dy - u.y * dx; }
+
+    // 跨越 0° 时取并集，否则取交集
+    bool combine(bool s, bool e) const { return wrap ? (s || e) : (s && e); }
+
+    bool wrap;
+    Dir startDir, endDir;
+    Mode modes[8];
+    qint8 afterStart[8] = {};                                           // 方位角 >= 起始角：1 恒真 / 0 恒假 / -1 逐点
+    qint8 beforeEnd[8] = {};                                            // 方位角 <= 终止角
+};
+
+} // namespace
+
 /**
  * @brief 默认构造函数：初始化为无效圆弧
  */
 ArcShape::ArcShape()
-    : center(0, 0), radius(0), startAngle(0), endAngle(0), color(Qt::black)
+    : Shape(ShapeKind::Arc), center(0, 0), radius(0), startAngle(0), endAngle(0)
 {
 }
 
@@ -20,8 +100,9 @@ ArcShape::ArcShape()
  * @param color 颜色
  */
 ArcShape::ArcShape(const QPoint& c, int r, double startAngleDeg, double endAngleDeg, const QColor& color)
-    : center(c), radius(r), startAngle(startAngleDeg), endAngle(endAngleDeg), color(color)
+    : Shape(ShapeKind::Arc), center(c), radius(r), startAngle(startAngleDeg), endAngle(endAngleDeg)
 {
+    this->color = color;
 }
 
 /**
@@ -33,63 +114,74 @@ ArcShape::ArcShape(const QPoint& c, int r, double startAngleDeg, double endAngle
  * 通过判断中点是否在圆内决定是否减少 y
  *
  * 每个计算得到的点 (x, y) 可以利用八对称性生成 8 个圆上像素点。
- * 在此基础上，额外判断每个点是否处于指定角度范围内。
+ * 在此基础上，额外判断每个点是否处于指定角度范围内：
+ * 角度范围在绘制前换算为 8 个扇区的分类（ArcRange），逐点只查表，起止角所在扇区做整数叉积判断
+ *
+ * 线宽大于 1 或开启抗锯齿时，圆弧先折线化，再由 Stroker 生成带线帽的描边轮廓并扫描线（覆盖率）填充；
+ * 累积变换为非等比缩放或错切时按映射后的椭圆弧绘制（drawEllipticArc）
  */
 void ArcShape::draw(DrawEngine* engine)
 {
     if (!engine || radius <= 0) return;
 
-    // 1. 初始化中点圆参数
-    int x = 0;
-    int y = radius;
-    int d = 1 - radius;                                                 // 初始判别值 d0 = 1 - r
-
-    bool rotateFullCircle = false;                                      // 旋转结束后圆弧是否跨越 0°
-    if (startAngle > endAngle) rotateFullCircle = true;
-
-    // 2. 角度范围准备，将角度转换为弧度
-    double startRad = qDegreesToRadians(startAngle);
-    double endRad = qDegreesToRadians(endAngle);
-
-    int cx = center.x();
-    int cy = center.y();
-
-    // 辅助函数：判断点(px, py)是否落在圆弧角度范围内
-    auto inArcRange = [&](int px, int py) {
-        // Qt 坐标系中：y 轴向下，因此使用 atan2(py - cy, px - cx)
-        double angle = atan2(py - cy, px - cx);
-        if (angle < 0) angle += 2 * M_PI;                               // 保证角度为 [0, 2π)
+    // 累积变换不是相似变换时结果为椭圆弧
+    QPoint c;
+    int r;
+    double start, end;
+    if (!resolvedCircle(&c, &r, &start, &end))
+    {
+        drawEllipticArc(engine);
+        return;
+    }
+    if (r <= 0) return;
+    const double sweep = sweepOf(start, end);
 
+    if (penWidth > 1 || engine->isAntialiasing())
+    {
+        if (sweep <= 0) return;
+        std::vector<QPointF> path = Stroker::arcPolyline(QPointF(c), r, start, sweep);
+        strokePath(engine, path, sweep >= 360.0);
+        return;
+    }
 
-        double start = fmod(startRad, 2 * M_PI);
-        double end = fmod(endRad, 2 * M_PI);
-        if (start < 0) start += 2 * M_PI;                               // 跨越 0° 时修正范围
-        if (end < 0) end += 2* M_PI;
+    // 1. 初始化中点圆参数
+    int x = 0;
+    int y = r;
+    int d = 1 - r;                                                 // 初始判别值 d0 = 1 - r
 
-        return rotateFullCircle ? (angle >= start || angle <= end) : (angle >= start && angle <= end);
-    };
+    // 2. 角度范围换算为 8 个扇区的分类（startAngle > endAngle 时圆弧跨越 0°）
+    const ArcRange range(start, end, sweep >= 360.0);
 
     // 3. 绘制八对称点
     int step = 0;
+    const QRgb rgb = color.rgb();
     auto drawSymmetricPoints = [&](int x, int y) {
-        int cx = center.x();
-        int cy = center.y();
-
-        // 八对称点（圆的 8 个象限）
-        int points[8][2] = {
-            {cx + x, cy + y}, {cx - x, cy + y},
-            {cx + x, cy - y}, {cx - x, cy - y},
-            {cx + y, cy + x}, {cx - y, cy + x},
-            {cx + y, cy - x}, {cx - y, cy - x}
+        int cx = c.x();
+        int cy = c.y();
+
+        // 八对称点（圆的 8 个象限）的相对偏移
+        const int offsets[8][2] = {
+            {x, y}, {-x, y},
+            {x, -y}, {-x, -y},
+            {y, x}, {-y, x},
+            {y, -x}, {-y, -x}
         };
 
         // 仅绘制处于圆弧角度范围内的点
-        for (auto& p : points)
-            if (inArcRange(p[0], p[1]))
-            {
-                engine->drawStyledPixelAtStep(p[0], p[1], color, step, lineStyle, penWidth, dashOffset);
-                ++step;
-            }
+        for (int k = 0; k < 8; ++k)
+        {
+            // x == 0 时 (y, -x) 即 (r, 0)，方位角为 0° 而不是 360°，与 (y, x) 同样判定
+            const int sector = (k == 6 && x == 0) ? 4 : k;
+            const ArcRange::Mode mode = range.mode(sector);
+            if (mode == ArcRange::Skip) continue;
+
+            const int dx = offsets[k][0], dy = offsets[k][1];
+            if (mode == ArcRange::Test && !range.contains(sector, dx, dy)) continue;
+
+            if (engine->shouldDrawAtStep(step, lineStyle, 1, dashOffset))
+                engine->setPixelRgb(cx + dx, cy + dy, rgb);
+            ++step;
+        }
     };
 
     // 4. 主循环：中点判别递推
@@ -111,10 +203,191 @@ void ArcShape::draw(DrawEngine* engine)
     }
 }
 
-// 圆的重心就是圆心
-QPointF ArcShape::centroid() const
+/**
+ * @brief 圆弧扫过的角度（°，[0, 360]），与中点算法的角度判定一致：
+ * 起止角先规范到 [0°, 360°)；startAngle > endAngle 时圆弧跨越 0°，
+ * 否则只覆盖 [start, end]（规范后 start > end 时为空）；
+ * endAngle - startAngle >= 360° 视为整圆
+ */
+double ArcShape::sweepOf(double startDeg, double endDeg)
 {
-    return QPointF(center);
+    if (endDeg - startDeg >= 360.0) return 360.0;
+
+    double s = std::fmod(startDeg, 360.0);
+    double e = std::fmod(endDeg, 360.0);
+    if (s < 0) s += 360.0;
+    if (e < 0) e += 360.0;
+
+    if (startDeg > endDeg)
+        return e >= s ? 360.0 : e + 360.0 - s;
+    return e >= s ? e - s : 0.0;
 }
 
+/**
+ * @brief 源圆弧经 matrix 映射后的圆弧
+ * matrix 为相似变换（等比缩放 + 旋转 + 平移，可含镜像）时结果仍是圆弧：
+ * 圆心直接映射，半径乘以缩放倍数，起点方向映射后的角度作为新的起始角，扫过角度不变；
+ * 行列式为负（镜像）时方向反转，改从终点方向计算
+ * @return false 表示 matrix 含非等比缩放或错切，结果为椭圆弧（输出参数不填）
+ */
+bool ArcShape::resolvedCircle(QPoint* c, int* r, double* start, double* end) const
+{
+    if (matrix.isIdentity())
+    {
+        *c = center;
+        *r = radius;
+        *start = startAngle;
+        *end = endAngle;
+        return true;
+    }
+
+    const double a = std::hypot(matrix.m11(), matrix.m12());
+    const double b = std::hypot(matrix.m21(), matrix.m22());
+    const double dot = matrix.m11() * matrix.m21() + matrix.m12() * matrix.m22();
+    const double eps = 1e-9 * std::max(a, b);
+    if (std::fabs(a - b) > eps || std::fabs(dot) > eps * std::max(a, b))
+        return false;
+
+    const double sweep = sweepAngle();
+    const bool mirrored = matrix.determinant() < 0;
+    const double fromRad = qDegreesToRadians(mirrored ? startAngle + sweep : startAngle);
+
+    // 只用线性部分变换方向向量（与平移无关）
+    const QPointF dir(std::cos(fromRad), std::sin(fromRad));
+    const QPointF mappedDir(matrix.m11() * dir.x() + matrix.m21() * dir.y(),
+                            matrix.m12() * dir.x() + matrix.m22() * dir.y());
+
+    double deg = qRadiansToDegrees(std::atan2(mappedDir.y(), mappedDir.x()));
+    deg = std::fmod(deg + 360.0, 360.0);
+
+    *c = matrix.map(QPointF(center)).toPoint();
+    *r = std::max(0, int(std::round(radius * a)));
+    *start = deg;
+    *end = sweep >= 360.0 ? deg + 360.0 : std::fmod(deg + sweep, 360.0);
+    return true;
+}
+
+// 折线描边（线宽大于 1 或抗锯齿）：整圆首尾重合，按闭合折线描边
+// 抗锯齿时按曲线生成整体偏移轮廓，避免逐段部件在边缘上重叠使覆盖率偏大
+void ArcShape::strokePath(DrawEngine* engine, std::vector<QPointF>& path, bool closed) const
+{
+    ScanlineFiller& filler = engine->scanlineFiller();
+    Stroker stroker(penWidth, lineCap, lineJoin);
+    stroker.setCurve(engine->isAntialiasing());
+    if (closed) path.pop_back();
+    stroker.stroke(path, closed, lineStyle, dashOffset, filler);
+    filler.fill(engine, color.rgb(), FillRule::NonZero);
+}
+
+/**
+ * @brief 椭圆弧：源圆弧在放大后的半径上折线化（弦高误差按映射后最大半径计算，不超过 1/4 像素），
+ * 再整体经 matrix 映射；线宽 1 时逐段 Bresenham 连接，线型步数在各段之间连续
+ */
+void ArcShape::drawEllipticArc(DrawEngine* engine) const
+{
+    const double sweep = sweepAngle();
+    if (sweep <= 0) return;
+
+    std::vector<QPointF> path = mappedPolyline(sweep);
+    if (path.empty()) return;
+
+    if (penWidth > 1 || engine->isAntialiasing())
+    {
+        strokePath(engine, path, sweep >= 360.0);
+        return;
+    }
+
+    const QRgb rgb = color.rgb();
+    int step = 0;
+    for (std::size_t i = 1; i < path.size(); ++i)
+    {
+        int x0 = qRound(path[i - 1].x()), y0 = qRound(path[i - 1].y());
+        const int x1 = qRound(path[i].x()), y1 = qRound(path[i].y());
+        const int dx = std::abs(x1 - x0), sx = x0 < x1 ? 1 : -1;
+        const int dy = -std::abs(y1 - y0), sy = y0 < y1 ? 1 : -1;
+        int err = dx + dy;
+        bool first = i > 1;                                             // 段首像素已由上一段画过
+        for (;;)
+        {
+            if (!first)
+            {
+                if (engine->shouldDrawAtStep(step, lineStyle, 1, dashOffset))
+                    engine->setPixelRgb(x0, y0, rgb);
+                ++step;
+            }
+            first = false;
+            if (x0 == x1 && y0 == y1) break;
+            const int e2 = 2 * err;
+            if (e2 >= dy) { err += dy; x0 += sx; }
+            if (e2 <= dx) { err += dx; y0 += sy; }
+        }
+    }
+}
+
+std::vector<QPointF> ArcShape::mappedPolyline(double sweep) const
+{
+    // 最大缩放倍数的上界（线性部分的 Frobenius 范数）
+    const double k = std::sqrt(matrix.m11() * matrix.m11() + matrix.m12() * matrix.m12()
+                               + matrix.m21() * matrix.m21() + matrix.m22() * matrix.m22());
+    if (k <= 0) return {};
+
+    std::vector<QPointF> path = Stroker::arcPolyline(QPointF(0, 0), radius * k, startAngle, sweep);
+    const QPointF c(center);
+    for (QPointF& p : path)
+        p = matrix.map(c + p / k);
+    return path;
+}
+
+/**
+ * @brief 点选：圆弧（或椭圆弧）折线化后求最短距离，对相似变换与一般仿射变换一视同仁
+ */
+bool ArcShape::contains(const QPoint& pt) const
+{
+    if (radius <= 0) return false;
+    const double sweep = sweepAngle();
+    if (sweep <= 0) return false;
 
+    const std::vector<QPointF> path = mappedPolyline(sweep);
+    if (path.empty()) return false;
+    return Stroker::polylineDistance(path, false, QPointF(pt)) <= DrawEngine::HIT_TOLERANCE + penWidth * 0.5;
+}
+
+/**
+ * @brief 包围盒：取整圆（或映射后整椭圆）的外接矩形（按加粗半径扩展），半径无效时不绘制
+ * 椭圆 c + r·(cosθ, sinθ)·M 在 x、y 方向的半宽分别为 r·|(m11, m21)|、r·|(m12, m22)|
+ */
+QRect ArcShape::boundingRect() const
+{
+    if (radius <= 0) return QRect();
+
+    QPoint c;
+    int r;
+    double start, end;
+    if (resolvedCircle(&c, &r, &start, &end))
+    {
+        if (r <= 0) return QRect();
+        int ext = r + strokeRadius();
+        return QRect(QPoint(c.x() - ext, c.y() - ext),
+                     QPoint(c.x() + ext, c.y() + ext));
+    }
+
+    const QPointF mc = matrix.map(QPointF(center));
+    const double hx = radius * std::hypot(matrix.m11(), matrix.m21());
+    const double hy = radius * std::hypot(matrix.m12(), matrix.m22());
+    const int sr = strokeRadius();
+    return QRect(QPoint(int(std::floor(mc.x() - hx)) - sr, int(std::floor(mc.y() - hy)) - sr),
+                 QPoint(int(std::ceil(mc.x() + hx)) + sr, int(std::ceil(mc.y() + hy)) + sr));
+}
+
+// 圆（椭圆）的重心就是映射后的圆心
+QPointF ArcShape::centroid() const
+{
+    return matrix.map(QPointF(center));
+}
+
+// 只累积矩阵，源圆弧不变；绘制时再解析为圆弧或椭圆弧
+void ArcShape::transform(const QTransform& m)
+{
+    matrix *= m;
+    invalidate();
+}
@@ -4,6 +4,7 @@
 #include "shape.h"
 #include <QPoint>
 #include <QColor>
+#include <vector>
 
 /**
  * @brief 圆弧图元类（基于中点圆弧算法）
@@ -11,6 +12,9 @@
  * 使用整数运算的中点圆弧算法绘制圆弧像素点，可控制起止角度
  * 与中点画圆算法原理相同
  * 在每个八分圆对称区中仅绘制处于角度范围内的像素
+ *
+ * center / radius / startAngle / endAngle 是源圆弧，变换只累积到 matrix：
+ * matrix 为相似变换时解析为另一段圆弧，否则（非等比缩放、错切）按椭圆弧精确绘制，不会退化为近似圆
  */
 class ArcShape : public Shape
 {
@@ -24,18 +28,40 @@ public:
     void draw(DrawEngine* engine) override;
 
     /**
-     * @brief 判断某点是否在图形中（本实验未使用）
+     * @brief 点选：到（映射后的）圆弧的距离不超过 HIT_TOLERANCE 加半线宽
      */
-    bool contains(const QPoint& pt) const override { return false; }
+    bool contains(const QPoint& pt) const override;
 
 
     QPointF centroid() const override;
 
+    QRect boundingRect() const override;
+
+    // 圆弧扫过的角度（°，0 表示不绘制，360 表示整圆）
+    double sweepAngle() const { return sweepOf(startAngle, endAngle); }
+    static double sweepOf(double startDeg, double endDeg);
+
+    // 源圆弧经 matrix 映射后的圆心、半径与起止角；matrix 不是相似变换（结果为椭圆弧）时返回 false
+    bool resolvedCircle(QPoint* c, int* r, double* startDeg, double* endDeg) const;
+
+    // 累积到 matrix，源圆弧不变
+    void transform(const QTransform& m) override;
+    int controlPointCount() const override { return 1; }
+    QPointF controlPoint(int) const override { return centroid(); }
+
     QPoint center;                                              // 圆心坐标
     int radius;                                                 // 半径
     double startAngle;                                          // 起始角度（单位：°， 0°在右侧，顺时针方向增加）
     double endAngle;                                            // 终止角度（单位：°）
-    QColor color;                                               // 绘制颜色
+
+protected:
+    std::shared_ptr<Shape> cloneShape() const override { return std::make_shared<ArcShape>(*this); }
+
+private:
+    void strokePath(DrawEngine* engine, std::vector<QPointF>& path, bool closed) const;
+    void drawEllipticArc(DrawEngine* engine) const;
+    // 源圆弧折线化后整体经 matrix 映射（弦高误差按映射后最大半径计算，不超过 1/4 像素）
+    std::vector<QPointF> mappedPolyline(double sweep) const;
 };
 
 #endif // ARCSHAPE_H
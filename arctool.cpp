@@ -39,6 +39,7 @@ void ArcTool::onMousePress(QMouseEvent* e, DrawEngine* engine)
     currentArc->penWidth = engine->getPenWidth();
     currentArc->lineStyle = engine->getLineStyle();
     currentArc->lineCap = engine->getLineCap();
+    currentArc->lineJoin = engine->getLineJoin();
 
     engine->addShape(currentArc);                                           // 将图元加入引擎，使其参与后续的重绘
 }
@@ -93,6 +94,8 @@ void ArcTool::onMouseRelease(QMouseEvent* e, DrawEngine* engine)
         return;
 
     isDrawing = false;                                                      // 结束绘制
+    if (engine && currentArc)
+        engine->getHistory().push(std::make_unique<AddShapeCommand>(currentArc));
     currentArc.reset();                                                     // 释放指针（DrawEngine 仍保留拷贝）
 }
 
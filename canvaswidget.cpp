@@ -56,19 +56,14 @@ void CanvasWidget::setTool(BaseTool* tool)
  * - 窗口被遮挡/最小化后重新显示
  *
  * 逻辑：
- * 让 DrawEngine 清空画布
- * 让每个 Shape 自行在画布上绘制像素
+ * 让 DrawEngine 只重绘脏区域（无修改时不做任何光栅化）
  * 使用 QPainter 将内存画布（QImage）绘制到屏幕
  */
 void CanvasWidget::paintEvent(QPaintEvent*)
 {
     if (!drawEngine) return;
 
-    drawEngine->clear();                                                // 每次先清空画布（重置为背景色）
-
-    // 让所有图形重新绘制自己
-    for (auto& s : drawEngine->getShapes())
-        s->draw(drawEngine);
+    drawEngine->renderDamage();                                         // 清空并重绘与脏区域相交的图形
 
     // 将 QImage 绘制到窗口中，使用 rect() 确保图像会按窗口大小自动缩放
     QPainter painter(this);
@@ -107,6 +102,7 @@ void CanvasWidget::mousePressEvent(QMouseEvent* e)
 {
     if (currentTool)
         currentTool->onMousePress(e, drawEngine);
+    update();                                                           // 工具 overlay 可能变化
 }
 
 /**
@@ -119,6 +115,7 @@ void CanvasWidget::mouseMoveEvent(QMouseEvent* e)
 {
     if (currentTool)
         currentTool->onMouseMove(e, drawEngine);
+    update();                                                           // 工具 overlay 可能变化
 }
 
 /**
@@ -131,19 +128,20 @@ void CanvasWidget::mouseReleaseEvent(QMouseEvent* e)
 {
     if (currentTool)
         currentTool->onMouseRelease(e, drawEngine);
+    update();                                                           // 工具 overlay 可能变化
 }
 
 /**
  * @brief 每帧刷新逻辑（由 QTimer 调用）
  *
  * 该函数每 16ms 被调用一次
- * 用于更新动画逻辑或重绘画布
- * 当前版本仅调用 update()，让 Qt 触发 paintEvent()
+ * 只有 DrawEngine 存在脏区域时才调用 update()，空闲画布不会触发重绘
+ * （鼠标事件引起的 overlay 变化由鼠标事件处理函数直接 update()）
  */
 void CanvasWidget::onFrame()
 {
-    // 后面可以在这里更新动画、物体移动等逻辑
-    update();                                                           // 通知 Qt 重新绘制（显示最新的像素缓冲）
+    if (drawEngine && drawEngine->hasDamage())
+        update();                                                       // 通知 Qt 重新绘制（显示最新的像素缓冲）
 }
 
 
@@ -16,7 +16,7 @@ class DrawEngine;
  * 说明：
  * CanvasWidget 是主绘图区的 QWidget，主要负责：
  * 响应鼠标输入事件，并把事件交给当前工具（BaseTool）
- * 定时刷新画面（使用 QTimer 每16ms 调用一次）
+ * 定时检查脏区域（使用 QTimer 每16ms 一次），有修改时才刷新画面
  * 负责把 DrawEngine 生成的 QImage 绘制到屏幕上
  */
 class CanvasWidget : public QWidget
@@ -1,7 +1,6 @@
 #include "cliptool.h"
 #include "drawengine.h"
 #include "polygonshape.h"
-#include "lineshape.h"
 #include "shape.h"
 
 #include <QMouseEvent>
@@ -27,7 +26,7 @@ void ClipTool::onMousePress(QMouseEvent* e, DrawEngine* engine)
     previewRect->lineStyle = LineStyle::Dash;
     previewRect->lineCap = LineCap::Square;
     previewRect->dashOffset = 0;
-    previewRect->vertices = { startPt, startPt, startPt, startPt };
+    previewRect->setVertices({ startPt, startPt, startPt, startPt });
     engine->addShape(previewRect);
     engine->redrawShape(previewRect);
 }
@@ -51,7 +50,7 @@ void ClipTool::onMouseMove(QMouseEvent* e, DrawEngine* engine)
             QPoint(xmax, ymax),
             QPoint(xmin, ymax)
         };
-        previewRect->vertices = verts;
+        previewRect->setVertices(std::move(verts));
         engine->redrawShape(previewRect);
     }
 }
@@ -69,52 +68,53 @@ void ClipTool::onMouseRelease(QMouseEvent* e, DrawEngine* engine)
     int ymin = std::min(startPt.y(), curPt.y());
     int ymax = std::max(startPt.y(), curPt.y());
 
-    auto shapes = engine->getShapes();
+    const QRect window(QPoint(xmin, ymin), QPoint(xmax, ymax));
 
-    for (auto &sptr : shapes)
-    {
-        if (sptr == previewRect) continue;
+    // 每个图元按自己的几何裁剪（直线 Cohen-Sutherland，多边形 Sutherland-Hodgman，其余保持不变），
+    // 完全落在窗口外的图元删除
+    // 整次裁剪在历史中是一步：几何被裁短的图元记录顶点差量，被删除的图元记录删除
+    std::vector<std::shared_ptr<Shape>> removed;
+    History& history = engine->getHistory();
+    history.beginMacro();
 
-        auto line = std::dynamic_pointer_cast<LineShape>(sptr);
-        if (line)
+    auto clipOne = [&](const std::shared_ptr<Shape>& sptr) {
+        GeometryState before = GeometryState::capture(*sptr);
+        if (!sptr->clipToRect(window, *engine))
         {
-            int x0 = line->start.x(), y0 = line->start.y();
-            int x1 = line->end.x(),   y1 = line->end.y();
-
-            if (engine->cohenSutherlandClip(x0, y0, x1, y1, xmin, ymin, xmax, ymax))
-            {
-                line->start = QPoint(x0, y0);
-                line->end   = QPoint(x1, y1);
-            }
-            else
-            {
-                engine->removeShape(line);
-            }
-            continue;
+            removed.push_back(sptr);
+            return;
         }
+        auto cmd = std::make_unique<GeometryCommand>(sptr, before, GeometryState::capture(*sptr));
+        if (!cmd->isEmpty())
+            history.push(std::move(cmd));
+    };
 
-        auto poly = std::dynamic_pointer_cast<PolygonShape>(sptr);
-        if (poly)
-        {
-            std::vector<QPoint> clipped = engine->clipPolygonWithRect(poly->vertices, xmin, ymin, xmax, ymax);
-            if (clipped.size() >= 3)
-            {
-                poly->vertices = clipped;
-            }
-            else
-            {
-                engine->removeShape(poly);
-            }
-            continue;
-        }
+    // 包围盒与窗口不相交的图元：不可能有部分留在窗口内
+    for (auto &sptr : engine->getShapes())
+    {
+        if (sptr == previewRect || sptr->paintedBounds.intersects(window)) continue;
+        clipOne(sptr);
     }
 
+    // 与窗口相交的图元由空间索引给出；包围盒完全在窗口内的不受裁剪影响
+    for (auto &sptr : engine->shapesInRect(window))
+    {
+        if (sptr == previewRect) continue;
+        if (window.contains(sptr->paintedBounds)) continue;
+        clipOne(sptr);
+    }
+
+    for (auto &sptr : removed)
+    {
+        history.push(std::make_unique<RemoveShapeCommand>(sptr));
+        engine->removeShape(sptr);
+    }
+    history.endMacro();
+
     if (previewRect)
     {
         engine->removeShape(previewRect);
         previewRect.reset();
     }
-
-    engine->clear();
 }
 
@@ -0,0 +1,297 @@
+#include "coveragerasterizer.h"
+#include "drawengine.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define COVERAGE_SSE2 1
+#endif
+
+namespace {
+
+// 带符号覆盖率 -> [0, 1]
+inline float foldCoverage(float acc, FillRule rule)
+{
+    float a = std::abs(acc);
+    if (rule == FillRule::EvenOdd)
+    {
+        a -= 2.0f * std::floor(a * 0.5f);
+        return 1.0f - std::abs(1.0f - a);
+    }
+    return std::min(a, 1.0f);
+}
+
+} // namespace
+
+void CoverageRasterizer::addLine(double x0, double y0, double x1, double y1)
+{
+    if (y0 == y1) return;                                               // 水平边不贡献面积，端点也属于相邻的边
+
+    // 像素中心 (x, y) 平移到单元格 [x, x + 1) 的中点
+    x0 += 0.5; y0 += 0.5;
+    x1 += 0.5; y1 += 0.5;
+
+    if (lines.empty())
+    {
+        minX = maxX = x0;
+        minY = maxY = y0;
+    }
+    minX = std::min({minX, x0, x1});
+    maxX = std::max({maxX, x0, x1});
+    minY = std::min({minY, y0, y1});
+    maxY = std::max({maxY, y0, y1});
+    lines.push_back({x0, y0, x1, y1});
+}
+
+void CoverageRasterizer::clear()
+{
+    lines.clear();
+    minX = minY = maxX = maxY = 0;
+}
+
+/**
+ * @brief 累加一段边（0 <= y0, y1 <= 行数，0 <= x0, x1 <= width）
+ * 逐行求出这段边在本行内的 x 范围 [xa, xb]：
+ *  - 落在同一格内时，本格得到 d·(1 - 平均 x 的小数部分)，右侧一格得到剩余部分；
+ *  - 跨多格时，按梯形面积把 d 分摊到 xa 所在格、中间各格与 xb 所在格，
+ * 每行各格之和恰为 d（本行内的竖直跨度乘方向），前缀和后 xb 右侧的像素覆盖率为 d
+ */
+void CoverageRasterizer::accumulate(double x0, double y0, double x1, double y1,
+                                    float* cells, int stride) const
+{
+    if (y0 == y1) return;
+
+    double dir = 1.0;
+    if (y0 > y1)
+    {
+        std::swap(x0, x1);
+        std::swap(y0, y1);
+        dir = -1.0;
+    }
+
+    const double dxdy = (x1 - x0) / (y1 - y0);
+    double x = x0;
+    const int yEnd = int(std::ceil(y1));
+    for (int y = int(y0); y < yEnd; ++y)
+    {
+        float* row = cells + std::size_t(y) * stride;
+        const double dy = std::min(double(y + 1), y1) - std::max(double(y), y0);
+        const double xNext = x + dxdy * dy;
+        const double d = dy * dir;
+
+        const double xa = std::min(x, xNext), xb = std::max(x, xNext);
+        const double fa = std::floor(xa);
+        const int ia = int(fa);
+        const double cb = std::ceil(xb);
+        const int ib = int(cb);
+
+        if (ib <= ia + 1)
+        {
+            const double xm = 0.5 * (x + xNext) - fa;
+            row[ia] += float(d - d * xm);
+            row[ia + 1] += float(d * xm);
+        }
+        else
+        {
+            const double s = 1.0 / (xb - xa);
+            const double fxa = xa - fa;
+            const double a0 = 0.5 * s * (1.0 - fxa) * (1.0 - fxa);
+            const double fxb = xb - cb + 1.0;
+            const double am = 0.5 * s * fxb * fxb;
+            row[ia] += float(d * a0);
+            if (ib == ia + 2)
+                row[ia + 1] += float(d * (1.0 - a0 - am));
+            else
+            {
+                const double a1 = s * (1.5 - fxa);
+                row[ia + 1] += float(d * (a1 - a0));
+                const float ds = float(d * s);
+                for (int xi = ia + 2; xi < ib - 1; ++xi)
+                    row[xi] += ds;
+                const double a2 = a1 + (ib - ia - 3) * s;
+                row[ib - 1] += float(d * (1.0 - a2 - am));
+            }
+            row[ib] += float(d * am);
+        }
+        x = xNext;
+    }
+}
+
+void CoverageRasterizer::addToBand(const Line& l, int left, int width, int bandTop, int rows,
+                                   float* cells, int stride) const
+{
+    double x0 = l.x0 - left, y0 = l.y0 - bandTop;
+    double x1 = l.x1 - left, y1 = l.y1 - bandTop;
+    if ((y0 <= 0 && y1 <= 0) || (y0 >= rows && y1 >= rows)) return;
+
+    // 竖直方向裁剪到本带
+    const double dxdy = (x1 - x0) / (y1 - y0);
+    auto clipY = [&](double& x, double& y) {
+        if (y < 0)         { x -= y * dxdy; y = 0; }
+        else if (y > rows) { x += (rows - y) * dxdy; y = rows; }
+    };
+    clipY(x0, y0);
+    clipY(x1, y1);
+    if (y0 == y1) return;
+
+    // 水平方向在 x = 0 与 x = width 处切开：
+    // 左侧部分折算为 x = 0 上的竖直边，右侧部分不影响 [0, width) 内的像素，直接丢弃
+    double ts[4] = {0.0, 0.0, 0.0, 1.0};
+    int nt = 1;
+    if (x0 != x1)
+    {
+        for (double bound : {0.0, double(width)})
+        {
+            const double t = (bound - x0) / (x1 - x0);
+            if (t > 0.0 && t < 1.0) ts[nt++] = t;
+        }
+    }
+    ts[nt] = 1.0;
+    std::sort(ts + 1, ts + nt);
+
+    for (int i = 0; i < nt; ++i)
+    {
+        const double ta = ts[i], tb = ts[i + 1];
+        const double ya = y0 + (y1 - y0) * ta, yb = y0 + (y1 - y0) * tb;
+        const double xa = x0 + (x1 - x0) * ta, xb = x0 + (x1 - x0) * tb;
+        const double xm = 0.5 * (xa + xb);
+        if (xm >= width) continue;
+        if (xm <= 0)
+            accumulate(0.0, ya, 0.0, yb, cells, stride);
+        else
+            accumulate(std::clamp(xa, 0.0, double(width)), ya,
+                       std::clamp(xb, 0.0, double(width)), yb, cells, stride);
+    }
+}
+
+/**
+ * @brief 前缀和求覆盖率，并把本行单元格清零
+ * SSE2：4 格一组，组内用两次移位相加得到前缀和，再加上前一组末尾的累计值
+ */
+void CoverageRasterizer::resolveRow(float* cells, quint8* coverage, int width, FillRule rule)
+{
+    int i = 0;
+    float acc = 0.0f;
+
+#ifdef COVERAGE_SSE2
+    const __m128 zero = _mm_setzero_ps();
+    const __m128 signMask = _mm_set1_ps(-0.0f);
+    const __m128 one = _mm_set1_ps(1.0f);
+    const __m128 half = _mm_set1_ps(0.5f);
+    const __m128 scale = _mm_set1_ps(255.0f);
+    __m128 carry = zero;
+    for (; i + 4 <= width; i += 4)
+    {
+        __m128 v = _mm_loadu_ps(cells + i);
+        v = _mm_add_ps(v, _mm_castsi128_ps(_mm_slli_si128(_mm_castps_si128(v), 4)));
+        v = _mm_add_ps(v, _mm_castsi128_ps(_mm_slli_si128(_mm_castps_si128(v), 8)));
+        v = _mm_add_ps(v, carry);
+        carry = _mm_shuffle_ps(v, v, _MM_SHUFFLE(3, 3, 3, 3));
+        _mm_storeu_ps(cells + i, zero);
+
+        __m128 a = _mm_andnot_ps(signMask, v);
+        if (rule == FillRule::EvenOdd)
+        {
+            // a >= 0，截断即向下取整
+            const __m128 pairs = _mm_cvtepi32_ps(_mm_cvttps_epi32(_mm_mul_ps(a, half)));
+            a = _mm_sub_ps(a, _mm_add_ps(pairs, pairs));
+            a = _mm_sub_ps(one, _mm_andnot_ps(signMask, _mm_sub_ps(one, a)));
+        }
+        else
+            a = _mm_min_ps(a, one);
+
+        __m128i q = _mm_cvttps_epi32(_mm_add_ps(_mm_mul_ps(a, scale), half));
+        q = _mm_packs_epi32(q, q);
+        q = _mm_packus_epi16(q, q);
+        const int packed = _mm_cvtsi128_si32(q);
+        std::memcpy(coverage + i, &packed, 4);
+    }
+    acc = _mm_cvtss_f32(carry);
+#endif
+
+    for (; i < width; ++i)
+    {
+        acc += cells[i];
+        cells[i] = 0.0f;
+        coverage[i] = quint8(int(foldCoverage(acc, rule) * 255.0f + 0.5f));
+    }
+    cells[width] = 0.0f;                                                // 右侧两格只接收被丢弃的累计值
+    cells[width + 1] = 0.0f;
+}
+
+void CoverageRasterizer::emitRow(DrawEngine* engine, int y, int left, const quint8* coverage,
+                                 int width, QRgb rgb)
+{
+    int i = 0;
+    while (i < width)
+    {
+        // 跳过整 8 格都未覆盖的部分（细线描边的包围盒内大多是空白）
+        while (i + 8 <= width)
+        {
+            quint64 word;
+            std::memcpy(&word, coverage + i, 8);
+            if (word != 0) break;
+            i += 8;
+        }
+        if (i >= width) break;
+
+        const quint8 a = coverage[i];
+        int j = i + 1;
+        while (j < width && coverage[j] == a) ++j;
+        if (a == 255)
+            engine->fillSpan(y, left + i, left + j - 1, rgb);
+        else if (a != 0)
+            engine->blendSpan(y, left + i, left + j - 1, rgb, a);
+        i = j;
+    }
+}
+
+/**
+ * @brief 抗锯齿填充
+ * 列范围为包围盒与裁剪矩形的交集，逐带（BAND_ROWS 行）累加全部边、逐行求覆盖率并输出
+ */
+void CoverageRasterizer::fill(DrawEngine* engine, QRgb rgb, FillRule rule)
+{
+    if (!engine || lines.empty())
+    {
+        clear();
+        return;
+    }
+
+    const QRect clip = engine->currentClip();
+    const int left = std::max(int(std::floor(minX)), clip.left());
+    const int right = std::min(int(std::ceil(maxX)), clip.right() + 1);
+    const int top = std::max(int(std::floor(minY)), clip.top());
+    const int bottom = std::min(int(std::ceil(maxY)), clip.bottom() + 1);
+    if (left >= right || top >= bottom)
+    {
+        clear();
+        return;
+    }
+
+    const int width = right - left;
+    const int stride = width + 2;
+    // 单元格在两次使用之间总是全零（resolveRow 负责清零），扩容时新增部分也是零
+    if (cells.size() < std::size_t(stride) * BAND_ROWS)
+        cells.resize(std::size_t(stride) * BAND_ROWS);
+    if (coverage.size() < std::size_t(width))
+        coverage.resize(width);
+
+    for (int bandTop = top; bandTop < bottom; bandTop += BAND_ROWS)
+    {
+        const int rows = std::min(BAND_ROWS, bottom - bandTop);
+        for (const Line& l : lines)
+            addToBand(l, left, width, bandTop, rows, cells.data(), stride);
+
+        for (int r = 0; r < rows; ++r)
+        {
+            resolveRow(cells.data() + std::size_t(r) * stride, coverage.data(), width, rule);
+            emitRow(engine, bandTop + r, left, coverage.data(), width, rgb);
+        }
+    }
+
+    clear();
+}
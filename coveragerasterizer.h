@@ -0,0 +1,63 @@
+#ifndef COVERAGERASTERIZER_H
+#define COVERAGERASTERIZER_H
+
+#include "scanlinefiller.h"
+#include <QRgb>
+#include <vector>
+
+class DrawEngine;
+
+/**
+ * @brief CoverageRasterizer —— 抗锯齿填充（面积覆盖率累加，字体光栅器的做法）
+ *
+ * 与 ScanlineFiller 相同，先累积任意多个闭合轮廓的边，再一次性填充：
+ *  - 像素 (x, y) 是以 (x, y) 为中心的单位方块，与走样路径的“像素中心在多边形内”一致；
+ *  - 每条边把自己在每个像素格内扫过的带符号面积（向下 +，向上 -）累加到单元格，
+ *    并把越过该格之后的整格覆盖累加到右侧一格；
+ *  - 每行从左到右做前缀和即得各像素的带符号覆盖率：非零规则取 min(1, |a|)，
+ *    奇偶规则把 |a| 折回 [0, 1]（对 2 取模后取到 0 / 2 的较近距离）；
+ *  - 前缀和与覆盖率量化用 SSE2（每次 4 格）实现，编译目标不支持时退化为标量循环；
+ *  - 覆盖率 255 的连续像素用 fillSpan 整段写入，其余按覆盖率用 DrawEngine::blendSpan 混合。
+ *
+ * 单元格缓冲区按 BAND_ROWS 行分带复用，宽度为图元包围盒与当前裁剪矩形的交集，
+ * 裁剪矩形左侧的边折算为裁剪边界上的竖直边（只影响其右侧像素的覆盖率），右侧的边直接丢弃
+ *
+ * 说明：非零规则取 min(1, |a|) 是近似并集 —— Stroker 的各部件在外轮廓上重叠时，
+ * 重叠处边缘像素的覆盖率会偏大；曲线描边（Stroker::setCurve）因此生成不自交的整体轮廓
+ */
+class CoverageRasterizer
+{
+public:
+    static constexpr int BAND_ROWS = 64;
+
+    // 添加一条边（坐标与 ScanlineFiller 相同：像素中心为整数坐标）
+    void addLine(double x0, double y0, double x1, double y1);
+
+    void clear();
+    bool isEmpty() const { return lines.empty(); }
+
+    // 按 rule 以覆盖率填充已添加的全部边（受 engine 当前裁剪矩形限制），完成后清空
+    void fill(DrawEngine* engine, QRgb rgb, FillRule rule);
+
+private:
+    struct Line
+    {
+        double x0, y0, x1, y1;                                          // 已平移到像素格坐标（像素 x 覆盖 [x, x + 1)）
+    };
+
+    // 把 [yTop, yBottom) 内的一段边累加到单元格，x 已裁剪到 [0, width]
+    void accumulate(double x0, double y0, double x1, double y1, float* cells, int stride) const;
+    // 把一条边裁剪到当前带（行 [bandTop, bandTop + rows)、列 [left, left + width)）后累加
+    void addToBand(const Line& l, int left, int width, int bandTop, int rows, float* cells, int stride) const;
+    // 一行单元格的前缀和 -> 8 位覆盖率（同时把单元格清零供下一带使用）
+    static void resolveRow(float* cells, quint8* coverage, int width, FillRule rule);
+    // 输出一行覆盖率
+    static void emitRow(DrawEngine* engine, int y, int left, const quint8* coverage, int width, QRgb rgb);
+
+    std::vector<Line> lines;
+    double minX = 0, minY = 0, maxX = 0, maxY = 0;                      // 全部边的包围盒
+    std::vector<float> cells;                                           // BAND_ROWS 行单元格（多次 fill 之间复用）
+    std::vector<quint8> coverage;                                       // 一行覆盖率
+};
+
+#endif // COVERAGERASTERIZER_H
@@ -1,8 +1,10 @@
 #include "drawengine.h"
 #include "shape.h"
+#include "tilerenderer.h"
 
-#include <stack>
 #include <vector>
+#include <cmath>
+#include <limits>
 
 
 /**
@@ -20,9 +22,93 @@ DrawEngine::DrawEngine(int width, int height, const QColor& bgColor)
     : penWidth(1),
     lineStyle(LineStyle::Solid),
     lineCap(LineCap::Round),
-    canvas(width, height, QImage::Format_RGB32)
+    lineJoin(LineJoin::Round),
+    lineAntialiased(false),
+    canvas(width, height, QImage::Format_RGB32),
+    background(bgColor.rgb())
 {
     canvas.fill(bgColor);                                                       // 初始化背景色
+    bindCanvas();
+}
+
+DrawEngine::~DrawEngine() = default;
+
+/**
+ * @brief 缓存画布的像素指针与行跨度
+ * QImage 是隐式共享的，fill()/重新分配后底层内存可能变化，
+ * 因此在这些操作之后重新获取 bits()，保证 fillSpan 写到当前画布上
+ */
+void DrawEngine::bindCanvas()
+{
+    bits = reinterpret_cast<quint32*>(canvas.bits());
+    stride = canvas.bytesPerLine() / 4;
+    canvasW = canvas.width();
+    canvasH = canvas.height();
+    setClipRect(canvas.rect());
+}
+
+/**
+ * @brief 设置裁剪矩形，fillSpan / setPixelRgb 只写入该矩形内的像素
+ * @param r 裁剪矩形（会与画布范围求交）
+ */
+void DrawEngine::setClipRect(const QRect& r)
+{
+    QRect c = r.intersected(QRect(0, 0, canvasW, canvasH));
+    clipX0 = c.left();
+    clipY0 = c.top();
+    clipX1 = c.right();
+    clipY1 = c.bottom();
+}
+
+/**
+ * @brief 附着到 target 的画布内存上（不复制像素，也不持有图元）
+ * @param target
+ */
+void DrawEngine::attachView(const DrawEngine& target)
+{
+    bits = target.bits;
+    stride = target.stride;
+    canvasW = target.canvasW;
+    canvasH = target.canvasH;
+    background = target.background;
+    if (antialiasing != target.antialiasing)
+    {
+        antialiasing = target.antialiasing;
+        filler.setAntialiased(antialiasing);
+    }
+    setClipRect(QRect(0, 0, canvasW, canvasH));
+}
+
+/**
+ * @brief 开启/关闭分块多线程重绘
+ * @param enabled
+ */
+void DrawEngine::setTiledRendering(bool enabled)
+{
+    tiledRendering = enabled;
+    if (enabled && !tileRenderer)
+        tileRenderer = std::make_unique<TileRenderer>();
+}
+
+/**
+ * @brief 开启/关闭抗锯齿
+ * 缓存的 span 是按旧模式光栅化的，全部丢弃后整幅重绘
+ * @param enabled
+ */
+void DrawEngine::setAntialiasing(bool enabled)
+{
+    if (antialiasing == enabled) return;
+    antialiasing = enabled;
+    filler.setAntialiased(enabled);
+    rasterCache.clear();
+    invalidateAll();
+}
+
+void DrawEngine::setRenderThreadCount(int n)
+{
+    if (!tileRenderer)
+        tileRenderer = std::make_unique<TileRenderer>();
+    tileRenderer->setThreadCount(n);
 }
 
 /**
@@ -32,15 +118,22 @@ DrawEngine::DrawEngine(int width, int height, const QColor& bgColor)
 void DrawEngine::clear(const QColor& color)
 {
     canvas.fill(color);
+    bindCanvas();
 }
 
 void DrawEngine::clearAllShapes()
 {
     // 释放所有 shared_ptr 管理的图元对象（vector::clear 会释放）
-    shapes.clear();
+    registry.forEach([](Shape* s) { s->owner = nullptr; });
+    registry.clear();
+    history.clear();                                                            // 历史中的命令引用的图元已不在场景中
+    snapshotRebuild = true;
+    spatialIndex.clear();
+    rasterCache.clear();
 
     // 清空像素画布（恢复背景色）
     clear();
+    invalidateAll();
 }
 
 /**
@@ -51,23 +144,181 @@ void DrawEngine::clearAllShapes()
  */
 void DrawEngine::setPixel(int x, int y, const QColor& color)
 {
-    // 边界检查：防止访问越界
-    if (x < 0 || y < 0 || x >= canvas.width() || y >= canvas.height())
-        return;
-
-    canvas.setPixelColor(x, y, color);                                          // 直接设置像素颜色（Qt 提供的低级接口）
+    setPixelRgb(x, y, color.rgb());                                             // 边界检查在 setPixelRgb 中完成
 }
 
 /**
- * @brief 重绘指定图元（Shape）
- * - 调用图元的 draw() 函数
+ * @brief 标记指定图元（Shape）需要重绘
+ * - 工具修改图元后调用，真正的光栅化推迟到 renderDamage()
  * @param s
  */
 void DrawEngine::redrawShape(std::shared_ptr<Shape> s)
 {
     if (!s) return;
     //dashCounter = 0;
+    if (s->owner == this)
+        shapeChanged(s.get());
+}
+
+/**
+ * @brief 图元几何/样式变化：旧位置需要擦除，新位置需要绘制
+ * @param s
+ */
+void DrawEngine::shapeChanged(Shape* s)
+{
+    if (!s) return;
+    addDamage(s->paintedBounds);
+    s->paintedBounds = s->boundingRect();
+    addDamage(s->paintedBounds);
+
+    // 在索引中移动到新包围盒（同一节点内只更新矩形）
+    spatialIndex.update(s, s->paintedBounds);
+
+    // 缓存的 span 已过期；正在编辑的图元先直接绘制，稳定后再重新缓存
+    rasterCache.remove(s);
+    s->recentlyChanged = true;
+
+    // 已发布的快照持有其旧状态的副本，下次发布时重新克隆
+    if (!s->snapshotStale)
+    {
+        s->snapshotStale = true;
+        if (!snapshotRebuild)
+            snapshotChanged.push_back(s);
+    }
+}
+
+/**
+ * @brief 整个画布标记为脏
+ */
+void DrawEngine::invalidateAll()
+{
+    damage = QRegion(canvas.rect());
+    damageAll = !damage.isEmpty();
+}
+
+/**
+ * @brief 重绘脏区域
+ *
+ * 对脏区域中的每个矩形：
+ * 1. 把写入裁剪到该矩形，并用背景色清空
+ * 2. 按绘制顺序（画家算法）重绘包围盒与之相交的图元
+ * 裁剪保证只部分相交的图元不会覆盖脏区域外、位于其上层的图元
+ */
+void DrawEngine::renderDamage()
+{
+    if (damage.isEmpty()) return;
+
+    QRegion region = damage.intersected(canvas.rect());
+    damage = QRegion();
+    damageAll = false;
+    if (region.isEmpty()) return;
+
+    // 脏矩形过多时合并为一个包围矩形，避免对每个小矩形都遍历全部图元
+    const int MAX_DAMAGE_RECTS = 16;
+    std::vector<QRect> rects;
+    if (region.rectCount() > MAX_DAMAGE_RECTS)
+        rects.push_back(region.boundingRect());
+    else
+        rects.assign(region.begin(), region.end());
+
+    if (tiledRendering && tileRenderer)
+    {
+        tileRenderer->render(*this, rects);
+        return;
+    }
+
+    std::vector<Shape*> visible;
+    for (const QRect& r : rects)
+    {
+        setClipRect(r);
+        for (int y = clipY0; y <= clipY1; ++y)
+            fillSpan(y, clipX0, clipX1, background);
+
+        visible.clear();
+        collectShapes({r}, visible);
+        for (Shape* s : visible)
+            drawShape(s);
+    }
+
+    setClipRect(canvas.rect());
+}
+
+/**
+ * @brief 绘制单个图元
+ *
+ * - 刚被修改的图元（拖拽、编辑中）通常下一帧还会变化，直接光栅化，不写缓存
+ * - 本身已是 span 形式的图元（cacheRaster() 为 false）直接绘制
+ * - 其余图元优先回放缓存；未命中时录制一次并写入缓存
+ * @param s
+ */
+void DrawEngine::drawShape(Shape* s)
+{
+    if (!s) return;
+
+    if (rasterCache.budget() == 0 || s->recentlyChanged || !s->cacheRaster())
+    {
+        s->recentlyChanged = false;
+        s->draw(this);
+        return;
+    }
+
+    std::shared_ptr<const SpanList> spans = rasterCache.find(s);
+    if (!spans)
+    {
+        spans = recordShape(s);
+        rasterCache.insert(s, spans);
+    }
+    blitSpans(*spans);
+}
+
+/**
+ * @brief 录制图元的光栅化结果
+ * 录制时裁剪矩形临时放宽到整个画布，使缓存与本次重绘的脏矩形无关
+ * @param s
+ * @return 整理后的 span 列表
+ */
+std::shared_ptr<const SpanList> DrawEngine::recordShape(Shape* s)
+{
+    auto spans = std::make_shared<SpanList>();
+    if (!s) return spans;
+
+    const int sx0 = clipX0, sy0 = clipY0, sx1 = clipX1, sy1 = clipY1;
+    setClipRect(QRect(0, 0, canvasW, canvasH));                                 // 视图引擎没有自己的 canvas，按附着的画布尺寸
+
+    recordTarget = spans.get();
     s->draw(this);
+    recordTarget = nullptr;
+
+    clipX0 = sx0; clipY0 = sy0; clipX1 = sx1; clipY1 = sy1;
+
+    RasterCache::compact(*spans);
+    return spans;
+}
+
+/**
+ * @brief 回放 span 列表
+ * @param spans
+ */
+void DrawEngine::blitSpans(const SpanList& spans)
+{
+    for (const RasterSpan& sp : spans)
+    {
+        if (qAlpha(sp.rgb) == 255)
+            fillSpan(sp.y, sp.x0, sp.x1, sp.rgb);
+        else
+            blendSpan(sp.y, sp.x0, sp.x1, sp.rgb, qAlpha(sp.rgb));
+    }
+}
+
+/**
+ * @brief 设置光栅缓存预算，超出部分立即按 LRU 淘汰
+ * @param bytes 0 表示关闭缓存
+ */
+void DrawEngine::setRasterCacheBudget(std::size_t bytes)
+{
+    rasterCache.setBudget(bytes);
+    if (bytes == 0)
+        rasterCache.clear();
 }
 
 /**
@@ -82,6 +333,10 @@ void DrawEngine::resizeCanvas(int w, int h, const QColor& bg)
     QImage newCanvas(w, h, QImage::Format_RGB32);
     newCanvas.fill(bg);
     canvas = newCanvas;
+    background = bg.rgb();
+    bindCanvas();
+    rasterCache.clear();                                                        // 缓存的 span 按旧画布范围裁剪过
+    invalidateAll();
 }
 
 /**
@@ -153,6 +408,47 @@ LineCap DrawEngine::getLineCap() const
     return lineCap;
 }
 
+/**
+ * @brief 设置折线连接样式
+ * - “Miter” 斜接（尖角，过尖时退化为斜切）
+ * - “Bevel” 斜切
+ * - “Round” 圆角
+ * @param text 对应 UI 下拉框文本
+ */
+void DrawEngine::setLineJoin(const QString &text)
+{
+    if (text == "Miter")
+        lineJoin = LineJoin::Miter;
+    else if (text == "Bevel")
+        lineJoin = LineJoin::Bevel;
+    else if (text == "Round")
+        lineJoin = LineJoin::Round;
+}
+
+/**
+ * @brief 获取折线连接样式
+ * @return
+ */
+LineJoin DrawEngine::getLineJoin() const
+{
+    return lineJoin;
+}
+
+/**
+ * @brief 设置新建直线是否使用 Wu 抗锯齿细线
+ * 只影响之后由 LineTool 创建的直线，已有图元保持各自的设置
+ * @param enabled
+ */
+void DrawEngine::setLineAntialiased(bool enabled)
+{
+    lineAntialiased = enabled;
+}
+
+bool DrawEngine::getLineAntialiased() const
+{
+    return lineAntialiased;
+}
+
 /**
  * @brief 返回当前画布 QImage，用于在 CanvasWidget 中显示
  * @return
@@ -163,35 +459,129 @@ const QImage& DrawEngine::getCanvas() const
 }
 
 /**
- * @brief 添加图元对象到 DrawEngine 的列表
+ * @brief 添加图元对象到 DrawEngine 的图元表
  * - 统一管理所有 Shape 的绘制
+ * - 新图元放在最上层；已在本引擎中的图元直接返回原句柄
  * @param s
+ * @return 图元句柄
  */
-void DrawEngine::addShape(std::shared_ptr<Shape> s)
+ShapeId DrawEngine::addShape(std::shared_ptr<Shape> s)
 {
-    if (s)
+    if (!s) return 0;
+    //dashCounter = 0;
+    if (s->owner == this)                                                       // 已在本引擎中
+        return s->id;
+
+    registry.add(s);
+    attachShape(s);
+    return s->id;
+}
+
+ShapeId DrawEngine::addShapeAt(std::shared_ptr<Shape> s, qint64 z)
+{
+    if (!s) return 0;
+    if (s->owner == this)
+        return s->id;
+
+    if (!registry.addAt(s, z))
+        registry.add(s);
+    attachShape(s);
+    return s->id;
+}
+
+// 已登记到图元表的图元：设置归属，登记包围盒并加入脏区域
+void DrawEngine::attachShape(const std::shared_ptr<Shape>& s)
+{
+    s->owner = this;
+    s->paintedBounds = s->boundingRect();
+    addDamage(s->paintedBounds);
+    spatialIndex.insert(s, s->paintedBounds);
+
+    s->snapshotStale = true;
+    if (!snapshotRebuild && s->zOrder > snapshotTopZ)
+    {
+        snapshotAppended.push_back(s.get());
+        snapshotTopZ = s->zOrder;
+    }
+    else
     {
-        //dashCounter = 0;
-        shapes.push_back(s);
+        snapshotRebuild = true;
     }
 }
 
-// 从 shapes 向量中移除第一个与 s 相等的 shared_ptr。
+// 按图元记录的句柄从图元表中移除（O(1) 查找，绘制顺序表 O(log n) 删除）
 // 返回 true 表示成功移除；false 表示未找到。
 bool DrawEngine::removeShape(const std::shared_ptr<Shape>& s)
 {
+    if (!s || s->owner != this) return false;
+    return removeShape(s->id);
+}
+
+bool DrawEngine::removeShape(ShapeId id)
+{
+    std::shared_ptr<Shape> s = registry.remove(id);
     if (!s) return false;
 
-    auto it = std::find_if(shapes.begin(), shapes.end(),
-                           [&s](const std::shared_ptr<Shape>& elem) {
-                               return elem == s; // 比较 shared_ptr 管理的相同对象
-                           });
-    if (it != shapes.end())
-    {
-        shapes.erase(it);
-        return true;
-    }
-    return false;
+    addDamage(s->paintedBounds);                                                // 擦除其原先占据的区域
+    rasterCache.remove(s.get());
+    spatialIndex.remove(s.get());
+    s->owner = nullptr;
+    snapshotRebuild = true;
+    return true;
+}
+
+std::shared_ptr<Shape> DrawEngine::findShape(ShapeId id) const
+{
+    return registry.find(id);
+}
+
+/**
+ * @brief 置顶 / 置底：只改变该图元的绘制序号，其覆盖区域需要按新顺序重绘
+ * @param s
+ */
+void DrawEngine::bringToFront(const std::shared_ptr<Shape>& s)
+{
+    if (!s || s->owner != this) return;
+    registry.bringToFront(s->id);
+    addDamage(s->paintedBounds);
+    s->snapshotStale = true;
+    snapshotRebuild = true;
+}
+
+void DrawEngine::sendToBack(const std::shared_ptr<Shape>& s)
+{
+    if (!s || s->owner != this) return;
+    registry.sendToBack(s->id);
+    addDamage(s->paintedBounds);
+    s->snapshotStale = true;
+    snapshotRebuild = true;
+}
+
+/**
+ * @brief 发布场景快照
+ * 快照中的图元是冻结的副本，界面线程之后的编辑只作用于原图元：
+ * 编辑时 shapeChanged() 给图元打上过期标记，下一次发布只克隆这些图元
+ * @return
+ */
+SceneSnapshot DrawEngine::snapshot()
+{
+    const QSize size = canvas.size();
+    if (!snapshotRebuild && snapshotChanged.empty() && snapshotAppended.empty()
+        && published.canvasSize() == size && published.background() == background)
+        return published;
+
+    SceneSnapshot next;
+    if (snapshotRebuild
+        || !SceneSnapshot::patch(published, snapshotChanged, snapshotAppended, size, background, next))
+        next = SceneSnapshot::rebuild(published, registry.ordered(), size, background);
+
+    published = next;
+    snapshotChanged.clear();
+    snapshotAppended.clear();
+    snapshotTopZ = published.isEmpty() ? std::numeric_limits<qint64>::min()
+                                       : published.at(published.size() - 1).zOrder;
+    snapshotRebuild = false;
+    return published;
 }
 
 /**
@@ -200,7 +590,52 @@ bool DrawEngine::removeShape(const std::shared_ptr<Shape>& s)
  */
 const std::vector<std::shared_ptr<Shape>>& DrawEngine::getShapes() const
 {
-    return shapes;
+    return registry.ordered();
+}
+
+namespace {
+
+bool zOrderLess(const Shape* a, const Shape* b) { return a->zOrder < b->zOrder; }
+
+} // namespace
+
+void DrawEngine::collectShapes(const std::vector<QRect>& rects, std::vector<Shape*>& out) const
+{
+    const std::size_t first = out.size();
+    for (const QRect& r : rects)
+        spatialIndex.query(r, out);
+    std::sort(out.begin() + first, out.end(), zOrderLess);
+    if (rects.size() > 1)                                                       // 同一图元可能与多个矩形相交
+        out.erase(std::unique(out.begin() + first, out.end()), out.end());
+}
+
+std::vector<std::shared_ptr<Shape>> DrawEngine::shapesInRect(const QRect& r) const
+{
+    std::vector<std::shared_ptr<Shape>> result;
+    spatialIndex.query(r, result);
+    std::sort(result.begin(), result.end(),
+              [](const std::shared_ptr<Shape>& a, const std::shared_ptr<Shape>& b) {
+                  return a->zOrder < b->zOrder;
+              });
+    return result;
+}
+
+/**
+ * @brief 点选：只对包围盒（扩展 HIT_TOLERANCE）覆盖该点的图元做精确的 contains() 测试
+ * @param p
+ * @return 最上层命中的图元
+ */
+std::shared_ptr<Shape> DrawEngine::shapeAt(const QPoint& p) const
+{
+    const QRect probe(p.x() - HIT_TOLERANCE, p.y() - HIT_TOLERANCE,
+                      2 * HIT_TOLERANCE + 1, 2 * HIT_TOLERANCE + 1);
+    std::vector<std::shared_ptr<Shape>> candidates = shapesInRect(probe);
+    for (auto it = candidates.rbegin(); it != candidates.rend(); ++it)
+    {
+        if ((*it)->contains(p))
+            return *it;
+    }
+    return nullptr;
 }
 
 /**
@@ -213,20 +648,41 @@ const std::vector<std::shared_ptr<Shape>>& DrawEngine::getShapes() const
  */
 void DrawEngine::drawThickPixel(int x, int y, const QColor &color, int width)
 {
+    // 圆盘按行拆成水平 span：第 dy 行覆盖 dx*dx + dy*dy <= r*r 的所有 dx，即 [-h, h]
+    // 图元的加粗描边由 Stroker 生成轮廓后扫描线填充，不经过这里
+    const QRgb rgb = color.rgb();
     int r = std::max(1, width / 2);                                             // 半径 = 线宽的一半
+    int r2 = r * r;
     for (int dy = -r; dy <= r; ++dy)
     {
-        for (int dx = -r; dx <= r; ++dx)
-        {
-            // 若在圆内（使用 r^2 检测）
-            if (dx * dx + dy * dy <= r * r)
-            {
-                setPixel(x + dx, y + dy, color);
-            }
-        }
+        int rem = r2 - dy * dy;
+        int h = int(std::sqrt(double(rem)));
+        // 修正浮点开方的舍入误差，保证与 r^2 检测得到的像素集合完全一致
+        while ((h + 1) * (h + 1) <= rem) ++h;
+        while (h * h > rem) --h;
+        fillSpan(y + dy, x - h, x + h, rgb);
     }
 }
 
+/**
+ * @brief 线型对应的节奏表
+ * @param style 线型
+ * @param length 返回节奏表长度
+ */
+const int* DrawEngine::linePattern(LineStyle style, int& length)
+{
+    // 根据 lineStyle 选择对应 pattern 数组
+    switch(style)
+    {
+        case LineStyle::Solid:   length = SOLID_LEN; return SOLID_PATTERN;
+        case LineStyle::Dash:    length = 10;        return DASH_PATTERN;
+        case LineStyle::Dot:     length = 3;         return DOT_PATTERN;
+        case LineStyle::DashDot: length = 11;        return DASHDOT_PATTERN;
+    }
+    length = SOLID_LEN;
+    return SOLID_PATTERN;
+}
+
 /**
  * @brief 判断第 step 步是否应该绘制（虚线节奏控制）
  * @param step 当前步数
@@ -237,17 +693,8 @@ void DrawEngine::drawThickPixel(int x, int y, const QColor &color, int width)
  */
 bool DrawEngine::shouldDrawAtStep(int step, LineStyle style, int width, int offset) const
 {
-    const int* pat = SOLID_PATTERN;
     int plen = SOLID_LEN;
-
-    // 根据 lineStyle 选择对应 pattern 数组
-    switch(style)
-    {
-        case LineStyle::Solid:   pat = SOLID_PATTERN;   plen = SOLID_LEN; break;
-        case LineStyle::Dash:    pat = DASH_PATTERN;    plen = 10;        break;
-        case LineStyle::Dot:     pat = DOT_PATTERN;     plen = 3;         break;
-        case LineStyle::DashDot: pat = DASHDOT_PATTERN; plen = 11;        break;
-    }
+    const int* pat = linePattern(style, plen);
 
     int idx = (step / width + offset) % plen;                                   // 取当前节奏位置
     return (pat[idx] != 0);                                                     // 返回 pattern[index] 是否为 1
@@ -274,92 +721,91 @@ void DrawEngine::drawStyledPixelAtStep(int x, int y, const QColor& color,
 /**
  * @brief DrawEngine::floodFillAddShape
  *
- * 实现要点（扫描线 flood-fill，非递归）：
- * 1. 读取画布上种子点的颜色 targetColor（使用 canvas.pixelColor）
- * 2. 如果 targetColor == fillColor，直接返回 nullptr（不需要填充）
- * 3. 使用 visited 数组记录已处理像素（大小 width*height）
- * 4. 用 stack 保存需要扩展的像素种子（以 x,y 表示）
- * 5. 每次弹出一个种子 (x,y)，往左/右扫描得到 [xl..xr] 区间，标记并把这些像素加入结果像素列表
- * 6. 对区间上下两行，检测未处理且颜色 == targetColor 的子区间，压入 stack 的种子（其起点）
- * 7. 最终把收集到的像素数组放入 RasterFillShape 并返回（调用者会 addShape）
+ * 实现要点（扫描线 flood-fill，非递归，按 span 推进）：
+ * 1. 直接读取画布的 QRgb 行数据，与种子点颜色 target 逐字比较（不构造 QColor）
+ * 2. 如果 target == fillColor，直接返回 nullptr（不需要填充）
+ * 3. visited 为按位存储的位图（w*h/8 字节），整段标记时按 64 位字写入
+ * 4. 栈中保存待扫描的区间 {y, xl, xr}：表示第 y 行的 [xl..xr] 下可能存在未填充的目标色像素
+ * 5. 弹出区间后在该行内找出每一段目标色的连续像素，向左右扩展为最大区间 [a..b]，
+ *    标记并记录该区间，再把 {y-1, a, b}、{y+1, a, b} 压栈
+ *    同一行上连续的目标色像素总是整段一起填充，所以只需检查区间内一个像素的 visited 位
+ * 6. 最终把收集到的区间交给 RasterFillShape 并返回（调用者会 addShape）
  */
 std::shared_ptr<RasterFillShape> DrawEngine::floodFillAddShape(int sx, int sy, const QColor& fillColor)
 {
-    int w = canvas.width();
-    int h = canvas.height();
-    if (sx < 0 || sy < 0 || sx >= w || sy >= h) return nullptr;
+    // 种子填充读取的是画布像素，先把未重绘的脏区域刷新到画布上
+    renderDamage();
 
-    QColor target = canvas.pixelColor(sx, sy);
-    if (target == fillColor) return nullptr; // 无需填充
-
-    std::vector<unsigned char> visited(w * h, 0);
-
-    auto index = [&](int x, int y) { return y * w + x; };
+    const int w = canvas.width();
+    const int h = canvas.height();
+    if (sx < 0 || sy < 0 || sx >= w || sy >= h) return nullptr;
 
-    std::vector<QPoint> filledPixels;
-    filledPixels.reserve(1024); // 预留一点空间，避免频繁 realloc
+    const QRgb target = bits[sy * stride + sx];
+    if (target == fillColor.rgb()) return nullptr; // 无需填充
+
+    std::vector<quint64> visited((size_t(w) * h + 63) / 64, 0);
+    auto isVisited = [&](size_t i) { return (visited[i >> 6] >> (i & 63)) & 1; };
+    // 标记 [i0, i1] 闭区间内的位
+    auto markRange = [&](size_t i0, size_t i1) {
+        size_t w0 = i0 >> 6, w1 = i1 >> 6;
+        quint64 m0 = ~quint64(0) << (i0 & 63);
+        quint64 m1 = ~quint64(0) >> (63 - (i1 & 63));
+        if (w0 == w1)
+        {
+            visited[w0] |= m0 & m1;
+            return;
+        }
+        visited[w0] |= m0;
+        for (size_t k = w0 + 1; k < w1; ++k) visited[k] = ~quint64(0);
+        visited[w1] |= m1;
+    };
 
-    std::stack<std::pair<int,int>> st;
-    st.push({sx, sy});
+    using Span = RasterFillShape::Span;
+    std::vector<Span> spans;        // 填充结果（每行若干区间）
+    std::vector<Span> st;           // 待扫描区间栈
+    st.push_back({sy, sx, sx});
 
     while (!st.empty())
     {
-        auto pr = st.top(); st.pop();
-        int x = pr.first;
-        int y = pr.second;
-
-        // 如果已访问或颜色不同则跳过
-        if (x < 0 || x >= w || y < 0 || y >= h) continue;
-        if (visited[index(x,y)]) continue;
-        if (canvas.pixelColor(x,y) != target) continue;
-
-        // 扩展到当前扫描线的最左和最右
-        int xl = x;
-        while (xl - 1 >= 0 && !visited[index(xl-1,y)] && canvas.pixelColor(xl-1,y) == target) xl--;
-        int xr = x;
-        while (xr + 1 < w && !visited[index(xr+1,y)] && canvas.pixelColor(xr+1,y) == target) xr++;
-
-        // 将 [xl..xr] 标记为已访问并加入结果
-        for (int xi = xl; xi <= xr; ++xi)
-        {
-            visited[index(xi,y)] = 1;
-            filledPixels.emplace_back(xi, y);
-        }
-
-        // 检查上一行（y-1）在 [xl..xr] 的子区间
-        if (y - 1 >= 0)
+        Span sp = st.back();
+        st.pop_back();
+        if (sp.y < 0 || sp.y >= h) continue;
+
+        const quint32* row = bits + sp.y * stride;
+        const size_t rowBase = size_t(sp.y) * w;
+        int x = sp.x0;
+        while (x <= sp.x1)
         {
-            int xi = xl;
-            while (xi <= xr)
+            if (row[x] != target)
             {
-                // 跳过非目标颜色或已访问
-                while (xi <= xr && (visited[index(xi,y-1)] || canvas.pixelColor(xi,y-1) != target)) xi++;
-                if (xi > xr) break;
-                int segStart = xi;
-                while (xi <= xr && !visited[index(xi,y-1)] && canvas.pixelColor(xi,y-1) == target) xi++;
-                st.push({segStart, y-1});
+                ++x;
+                continue;
             }
-        }
-
-        // 检查下一行（y+1）在 [xl..xr] 的子区间
-        if (y + 1 < h)
-        {
-            int xi = xl;
-            while (xi <= xr)
+            if (isVisited(rowBase + x))
             {
-                while (xi <= xr && (visited[index(xi,y+1)] || canvas.pixelColor(xi,y+1) != target)) xi++;
-                if (xi > xr) break;
-                int segStart = xi;
-                while (xi <= xr && !visited[index(xi,y+1)] && canvas.pixelColor(xi,y+1) == target) xi++;
-                st.push({segStart, y+1});
+                // 整段已经填过：跳到该段末尾
+                while (x <= sp.x1 && row[x] == target) ++x;
+                continue;
             }
+
+            // 扩展到当前扫描线的最左和最右
+            int xl = x;
+            while (xl > 0 && row[xl - 1] == target) --xl;
+            int xr = x;
+            while (xr + 1 < w && row[xr + 1] == target) ++xr;
+
+            markRange(rowBase + xl, rowBase + xr);
+            spans.push_back({sp.y, xl, xr});
+            st.push_back({sp.y - 1, xl, xr});
+            st.push_back({sp.y + 1, xl, xr});
+            x = xr + 1;
         }
     }
 
-    if (filledPixels.empty()) return nullptr;
+    if (spans.empty()) return nullptr;
 
-    // 创建 RasterFillShape 并返回（调用者负责 addShape）
-    std::shared_ptr<RasterFillShape> rs = std::make_shared<RasterFillShape>(filledPixels, fillColor);
+    // 创建 RasterFillShape 并返回（调用者负责 addShape），区间直接移交给图元
+    std::shared_ptr<RasterFillShape> rs = std::make_shared<RasterFillShape>(std::move(spans), fillColor);
     // 把 shape 的绘制属性设置合理值（若需要）
     rs->penWidth = 1;
     rs->lineStyle = LineStyle::Solid;
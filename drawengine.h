@@ -3,24 +3,44 @@
 
 #include <QImage>
 #include <QColor>
+#include <QRegion>
 #include <vector>
 #include <memory>
+#include <algorithm>
 #include "shape.h"
 #include "rasterfillshape.h"
+#include "rastercache.h"
+#include "spatialindex.h"
+#include "shaperegistry.h"
+#include "history.h"
+#include "scenesnapshot.h"
+#include "scanlinefiller.h"
 
 class Shape;
+class TileRenderer;
 
 /**
  * @brief DrawEngine —— 绘图引擎核心类
  * 负责所有“像素级”的绘图操作
  * 所有算法（直线、圆、多边形等）都会调用这里的 setPixel 来操作画布
  * 画布本质上是一张 QImage，直接往它写像素
+ *
+ * 重绘采用脏矩形策略：图元增删改时把旧/新包围盒加入脏区域，
+ * renderDamage() 只清空并重绘与脏区域相交的图元，空闲时不做任何光栅化
+ *
+ * 静态图元的光栅化结果（span 列表）保存在 RasterCache 中，重绘时直接回放
+ * 开启分块模式后，脏区域由 TileRenderer 在线程池上并行重绘
+ *
+ * 图元包围盒登记在 SpatialIndex 中，重绘、点选、框选与裁剪都只访问与查询矩形相交的图元
  */
 class DrawEngine
 {
+    friend class TileRenderer;
+
 public:
     // 构造函数：创建一个指定宽高的画布，并填充背景色
     DrawEngine(int width = 800, int height = 600, const QColor& bgColor = Qt::white);
+    ~DrawEngine();
 
     // 清空画布（全部填充为背景色）
     void clear(const QColor& color = Qt::white);
@@ -31,9 +51,60 @@ public:
     // 低级像素绘制函数，仅在有效范围内设置一个像素颜色
     void setPixel(int x, int y, const QColor& color = Qt::black);
 
-    // 重绘指定图元（Shape）
+    // 快速像素写入：颜色为预打包的 QRgb，直接写 scanLine 内存
+    inline void setPixelRgb(int x, int y, QRgb rgb);
+
+    // 行扫描（span）写入：把第 y 行的 [x0, x1] 闭区间填为 rgb
+    // 裁剪只在每个 span 上做一次，内部是一次连续内存写
+    inline void fillSpan(int y, int x0, int x1, QRgb rgb);
+
+    // 按覆盖率 alpha（0..255）把 rgb 混合到第 y 行的 [x0, x1]（抗锯齿边缘像素）
+    // 录制时 alpha 存入 span 颜色的 alpha 通道，回放时 alpha 不为 255 的 span 走混合
+    inline void blendSpan(int y, int x0, int x1, QRgb rgb, int alpha);
+
+    // 当前像素写入的裁剪矩形（分块重绘时为本块范围），图元可据此跳过不可见的部分
+    QRect currentClip() const { return QRect(QPoint(clipX0, clipY0), QPoint(clipX1, clipY1)); }
+
+    // 标记指定图元（Shape）需要重绘（等价于 s->invalidate()）
     void redrawShape(std::shared_ptr<Shape> s);
 
+    // 图元通知引擎其几何/样式已改变：旧包围盒与新包围盒加入脏区域
+    void shapeChanged(Shape* s);
+
+    // 把整个画布标记为脏区域（例如尺寸变化、清空）
+    void invalidateAll();
+
+    // 是否存在待重绘的脏区域
+    bool hasDamage() const { return !damage.isEmpty(); }
+
+    // 只清空并重绘脏区域：与脏矩形相交的图元按 shapes 顺序重绘，写入被裁剪在脏矩形内
+    void renderDamage();
+
+    // 绘制单个图元：命中光栅缓存则回放 span，否则光栅化（并在图元稳定后写入缓存）
+    void drawShape(Shape* s);
+
+    // 把图元光栅化为 span 列表（不写画布），结果已按 RasterCache::compact 整理
+    std::shared_ptr<const SpanList> recordShape(Shape* s);
+
+    // 按顺序回放 span 列表（受当前裁剪矩形限制）
+    void blitSpans(const SpanList& spans);
+
+    // 光栅缓存内存预算（字节），0 表示关闭缓存
+    void setRasterCacheBudget(std::size_t bytes);
+    const RasterCache& getRasterCache() const { return rasterCache; }
+
+    // 分块多线程重绘开关（输出与串行路径逐像素一致）
+    void setTiledRendering(bool enabled);
+    bool isTiledRendering() const { return tiledRendering; }
+
+    // 抗锯齿开关：填充、描边与圆弧改用面积覆盖率光栅化（CoverageRasterizer），
+    // 细线也按 1 像素宽的轮廓描边；切换时清空光栅缓存并重绘整个画布
+    void setAntialiasing(bool enabled);
+    bool isAntialiasing() const { return antialiasing; }
+
+    // 分块重绘使用的工作线程数（默认 QThread::idealThreadCount()）
+    void setRenderThreadCount(int n);
+
     // 调整画布尺寸
     void resizeCanvas(int w, int h, const QColor& bg = Qt::white);
 
@@ -55,25 +126,72 @@ public:
     // 获取线帽样式
     LineCap getLineCap() const;
 
+    // 设置折线连接样式（Miter / Bevel / Round）
+    void setLineJoin(const QString &text);
+
+    // 获取折线连接样式
+    LineJoin getLineJoin() const;
+
+    // 新建直线是否使用 Wu 抗锯齿细线（LineShape::antialiased，只对线宽 1 生效）
+    void setLineAntialiased(bool enabled);
+    bool getLineAntialiased() const;
+
     // 返回当前画布 QImage，用于在 CanvasWidget 中显示
     const QImage& getCanvas() const;
 
-    // 添加图元对象到 DrawEngine 的列表
-    void addShape(std::shared_ptr<Shape> s);
+    // 添加图元对象到 DrawEngine 的图元表（放在最上层），返回其句柄
+    ShapeId addShape(std::shared_ptr<Shape> s);
+    // 按指定绘制序号加入（撤销删除时回到原来的层次），序号已被占用时放在最上层
+    ShapeId addShapeAt(std::shared_ptr<Shape> s, qint64 z);
 
     //
-    // 从 shapes 列表中移除某个图元（按 shared_ptr 匹配）
+    // 从图元表中移除某个图元（按图元记录的句柄查找，O(1)）
     // 如果找到并移除返回 true，否则返回 false
     bool removeShape(const std::shared_ptr<Shape>& s);
+    bool removeShape(ShapeId id);
+
+    // 按句柄查找图元，句柄失效（图元已移除）时返回 nullptr
+    std::shared_ptr<Shape> findShape(ShapeId id) const;
+
+    // 调整绘制顺序：置顶 / 置底
+    void bringToFront(const std::shared_ptr<Shape>& s);
+    void sendToBack(const std::shared_ptr<Shape>& s);
 
-    // 返回所有图元对象（只读）
+    // 返回所有图元对象（只读，按绘制顺序，底层在前）
+    // 结果在下一次增删或调整顺序前保持有效
     const std::vector<std::shared_ptr<Shape>>& getShapes() const;
+    std::size_t shapeCount() const { return registry.size(); }
+
+    // 包围盒与 r 相交的图元，按绘制顺序排列（底层在前）
+    std::vector<std::shared_ptr<Shape>> shapesInRect(const QRect& r) const;
+
+    // 点 p 处最上层的图元（contains(p) 为 true），没有则返回 nullptr
+    std::shared_ptr<Shape> shapeAt(const QPoint& p) const;
+
+    // 点选时查询矩形向外扩展的像素数（LineShape::contains 的容差为 2 像素）
+    static constexpr int HIT_TOLERANCE = 2;
+
+    // 撤销 / 重做历史：工具在完成一次编辑后把对应命令 push 进来
+    History& getHistory() { return history; }
+    bool undo() { return history.undo(*this); }
+    bool redo() { return history.redo(*this); }
+
+    // 当前场景的只读快照（可交给其它线程）：场景没有变化时 O(1) 返回上一次的快照，
+    // 否则只克隆上一次之后改动或新增的图元；删除与调整顺序时按绘制顺序重建块表
+    SceneSnapshot snapshot();
 
     // 模拟笔宽的“加粗像素绘制”
     void drawThickPixel(int x, int y, const QColor &color, int width);
 
     bool shouldDrawAtStep(int step, LineStyle style, int width, int offset) const;
 
+    // 本引擎的扫描线填充器：边表与 AET 的内存在多次绘制之间复用
+    // 图元在 draw() 内取用，用完（fill）即清空；TileRenderer 的工作引擎各有一份，线程间不共享
+    ScanlineFiller& scanlineFiller() { return filler; }
+
+    // 线型节奏表（1 画 / 0 空），length 返回表长；Stroker 按同一节奏切分虚线
+    static const int* linePattern(LineStyle style, int& length);
+
     // 在绘图算法的“第 step 步”调用，根据线型判断是否应画，并按线宽绘制
     void drawStyledPixelAtStep(int x, int y, const QColor& color,
                                int step, LineStyle style, int width, int offset);
@@ -95,13 +213,112 @@ public:
 
 
 private:
+    // 画布尺寸变化或被重新填充后，刷新缓存的 scanLine 指针
+    void bindCanvas();
+
+    // 设置像素写入的裁剪矩形（会再与画布范围求交）
+    void setClipRect(const QRect& r);
+
+    // 把本引擎作为 target 画布的“视图”：共享其像素内存，不拥有图元
+    // 供 TileRenderer 的工作线程各自持有独立的裁剪/录制状态
+    void attachView(const DrawEngine& target);
+
+    // 与任一矩形相交的图元（去重），按绘制顺序排列
+    void collectShapes(const std::vector<QRect>& rects, std::vector<Shape*>& out) const;
+
+private:
+    void attachShape(const std::shared_ptr<Shape>& s);
+    // 脏矩形并入脏区域（整个画布已脏时跳过，批量加入图元时不做逐个 QRegion 合并）
+    void addDamage(const QRect& r) { if (!damageAll) damage += r; }
+
     int penWidth;                                                       // 线宽
     LineStyle lineStyle;                                                // 线型
     LineCap lineCap;                                                    // 线帽
+    LineJoin lineJoin;                                                  // 折线连接
+    bool lineAntialiased;                                               // 新建直线的 Wu 抗锯齿
     QImage canvas;                                                      // 内存画布（像素矩阵）
-    std::vector<std::shared_ptr<Shape>> shapes;                         // 当前所有图形对象
+    ShapeRegistry registry;                                             // 当前所有图形对象（句柄 + 绘制顺序）
+    SpatialIndex spatialIndex;                                          // 图元包围盒索引（松散四叉树）
+    History history;                                                    // 撤销 / 重做
+
+    SceneSnapshot published;                                            // 最近一次发布的快照
+    std::vector<Shape*> snapshotChanged;                                // 此后被修改的图元
+    std::vector<Shape*> snapshotAppended;                               // 此后加到最上层的图元
+    qint64 snapshotTopZ = 0;                                            // 已发布与已追加图元的最大绘制序号
+    bool snapshotRebuild = true;                                        // 有删除 / 调整顺序等结构变化，下次整体重建
+
+    QRgb background;                                                    // 背景色（重绘脏区域时用于清空）
+    QRegion damage;                                                     // 待重绘的脏区域
+    bool damageAll = false;                                             // 整个画布已是脏区域，后续脏矩形不必再合并
+    RasterCache rasterCache;                                            // 图元光栅结果缓存
+    SpanList* recordTarget = nullptr;                                   // 非空时 span 写入录制到此列表而不写画布
+    bool tiledRendering = false;
+    bool antialiasing = false;
+    std::unique_ptr<TileRenderer> tileRenderer;                         // 分块重绘器（首次启用时创建）
+    ScanlineFiller filler;                                              // 复用的扫描线填充器（同上，每个引擎一份）
+
+    quint32* bits = nullptr;                                            // 画布首行像素（Format_RGB32）
+    int stride = 0;                                                     // 每行像素个数（bytesPerLine / 4）
+    int canvasW = 0;
+    int canvasH = 0;
+    int clipX0 = 0, clipY0 = 0;                                         // 当前裁剪矩形（闭区间）
+    int clipX1 = -1, clipY1 = -1;
 
     //int dashCounter = 0;
 };
 
+inline void DrawEngine::setPixelRgb(int x, int y, QRgb rgb)
+{
+    if (x < clipX0 || x > clipX1 || y < clipY0 || y > clipY1)
+        return;
+    if (recordTarget)
+    {
+        recordTarget->push_back({y, x, x, rgb});
+        return;
+    }
+    bits[y * stride + x] = rgb;
+}
+
+inline void DrawEngine::fillSpan(int y, int x0, int x1, QRgb rgb)
+{
+    if (y < clipY0 || y > clipY1) return;
+    if (x0 < clipX0) x0 = clipX0;
+    if (x1 > clipX1) x1 = clipX1;
+    if (x0 > x1) return;
+    if (recordTarget)
+    {
+        recordTarget->push_back({y, x0, x1, rgb});
+        return;
+    }
+
+    quint32* row = bits + y * stride;
+    std::fill(row + x0, row + x1 + 1, quint32(rgb));
+}
+
+inline void DrawEngine::blendSpan(int y, int x0, int x1, QRgb rgb, int alpha)
+{
+    if (y < clipY0 || y > clipY1) return;
+    if (x0 < clipX0) x0 = clipX0;
+    if (x1 > clipX1) x1 = clipX1;
+    if (x0 > x1) return;
+    if (recordTarget)
+    {
+        recordTarget->push_back({y, x0, x1, (rgb & 0x00ffffff) | (QRgb(alpha) << 24)});
+        return;
+    }
+
+    // 红蓝两个通道放在同一个 32 位数中一起乘，绿色单独乘；权重取 0..256，alpha 为 255 时结果就是 rgb
+    const quint32 a = quint32(alpha + (alpha >> 7));
+    const quint32 srcRb = (rgb & 0x00ff00ff) * a;
+    const quint32 srcG = (rgb & 0x0000ff00) * a;
+    quint32* row = bits + y * stride;
+    for (int x = x0; x <= x1; ++x)
+    {
+        const quint32 d = row[x];
+        const quint32 rb = (((d & 0x00ff00ff) * (256 - a) + srcRb) >> 8) & 0x00ff00ff;
+        const quint32 g = (((d & 0x0000ff00) * (256 - a) + srcG) >> 8) & 0x0000ff00;
+        row[x] = 0xff000000 | rb | g;
+    }
+}
+
 #endif // DRAWENGINE_H
@@ -0,0 +1,586 @@
+#include "ellipseshape.h"
+#include "arcshape.h"
+#include "drawengine.h"
+#include "stroker.h"
+#include "scanlinefiller.h"
+#include <QtMath>
+#include <algorithm>
+#include <climits>
+#include <cmath>
+
+namespace {
+
+// 像素中心恰好落在边界上时计入区域（与浮点舍入无关）
+const double EDGE_EPS = 1e-7;
+// 中点椭圆算法的判别式用 64 位整数，半轴超过此值时改为逐行解方程
+const int MIDPOINT_MAX_RADIUS = 16384;
+
+// 一行内按 x 排序、互不相交的像素区间（闭区间）
+struct RowSpans
+{
+    static constexpr int MAX = 4;
+    int n = 0;
+    int x0[MAX], x1[MAX];
+
+    void add(int a, int b)
+    {
+        if (a <= b && n < MAX) { x0[n] = a; x1[n] = b; ++n; }
+    }
+};
+
+RowSpans intersect(const RowSpans& a, const RowSpans& b)
+{
+    RowSpans out;
+    for (int i = 0; i < a.n; ++i)
+        for (int j = 0; j < b.n; ++j)
+            out.add(std::max(a.x0[i], b.x0[j]), std::min(a.x1[i], b.x1[j]));
+    return out;
+}
+
+int clampToInt(double t)
+{
+    return int(std::clamp(t, double(INT_MIN / 2), double(INT_MAX / 2)));
+}
+
+/**
+ * @brief 参数空间中的区域
+ * q = (a, b) 满足 p = origin + a·u + b·v；椭圆内部即单位圆盘 |q| <= 1。
+ * 扇形：两条边的半平面 cross(ps, q) >= 0（参数角不小于起始角）与 cross(q, pe) >= 0（不大于终止角），
+ * 扫过角不超过 180° 时取交，否则取并；弓形：弦所在直线上弧中点一侧的半平面。
+ * 仿射映射保持半平面，因此每行上的约束都是 x 的一次不等式
+ */
+class Region
+{
+public:
+    Region(const QPointF& origin, const QPointF& u, const QPointF& v,
+           EllipseShape::Form form, double startDeg, double sweepDeg)
+    {
+        const double det = u.x() * v.y() - v.x() * u.y();
+        valid = std::abs(det) > 1e-12 && sweepDeg > 0;
+        if (!valid) return;
+
+        // q = L⁻¹ (p - origin)，L 的两列为 u、v
+        ia = v.y() / det;  ib = -v.x() / det;
+        ic = -u.y() / det; id = u.x() / det;
+        ox = origin.x();   oy = origin.y();
+        if (form == EllipseShape::Form::Ellipse || sweepDeg >= 360.0) return;
+
+        const double s = qDegreesToRadians(startDeg);
+        const double e = qDegreesToRadians(startDeg + sweepDeg);
+        const QPointF ps(std::cos(s), std::sin(s)), pe(std::cos(e), std::sin(e));
+        if (form == EllipseShape::Form::Pie)
+        {
+            planes[0] = {-ps.y(), ps.x(), 0.0};
+            planes[1] = {pe.y(), -pe.x(), 0.0};
+            planeCount = 2;
+            unite = sweepDeg > 180.0;
+        }
+        else
+        {
+            const QPointF d = pe - ps;
+            HalfPlane h = {-d.y(), d.x(), d.y() * ps.x() - d.x() * ps.y()};
+            const double m = 0.5 * (s + e);
+            if (h.na * std::cos(m) + h.nb * std::sin(m) + h.k < 0)
+                h = {-h.na, -h.nb, -h.k};
+            planes[0] = h;
+            planeCount = 1;
+        }
+    }
+
+    bool isValid() const { return valid; }
+
+    // 点 p 是否在区域内（像素中心判定，与光栅化一致）
+    bool contains(const QPointF& p) const
+    {
+        if (!valid) return false;
+        const double a = ia * (p.x() - ox) + ib * (p.y() - oy);
+        const double b = ic * (p.x() - ox) + id * (p.y() - oy);
+        if (a * a + b * b > 1.0 + EDGE_EPS) return false;
+        if (planeCount == 0) return true;
+        const bool in0 = planes[0].na * a + planes[0].nb * b + planes[0].k >= -EDGE_EPS;
+        if (planeCount == 1) return in0;
+        const bool in1 = planes[1].na * a + planes[1].nb * b + planes[1].k >= -EDGE_EPS;
+        return unite ? (in0 || in1) : (in0 && in1);
+    }
+
+    // 第 y 行上像素中心落在椭圆内的区间 [l, r]，没有时返回 false
+    bool diskRow(int y, int& l, int& r) const
+    {
+        const double a0 = -ia * ox + ib * (y - oy), b0 = -ic * ox + id * (y - oy);
+        const double A = ia * ia + ic * ic;
+        const double B = a0 * ia + b0 * ic;
+        const double C = a0 * a0 + b0 * b0 - 1.0;
+        const double disc = B * B - A * C;
+        if (disc < 0) return false;
+        const double sq = std::sqrt(disc);
+        l = clampToInt(std::ceil((-B - sq) / A - EDGE_EPS));
+        r = clampToInt(std::floor((-B + sq) / A + EDGE_EPS));
+        return l <= r;
+    }
+
+    // 第 y 行的椭圆区间 [l, r] 按扇形 / 弓形的半平面裁剪
+    RowSpans clipRow(int y, int l, int r) const
+    {
+        RowSpans out;
+        if (l > r) return out;
+        if (planeCount == 0)
+        {
+            out.add(l, r);
+            return out;
+        }
+
+        int lo[2], hi[2];
+        for (int i = 0; i < planeCount; ++i)
+            bound(planes[i], y, lo[i], hi[i]);
+
+        if (planeCount == 1 || !unite)
+        {
+            int a = l, b = r;
+            for (int i = 0; i < planeCount; ++i)
+            {
+                a = std::max(a, lo[i]);
+                b = std::min(b, hi[i]);
+            }
+            out.add(a, b);
+            return out;
+        }
+
+        // 两个半平面的并：各自与 [l, r] 相交后按起点排序，重叠或相邻时合并
+        int a0 = std::max(l, lo[0]), b0 = std::min(r, hi[0]);
+        int a1 = std::max(l, lo[1]), b1 = std::min(r, hi[1]);
+        if (a0 > b0) { a0 = a1; b0 = b1; a1 = 1; b1 = 0; }
+        if (a1 <= b1)
+        {
+            if (a1 < a0) { std::swap(a0, a1); std::swap(b0, b1); }
+            if (a1 <= b0 + 1)
+                b0 = std::max(b0, b1);
+            else
+            {
+                out.add(a0, b0);
+                a0 = a1; b0 = b1;
+            }
+        }
+        out.add(a0, b0);
+        return out;
+    }
+
+private:
+    struct HalfPlane
+    {
+        double na, nb, k;                                               // na·a + nb·b + k >= 0
+    };
+
+    // 半平面在第 y 行上允许的 x 范围 [lo, hi]
+    void bound(const HalfPlane& h, int y, int& lo, int& hi) const
+    {
+        const double a0 = -ia * ox + ib * (y - oy), b0 = -ic * ox + id * (y - oy);
+        const double g0 = h.na * a0 + h.nb * b0 + h.k;
+        const double gx = h.na * ia + h.nb * ic;
+        lo = INT_MIN / 2;
+        hi = INT_MAX / 2;
+        if (std::abs(gx) < 1e-12)
+        {
+            if (g0 < -EDGE_EPS) { lo = 1; hi = 0; }
+            return;
+        }
+        const double t = -g0 / gx;
+        if (gx > 0)
+            lo = clampToInt(std::ceil(t - EDGE_EPS));
+        else
+            hi = clampToInt(std::floor(t + EDGE_EPS));
+    }
+
+    bool valid = false;
+    double ia = 0, ib = 0, ic = 0, id = 0, ox = 0, oy = 0;
+    HalfPlane planes[2] = {};
+    int planeCount = 0;
+    bool unite = false;
+};
+
+/**
+ * @brief 中点椭圆算法：半轴 a、b（整数）的椭圆在 |dy| = 0..b 各行的半宽
+ * 判别式整体乘 4 消去 1/4 与 (x + 1/2)²，全部为 64 位整数运算；
+ * 区域 1（斜率绝对值小于 1）同一行可能走多步，取该行最大的 x
+ */
+void midpointHalfWidths(int a, int b, std::vector<int>& hw)
+{
+    hw.assign(std::size_t(b) + 1, 0);
+    const qint64 a2 = qint64(a) * a, b2 = qint64(b) * b;
+    int x = 0, y = b;
+    qint64 dx = 0, dy = 2 * a2 * y;
+
+    qint64 d1 = 4 * b2 - 4 * a2 * b + a2;
+    while (dx < dy)
+    {
+        hw[y] = std::max(hw[y], x);
+        ++x;
+        dx += 2 * b2;
+        if (d1 < 0)
+            d1 += 4 * (dx + b2);
+        else
+        {
+            --y;
+            dy -= 2 * a2;
+            d1 += 4 * (dx - dy + b2);
+        }
+    }
+
+    qint64 d2 = b2 * (2 * x + 1) * (2 * x + 1) + 4 * a2 * (qint64(y) - 1) * (qint64(y) - 1) - 4 * a2 * b2;
+    while (y >= 0)
+    {
+        hw[y] = std::max(hw[y], x);
+        --y;
+        dy -= 2 * a2;
+        if (d2 > 0)
+            d2 += 4 * (a2 - dy);
+        else
+        {
+            ++x;
+            dx += 2 * b2;
+            d2 += 4 * (dx - dy + a2);
+        }
+    }
+}
+
+} // namespace
+
+/**
+ * @brief 默认构造函数：初始化为无效椭圆
+ */
+EllipseShape::EllipseShape()
+    : Shape(ShapeKind::Ellipse), center(0, 0), radiusX(0), radiusY(0)
+{
+}
+
+EllipseShape::EllipseShape(const QPoint& c, int rx, int ry, const QColor& color)
+    : Shape(ShapeKind::Ellipse), center(c), radiusX(rx), radiusY(ry)
+{
+    this->color = color;
+}
+
+double EllipseShape::sweepAngle() const
+{
+    return form == Form::Ellipse ? 360.0 : ArcShape::sweepOf(startAngle, endAngle);
+}
+
+/**
+ * @brief 映射后的椭圆：origin 为圆心的像，u、v 为两条源半轴的像
+ * 映射后两条半轴仍分别平行于坐标轴（平移、轴向缩放、镜像、90° 倍数的旋转）时，
+ * 圆心与半轴取整到像素，绘制走整数中点椭圆算法
+ */
+EllipseShape::Frame EllipseShape::frame() const
+{
+    Frame f;
+    f.origin = matrix.map(QPointF(center));
+    f.u = QPointF(matrix.m11(), matrix.m12()) * radiusX;
+    f.v = QPointF(matrix.m21(), matrix.m22()) * radiusY;
+
+    const double scale = std::abs(f.u.x()) + std::abs(f.u.y()) + std::abs(f.v.x()) + std::abs(f.v.y());
+    auto tiny = [&](double t) { return std::abs(t) <= 1e-9 * scale; };
+    if ((tiny(f.u.y()) && tiny(f.v.x())) || (tiny(f.u.x()) && tiny(f.v.y())))
+    {
+        auto snap = [&](double t) { return tiny(t) ? 0.0 : double(qRound(t)); };
+        f.axisAligned = true;
+        f.origin = QPointF(qRound(f.origin.x()), qRound(f.origin.y()));
+        f.u = QPointF(snap(f.u.x()), snap(f.u.y()));
+        f.v = QPointF(snap(f.v.x()), snap(f.v.y()));
+    }
+    return f;
+}
+
+bool EllipseShape::midpointAxes(const Frame& f, double sweep, int& a, int& b)
+{
+    if (!f.axisAligned || sweep < 360.0) return false;
+    a = int(std::abs(f.u.x()) + std::abs(f.v.x()));
+    b = int(std::abs(f.u.y()) + std::abs(f.v.y()));
+    return a <= MIDPOINT_MAX_RADIUS && b <= MIDPOINT_MAX_RADIUS;
+}
+
+std::vector<QPointF> EllipseShape::outlinePath(const Frame& f) const
+{
+    const double sweep = sweepAngle();
+    const double start = form == Form::Ellipse ? 0.0 : startAngle;
+    // 最大半轴的上界，折线在该半径的圆上满足弦高误差后，映射到椭圆上也满足
+    const double k = std::sqrt(f.u.x() * f.u.x() + f.u.y() * f.u.y() + f.v.x() * f.v.x() + f.v.y() * f.v.y());
+
+    std::vector<QPointF> path;
+    if (k <= 0 || sweep <= 0) return path;
+    const std::vector<QPointF> unit = Stroker::arcPolyline(QPointF(0, 0), k, start, sweep);
+    path.reserve(unit.size() + 1);
+    if (form == Form::Pie && sweep < 360.0)
+        path.push_back(f.origin);
+    for (const QPointF& p : unit)
+        path.push_back(f.origin + f.u * (p.x() / k) + f.v * (p.y() / k));
+    if (sweep >= 360.0)
+        path.pop_back();                                                // 整圈首尾重合
+    return path;
+}
+
+/**
+ * @brief 绘制椭圆 / 扇形 / 弓形
+ *
+ * 逐行求出区域的像素区间（中点椭圆或逐行解方程，再按半平面裁剪），
+ * 填充直接写 span；线宽 1 的实线轮廓取区域的边界像素：
+ * 本行区间去掉“左右相邻像素在本行内、上下两行同列像素也在区域内”的内部像素，剩下的同样按 span 写入。
+ * 只处理与当前裁剪矩形相交的行（另多算上下各一行用于判断边界）
+ */
+void EllipseShape::draw(DrawEngine* engine)
+{
+    if (!engine || radiusX <= 0 || radiusY <= 0) return;
+    const double sweep = sweepAngle();
+    if (sweep <= 0) return;
+
+    const Frame f = frame();
+    const QRgb strokeRgb = color.rgb();
+    const QRgb fillRgb = fillColor.rgb();
+
+    // 抗锯齿：覆盖率光栅化需要边，填充与描边都使用折线轮廓
+    if (engine->isAntialiasing())
+    {
+        std::vector<QPointF> path = outlinePath(f);
+        if (path.size() < 2) return;
+        ScanlineFiller& filler = engine->scanlineFiller();
+        if (filled)
+        {
+            filler.addContour(path);
+            filler.fill(engine, fillRgb, FillRule::NonZero);
+        }
+        Stroker stroker(penWidth, lineCap, lineJoin);
+        stroker.setCurve(true);
+        stroker.stroke(path, true, lineStyle, dashOffset, filler);
+        filler.fill(engine, strokeRgb, FillRule::NonZero);
+        return;
+    }
+
+    const Region region(f.origin, f.u, f.v, form, startAngle, sweep);
+    if (!region.isValid()) return;
+
+    const bool spanOutline = penWidth <= 1 && lineStyle == LineStyle::Solid;
+
+    // 椭圆占据的行范围；轴对齐的整椭圆（半轴不太大时）用中点椭圆算法的半宽表。
+    // 中点算法的边界像素可能落在精确曲线外约半个像素，扇形 / 弓形的边在细长椭圆上会把这点偏差
+    // 沿边放大成好几个像素，因此扇形 / 弓形总是逐行解方程，区域内的像素都在精确图形内
+    int a = 0, b = 0;
+    const bool midpoint = midpointAxes(f, sweep, a, b);
+    std::vector<int> halfWidths;
+    int top, bottom;
+    const int cx = int(f.origin.x()), cy = int(f.origin.y());
+    if (midpoint)
+    {
+        midpointHalfWidths(a, b, halfWidths);
+        top = cy - b;
+        bottom = cy + b;
+    }
+    else
+    {
+        const double hy = std::hypot(f.u.y(), f.v.y());
+        top = clampToInt(std::ceil(f.origin.y() - hy - EDGE_EPS));
+        bottom = clampToInt(std::floor(f.origin.y() + hy + EDGE_EPS));
+    }
+
+    auto regionRow = [&](int y) {
+        int l, r;
+        if (y < top || y > bottom) return RowSpans();
+        if (midpoint)
+        {
+            const int h = halfWidths[std::abs(y - cy)];
+            l = cx - h;
+            r = cx + h;
+        }
+        else if (!region.diskRow(y, l, r))
+            return RowSpans();
+        return region.clipRow(y, l, r);
+    };
+
+    const QRect clip = engine->currentClip();
+    const int y0 = std::max(top, clip.top());
+    const int y1 = std::min(bottom, clip.bottom());
+    if (y0 <= y1 && (filled || spanOutline))
+    {
+        RowSpans prev = spanOutline ? regionRow(y0 - 1) : RowSpans();
+        RowSpans cur = regionRow(y0);
+        for (int y = y0; y <= y1; ++y)
+        {
+            const RowSpans next = spanOutline ? regionRow(y + 1) : RowSpans();
+
+            if (filled)
+            {
+                for (int i = 0; i < cur.n; ++i)
+                    engine->fillSpan(y, cur.x0[i], cur.x1[i], fillRgb);
+            }
+
+            if (spanOutline)
+            {
+                RowSpans eroded;
+                for (int i = 0; i < cur.n; ++i)
+                    eroded.add(cur.x0[i] + 1, cur.x1[i] - 1);
+                const RowSpans inner = intersect(intersect(eroded, prev), next);
+
+                // 边界 = 本行区间 - 内部（内部区间都包含在某个本行区间中，且按 x 排序）
+                int j = 0;
+                for (int i = 0; i < cur.n; ++i)
+                {
+                    int x = cur.x0[i];
+                    for (; j < inner.n && inner.x1[j] <= cur.x1[i]; ++j)
+                    {
+                        if (inner.x0[j] > x)
+                            engine->fillSpan(y, x, inner.x0[j] - 1, strokeRgb);
+                        x = inner.x1[j] + 1;
+                    }
+                    if (x <= cur.x1[i])
+                        engine->fillSpan(y, x, cur.x1[i], strokeRgb);
+                }
+            }
+
+            prev = cur;
+            cur = spanOutline ? next : regionRow(y + 1);
+        }
+    }
+
+    if (spanOutline) return;
+
+    // 线宽大于 1 或虚线：沿折线轮廓描边
+    std::vector<QPointF> path = outlinePath(f);
+    if (path.size() < 2) return;
+    if (penWidth > 1)
+    {
+        ScanlineFiller& filler = engine->scanlineFiller();
+        Stroker(penWidth, lineCap, lineJoin).stroke(path, true, lineStyle, dashOffset, filler);
+        filler.fill(engine, strokeRgb, FillRule::NonZero);
+    }
+    else
+        drawDashedOutline(engine, path);
+}
+
+void EllipseShape::drawDashedOutline(DrawEngine* engine, const std::vector<QPointF>& path) const
+{
+    const QRgb rgb = color.rgb();
+    const std::size_t n = path.size();
+    int step = 0;
+    for (std::size_t i = 0; i < n; ++i)
+    {
+        // 每段不画终点像素：它是下一段的起点（最后一段的终点即整条轮廓的起点）
+        int x0 = qRound(path[i].x()), y0 = qRound(path[i].y());
+        const QPointF& to = path[(i + 1) % n];
+        const int x1 = qRound(to.x()), y1 = qRound(to.y());
+        const int dx = std::abs(x1 - x0), sx = x0 < x1 ? 1 : -1;
+        const int dy = -std::abs(y1 - y0), sy = y0 < y1 ? 1 : -1;
+        int err = dx + dy;
+        while (x0 != x1 || y0 != y1)
+        {
+            if (engine->shouldDrawAtStep(step, lineStyle, 1, dashOffset))
+                engine->setPixelRgb(x0, y0, rgb);
+            ++step;
+            const int e2 = 2 * err;
+            if (e2 >= dy) { err += dy; x0 += sx; }
+            if (e2 <= dx) { err += dx; y0 += sy; }
+        }
+    }
+}
+
+/**
+ * @brief 点选
+ * filled 时先做区域判定，与非抗锯齿光栅化一致：轴对齐的整椭圆查中点算法的半宽表，
+ * 其余按参数空间中的单位圆盘与半平面做像素中心判定；
+ * 轮廓按折线（弦高误差不超过 1/4 像素）求最短距离
+ */
+bool EllipseShape::contains(const QPoint& pt) const
+{
+    if (radiusX <= 0 || radiusY <= 0) return false;
+    const double sweep = sweepAngle();
+    if (sweep <= 0) return false;
+
+    // 包围盒已按加粗半径扩展，再放宽点选容差；盒外的点不必构造轮廓
+    const int tol = DrawEngine::HIT_TOLERANCE;
+    if (!boundingRect().adjusted(-tol, -tol, tol, tol).contains(pt))
+        return false;
+
+    const Frame f = frame();
+    if (filled)
+    {
+        int a, b;
+        if (midpointAxes(f, sweep, a, b))
+        {
+            const int dy = std::abs(pt.y() - int(f.origin.y()));
+            if (dy <= b)
+            {
+                std::vector<int> halfWidths;
+                midpointHalfWidths(a, b, halfWidths);
+                if (std::abs(pt.x() - int(f.origin.x())) <= halfWidths[dy])
+                    return true;
+            }
+        }
+        else if (Region(f.origin, f.u, f.v, form, startAngle, sweep).contains(QPointF(pt)))
+            return true;
+    }
+
+    const std::vector<QPointF> path = outlinePath(f);
+    if (path.empty()) return false;
+    return Stroker::polylineDistance(path, true, QPointF(pt)) <= DrawEngine::HIT_TOLERANCE + penWidth * 0.5;
+}
+
+QPointF EllipseShape::centroid() const
+{
+    return matrix.map(QPointF(center));
+}
+
+/**
+ * @brief 包围盒
+ * 映射后的椭圆 origin + u·cosθ + v·sinθ 的 x 在 θ = atan2(v.x, u.x)（及其反向）处取极值，y 同理；
+ * 扇形 / 弓形只取落在扫过范围内的极值点，再加上两个端点（扇形另加圆心）
+ */
+QRect EllipseShape::boundingRect() const
+{
+    if (radiusX <= 0 || radiusY <= 0) return QRect();
+    const double sweep = sweepAngle();
+    if (sweep <= 0) return QRect();
+
+    const Frame f = frame();
+    double minX, maxX, minY, maxY;
+    if (sweep >= 360.0)
+    {
+        const double hx = std::hypot(f.u.x(), f.v.x());
+        const double hy = std::hypot(f.u.y(), f.v.y());
+        minX = f.origin.x() - hx; maxX = f.origin.x() + hx;
+        minY = f.origin.y() - hy; maxY = f.origin.y() + hy;
+    }
+    else
+    {
+        const double s = qDegreesToRadians(startAngle);
+        const double w = qDegreesToRadians(sweep);
+        auto at = [&](double t) { return f.origin + f.u * std::cos(t) + f.v * std::sin(t); };
+        auto within = [&](double t) {
+            double d = std::fmod(t - s, 2 * M_PI);
+            if (d < 0) d += 2 * M_PI;
+            return d <= w;
+        };
+
+        std::vector<QPointF> pts = {at(s), at(s + w)};
+        if (form == Form::Pie)
+            pts.push_back(f.origin);
+        const double tx = std::atan2(f.v.x(), f.u.x());
+        const double ty = std::atan2(f.v.y(), f.u.y());
+        for (double t : {tx, tx + M_PI, ty, ty + M_PI})
+            if (within(t))
+                pts.push_back(at(t));
+
+        minX = maxX = pts[0].x();
+        minY = maxY = pts[0].y();
+        for (const QPointF& p : pts)
+        {
+            minX = std::min(minX, p.x()); maxX = std::max(maxX, p.x());
+            minY = std::min(minY, p.y()); maxY = std::max(maxY, p.y());
+        }
+    }
+
+    const int sr = strokeRadius();
+    return QRect(QPoint(int(std::floor(minX)) - sr, int(std::floor(minY)) - sr),
+                 QPoint(int(std::ceil(maxX)) + sr, int(std::ceil(maxY)) + sr));
+}
+
+// 只累积矩阵，源几何不变；绘制时再解析映射后的椭圆
+void EllipseShape::transform(const QTransform& m)
+{
+    matrix *= m;
+    invalidate();
+}
@@ -0,0 +1,85 @@
+#ifndef ELLIPSESHAPE_H
+#define ELLIPSESHAPE_H
+
+#include "shape.h"
+#include <QPoint>
+#include <QColor>
+#include <vector>
+
+/**
+ * @brief EllipseShape —— 椭圆 / 实心圆 / 扇形（Pie）/ 弓形（Chord）图元
+ *
+ * 源几何是轴对齐的椭圆：center、半轴 radiusX / radiusY；扇形与弓形另有起止角，
+ * 约定与 ArcShape 相同（0° 在右侧，顺时针增加），指椭圆的参数角。
+ * 变换只累积到 matrix，映射后可以是任意旋转、非等比缩放或错切的椭圆，绘制时不折线化：
+ *  - 整椭圆且 matrix 把它映射为轴对齐椭圆时，用整数中点椭圆算法求出每行的半宽；
+ *  - 否则（旋转、错切、扇形 / 弓形）在映射后的椭圆上逐行解二次方程，得到像素中心落在椭圆内的区间；
+ *  - 扇形 / 弓形在参数空间中是单位圆盘与半平面（扇形两条边 / 弦）的交，映射后仍是半平面，
+ *    每行区间再按半平面裁剪，至多两段；
+ *  - filled 时以 fillColor 写入区域的全部 span；线宽 1 的实线轮廓是区域的边界像素
+ *    （4 邻域中有像素不在区域内），同样按 span 写入，不逐像素 setPixel。
+ * 线宽大于 1、虚线与抗锯齿模式下，轮廓由 Stroker 描边（抗锯齿模式的填充也经同一条折线轮廓交给覆盖率光栅器），
+ * 结果与其它图元一样进入光栅缓存，重绘时直接回放。
+ *
+ * 实心圆即 radiusX == radiusY、filled 为 true 的椭圆
+ */
+class EllipseShape : public Shape
+{
+public:
+    enum class Form : quint8 {Ellipse, Pie, Chord};
+
+    EllipseShape();
+    EllipseShape(const QPoint& c, int rx, int ry, const QColor& color = Qt::black);
+
+    // 绘制：若 filled 则先填充再画轮廓
+    void draw(DrawEngine* engine) override;
+
+    // 点选：filled 时区域内的点（与非抗锯齿光栅化相同：轴对齐整椭圆查中点半宽表，其余按像素中心判定），
+    // 以及距轮廓不超过 HIT_TOLERANCE 加半线宽的点
+    bool contains(const QPoint& pt) const override;
+
+    QPointF centroid() const override;
+
+    // 包围盒：扇形 / 弓形只取实际扫过的部分（端点、圆心与弧上的极值点），按加粗半径扩展
+    QRect boundingRect() const override;
+
+    // 累积到 matrix，源几何不变
+    void transform(const QTransform& m) override;
+    int controlPointCount() const override { return 1; }
+    QPointF controlPoint(int) const override { return centroid(); }
+
+    // 扫过的参数角（°）：椭圆为 360，扇形 / 弓形与 ArcShape::sweepOf 相同
+    double sweepAngle() const;
+
+    QPoint center;                                              // 圆心
+    int radiusX;                                                // x 方向半轴
+    int radiusY;                                                // y 方向半轴
+    double startAngle = 0;                                      // 起始参数角（°，扇形 / 弓形）
+    double endAngle = 360;                                      // 终止参数角（°）
+    Form form = Form::Ellipse;
+
+    // 填充相关
+    bool filled = false;
+    QColor fillColor = Qt::white;
+
+protected:
+    std::shared_ptr<Shape> cloneShape() const override { return std::make_shared<EllipseShape>(*this); }
+
+private:
+    // 映射后的椭圆 p = origin + u·cosθ + v·sinθ；axisAligned 时 origin、u、v 已取整到像素
+    struct Frame
+    {
+        QPointF origin, u, v;
+        bool axisAligned = false;
+    };
+
+    Frame frame() const;
+    // 轴对齐的整椭圆（半轴不太大时）按中点椭圆算法的半宽表光栅化，a、b 为整数半轴
+    static bool midpointAxes(const Frame& f, double sweep, int& a, int& b);
+    // 轮廓折线（扇形含圆心，首尾相连，末点不重复首点），弦高误差不超过 1/4 像素
+    std::vector<QPointF> outlinePath(const Frame& f) const;
+    // 线宽 1 虚线轮廓：沿折线逐段 Bresenham，线型步数在各段之间连续
+    void drawDashedOutline(DrawEngine* engine, const std::vector<QPointF>& path) const;
+};
+
+#endif // ELLIPSESHAPE_H
@@ -0,0 +1,81 @@
+#include "ellipsetool.h"
+#include "drawengine.h"
+#include <QMouseEvent>
+#include <cmath>
+
+/**
+ * @brief 构造函数：初始化绘制状态
+ */
+EllipseTool::EllipseTool() : isDrawing(false)
+{
+}
+
+/**
+ * @brief 鼠标按下事件：确定圆心并创建图元
+ * 形状、填充与画笔属性在按下时确定，拖动过程中只改变几何
+ */
+void EllipseTool::onMousePress(QMouseEvent* e, DrawEngine* engine)
+{
+    if (!engine || e->button() != Qt::LeftButton) return;
+
+    currentEllipse = std::make_shared<EllipseShape>(e->pos(), 0, 0);
+    currentEllipse->form = form;
+    currentEllipse->startAngle = 0;
+    currentEllipse->endAngle = form == EllipseShape::Form::Ellipse ? 360 : 0;
+    currentEllipse->filled = fillOnComplete;
+    currentEllipse->fillColor = fillColor;
+    isDrawing = true;
+
+    // 绑定当前画笔属性（从引擎读取）
+    currentEllipse->penWidth = engine->getPenWidth();
+    currentEllipse->lineStyle = engine->getLineStyle();
+    currentEllipse->lineCap = engine->getLineCap();
+    currentEllipse->lineJoin = engine->getLineJoin();
+
+    engine->addShape(currentEllipse);
+}
+
+/**
+ * @brief 鼠标移动事件：动态更新半轴与角度
+ * 角度约定同 ArcTool：0° 在圆心右侧，顺时针增加
+ */
+void EllipseTool::onMouseMove(QMouseEvent* e, DrawEngine* engine)
+{
+    if (!isDrawing || !engine || !(e->buttons() & Qt::LeftButton))
+        return;
+
+    const QPoint current = e->pos();
+    const int dx = current.x() - currentEllipse->center.x();
+    const int dy = current.y() - currentEllipse->center.y();
+
+    if (form == EllipseShape::Form::Ellipse)
+    {
+        currentEllipse->radiusX = std::abs(dx);
+        currentEllipse->radiusY = std::abs(dy);
+        if (e->modifiers() & Qt::ShiftModifier)                             // Shift：取较大的偏移画圆
+            currentEllipse->radiusX = currentEllipse->radiusY = std::max(std::abs(dx), std::abs(dy));
+    }
+    else
+    {
+        const int r = int(std::sqrt(double(dx) * dx + double(dy) * dy));
+        currentEllipse->radiusX = currentEllipse->radiusY = r;
+        currentEllipse->endAngle = atan2(-dy, dx) * -180.0 / M_PI;
+        if (currentEllipse->endAngle < 0) currentEllipse->endAngle += 360;
+    }
+
+    engine->redrawShape(currentEllipse);
+}
+
+/**
+ * @brief 鼠标释放事件：结束绘制并记录到撤销历史
+ */
+void EllipseTool::onMouseRelease(QMouseEvent* e, DrawEngine* engine)
+{
+    if (!isDrawing || e->button() != Qt::LeftButton)
+        return;
+
+    isDrawing = false;
+    if (engine && currentEllipse)
+        engine->getHistory().push(std::make_unique<AddShapeCommand>(currentEllipse));
+    currentEllipse.reset();
+}
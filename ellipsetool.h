@@ -0,0 +1,42 @@
+#ifndef ELLIPSETOOL_H
+#define ELLIPSETOOL_H
+
+#include "basetool.h"
+#include "ellipseshape.h"
+
+/**
+ * @brief 鼠标绘制椭圆 / 扇形 / 弓形工具类（EllipseTool）
+ *
+ * 继承自 BaseTool，按当前形状（setForm）动态生成 EllipseShape：
+ * 按下鼠标左键（onMousePress） → 确定圆心，创建 EllipseShape
+ * 拖动鼠标左键（onMouseMove） → 椭圆：横、纵向偏移分别为两个半轴（按住 Shift 为圆）；
+ *                               扇形 / 弓形：与 ArcTool 相同，距离为半径，方向为终止角度
+ * 释放鼠标左键（onMouseRelease） → 绘制结束，提交图元
+ *
+ * 本类不直接绘图，具体绘制算法由 EllipseShape 内实现
+ */
+class EllipseTool : public BaseTool
+{
+public:
+    EllipseTool();
+
+    QString toolName() const override { return "EllipseTool"; }
+
+    void onMousePress(QMouseEvent* e, DrawEngine* engine) override;
+    void onMouseMove(QMouseEvent* e, DrawEngine* engine) override;
+    void onMouseRelease(QMouseEvent* e, DrawEngine* engine) override;
+
+    void setForm(EllipseShape::Form f) { form = f; }
+    void setFillOnComplete(bool v) { fillOnComplete = v; }
+    void setFillColor(const QColor &c) { fillColor = c; }
+
+    EllipseShape::Form form = EllipseShape::Form::Ellipse;
+    bool fillOnComplete = false;
+    QColor fillColor = Qt::yellow;
+
+private:
+    std::shared_ptr<EllipseShape> currentEllipse;                           // 当前正在绘制的图元（共享指针，交由 DrawEngine 管理）
+    bool isDrawing;                                                         // 是否处于绘制状态（按下左键后为 true）
+};
+
+#endif // ELLIPSETOOL_H
@@ -21,6 +21,7 @@ void FillTool::onMousePress(QMouseEvent* e, DrawEngine* engine)
     if (rs)
     {
         engine->addShape(rs);    // 把填充结果作为永久图元加入 engine
+        engine->getHistory().push(std::make_unique<AddShapeCommand>(rs));
         engine->redrawShape(rs); // 可选：立即把它绘到当前 canvas（下一帧也会重绘）
     }
     else
@@ -0,0 +1,412 @@
+#include "history.h"
+#include "drawengine.h"
+#include "lineshape.h"
+#include "arcshape.h"
+#include "ellipseshape.h"
+#include "polygonshape.h"
+#include "rasterfillshape.h"
+
+namespace {
+
+// 历史持有的图元对象的近似大小（多边形另计源几何，填充按 span 个数计）
+std::size_t shapeBytes(const Shape& s)
+{
+    switch (s.kind())
+    {
+    case ShapeKind::Line:
+        return sizeof(LineShape);
+    case ShapeKind::Arc:
+        return sizeof(ArcShape);
+    case ShapeKind::Ellipse:
+        return sizeof(EllipseShape);
+    case ShapeKind::Polygon:
+    case ShapeKind::TangramPiece:
+        return sizeof(PolygonShape)
+               + static_cast<const PolygonShape&>(s).vertices().capacity() * (sizeof(QPoint) + sizeof(QPointF));
+    case ShapeKind::RasterFill:
+        return sizeof(RasterFillShape)
+               + static_cast<const RasterFillShape&>(s).spans.capacity() * sizeof(RasterFillShape::Span);
+    }
+    return sizeof(Shape);
+}
+
+bool isPolygonKind(const Shape& s)
+{
+    return s.kind() == ShapeKind::Polygon || s.kind() == ShapeKind::TangramPiece;
+}
+
+} // namespace
+
+// ---------------------------------------------------------------- 增删
+
+AddShapeCommand::AddShapeCommand(std::shared_ptr<Shape> s)
+    : shape(std::move(s)), z(shape->zOrder)
+{
+}
+
+void AddShapeCommand::undo(DrawEngine& engine)
+{
+    engine.removeShape(shape);
+}
+
+void AddShapeCommand::redo(DrawEngine& engine)
+{
+    engine.addShapeAt(shape, z);
+}
+
+std::size_t AddShapeCommand::byteSize() const
+{
+    return sizeof(*this) + shapeBytes(*shape);
+}
+
+RemoveShapeCommand::RemoveShapeCommand(std::shared_ptr<Shape> s)
+    : shape(std::move(s)), z(shape->zOrder)
+{
+}
+
+void RemoveShapeCommand::undo(DrawEngine& engine)
+{
+    engine.addShapeAt(shape, z);
+}
+
+void RemoveShapeCommand::redo(DrawEngine& engine)
+{
+    engine.removeShape(shape);
+}
+
+std::size_t RemoveShapeCommand::byteSize() const
+{
+    return sizeof(*this) + shapeBytes(*shape);
+}
+
+// ---------------------------------------------------------------- 变换
+
+TransformCommand::TransformCommand(std::vector<std::shared_ptr<Shape>> s, const QTransform& m)
+    : shapes(std::move(s)), matrix(m)
+{
+}
+
+// 图元保存源几何与累积矩阵，施加逆矩阵即回到变换前的坐标
+void TransformCommand::undo(DrawEngine&)
+{
+    const QTransform inv = matrix.inverted();
+    for (auto& s : shapes)
+        s->transform(inv);
+}
+
+void TransformCommand::redo(DrawEngine&)
+{
+    for (auto& s : shapes)
+        s->transform(matrix);
+}
+
+std::size_t TransformCommand::byteSize() const
+{
+    return sizeof(*this) + shapes.capacity() * sizeof(std::shared_ptr<Shape>);
+}
+
+// ---------------------------------------------------------------- 几何
+
+GeometryState GeometryState::capture(const Shape& s)
+{
+    GeometryState g;
+    if (s.kind() == ShapeKind::Line)
+    {
+        static_cast<const LineShape&>(s).getSource(g.points, g.matrix);
+    }
+    else if (isPolygonKind(s))
+    {
+        static_cast<const PolygonShape&>(s).getSource(g.points, g.matrix);
+    }
+    else if (s.kind() == ShapeKind::Arc)
+    {
+        const ArcShape& arc = static_cast<const ArcShape&>(s);
+        g.center = arc.center;
+        g.radius = arc.radius;
+        g.startAngle = arc.startAngle;
+        g.endAngle = arc.endAngle;
+        g.matrix = arc.matrix;
+    }
+    else if (s.kind() == ShapeKind::Ellipse)
+    {
+        g.matrix = s.matrix;                                            // 源椭圆只经 matrix 改变
+    }
+    return g;
+}
+
+GeometryCommand::GeometryCommand(std::shared_ptr<Shape> s, const GeometryState& before, const GeometryState& after)
+    : shape(std::move(s))
+{
+    if (shape->kind() == ShapeKind::Arc)
+    {
+        arcBefore = before;
+        arcAfter = after;
+        empty = before.center == after.center && before.radius == after.radius
+                && before.startAngle == after.startAngle && before.endAngle == after.endAngle
+                && before.matrix == after.matrix;
+        return;
+    }
+    if (shape->kind() == ShapeKind::Ellipse)
+    {
+        matrixBefore = before.matrix;
+        matrixAfter = after.matrix;
+        empty = before.matrix == after.matrix;
+        return;
+    }
+
+    matrixBefore = before.matrix;
+    matrixAfter = after.matrix;
+    if (before.points.size() != after.points.size())
+    {
+        resized = true;
+        fullBefore = before.points;
+        fullAfter = after.points;
+        return;
+    }
+
+    for (std::size_t i = 0; i < before.points.size(); ++i)
+    {
+        if (before.points[i] != after.points[i])
+            deltas.push_back({int(i), before.points[i], after.points[i]});
+    }
+    deltas.shrink_to_fit();
+    empty = deltas.empty() && before.matrix == after.matrix;
+}
+
+void GeometryCommand::apply(bool forward)
+{
+    if (shape->kind() == ShapeKind::Arc)
+    {
+        ArcShape& arc = static_cast<ArcShape&>(*shape);
+        const GeometryState& g = forward ? arcAfter : arcBefore;
+        arc.center = g.center;
+        arc.radius = g.radius;
+        arc.startAngle = g.startAngle;
+        arc.endAngle = g.endAngle;
+        arc.matrix = g.matrix;
+    }
+    else if (shape->kind() == ShapeKind::Ellipse)
+    {
+        shape->matrix = forward ? matrixAfter : matrixBefore;
+    }
+    else
+    {
+        // 在当前源几何上只改动差量涉及的顶点，连同矩阵写回后重新解析
+        std::vector<QPointF> pts;
+        QTransform m;
+        if (shape->kind() == ShapeKind::Line)
+            static_cast<LineShape&>(*shape).getSource(pts, m);
+        else if (isPolygonKind(*shape))
+            static_cast<PolygonShape&>(*shape).getSource(pts, m);
+        else
+            return;
+
+        if (resized)
+            pts = forward ? fullAfter : fullBefore;
+        for (const VertexDelta& d : deltas)
+            pts[d.index] = forward ? d.after : d.before;
+        m = forward ? matrixAfter : matrixBefore;
+
+        if (shape->kind() == ShapeKind::Line)
+            static_cast<LineShape&>(*shape).setSource(std::move(pts), m);
+        else
+            static_cast<PolygonShape&>(*shape).setSource(std::move(pts), m);
+    }
+    shape->invalidate();
+}
+
+void GeometryCommand::undo(DrawEngine&)
+{
+    apply(false);
+}
+
+void GeometryCommand::redo(DrawEngine&)
+{
+    apply(true);
+}
+
+std::size_t GeometryCommand::byteSize() const
+{
+    return sizeof(*this) + deltas.capacity() * sizeof(VertexDelta)
+           + (fullBefore.capacity() + fullAfter.capacity()) * sizeof(QPointF);
+}
+
+// ---------------------------------------------------------------- 样式
+
+ShapeStyle ShapeStyle::capture(const Shape& s)
+{
+    ShapeStyle st;
+    st.color = s.color;
+    st.penWidth = s.penWidth;
+    st.lineStyle = s.lineStyle;
+    st.lineCap = s.lineCap;
+    st.lineJoin = s.lineJoin;
+    st.dashOffset = s.dashOffset;
+    if (isPolygonKind(s))
+    {
+        const PolygonShape& poly = static_cast<const PolygonShape&>(s);
+        st.filled = poly.filled;
+        st.fillColor = poly.fillColor;
+    }
+    return st;
+}
+
+void ShapeStyle::apply(Shape& s) const
+{
+    s.color = color;
+    s.penWidth = penWidth;
+    s.lineStyle = lineStyle;
+    s.lineCap = lineCap;
+    s.lineJoin = lineJoin;
+    s.dashOffset = dashOffset;
+    if (isPolygonKind(s))
+    {
+        PolygonShape& poly = static_cast<PolygonShape&>(s);
+        poly.filled = filled;
+        poly.fillColor = fillColor;
+    }
+    s.invalidate();
+}
+
+StyleCommand::StyleCommand(std::shared_ptr<Shape> s, const ShapeStyle& b, const ShapeStyle& a)
+    : shape(std::move(s)), before(b), after(a)
+{
+}
+
+void StyleCommand::undo(DrawEngine&)
+{
+    before.apply(*shape);
+}
+
+void StyleCommand::redo(DrawEngine&)
+{
+    after.apply(*shape);
+}
+
+// ---------------------------------------------------------------- 历史
+
+namespace {
+
+// 宏：一组命令合成一步，撤销时逆序执行
+class MacroCommand : public HistoryCommand
+{
+public:
+    void undo(DrawEngine& engine) override
+    {
+        for (auto it = commands.rbegin(); it != commands.rend(); ++it)
+            (*it)->undo(engine);
+    }
+
+    void redo(DrawEngine& engine) override
+    {
+        for (auto& c : commands)
+            c->redo(engine);
+    }
+
+    std::size_t byteSize() const override
+    {
+        std::size_t n = sizeof(*this);
+        for (const auto& c : commands)
+            n += c->byteSize();
+        return n;
+    }
+
+    std::vector<std::unique_ptr<HistoryCommand>> commands;
+};
+
+} // namespace
+
+void History::push(std::unique_ptr<HistoryCommand> cmd)
+{
+    if (!cmd) return;
+    if (macroDepth > 0)
+    {
+        macroCommands.push_back(std::move(cmd));
+        return;
+    }
+
+    // 丢弃可重做的部分
+    while (entries.size() > cursor)
+    {
+        used -= entrySizes.back();
+        entries.pop_back();
+        entrySizes.pop_back();
+    }
+
+    const std::size_t bytes = cmd->byteSize();
+    entries.push_back(std::move(cmd));
+    entrySizes.push_back(bytes);
+    used += bytes;
+    cursor = entries.size();
+    trim();
+}
+
+void History::beginMacro()
+{
+    ++macroDepth;
+}
+
+void History::endMacro()
+{
+    if (macroDepth == 0 || --macroDepth > 0) return;
+
+    std::vector<std::unique_ptr<HistoryCommand>> commands = std::move(macroCommands);
+    macroCommands.clear();
+    if (commands.empty()) return;                                       // 没有任何改动：不占一步
+    if (commands.size() == 1)
+    {
+        push(std::move(commands.front()));
+        return;
+    }
+    auto macro = std::make_unique<MacroCommand>();
+    macro->commands = std::move(commands);
+    push(std::move(macro));
+}
+
+bool History::undo(DrawEngine& engine)
+{
+    if (macroDepth > 0 || cursor == 0) return false;
+    entries[--cursor]->undo(engine);
+    return true;
+}
+
+bool History::redo(DrawEngine& engine)
+{
+    if (macroDepth > 0 || cursor >= entries.size()) return false;
+    entries[cursor++]->redo(engine);
+    return true;
+}
+
+void History::clear()
+{
+    entries.clear();
+    entrySizes.clear();
+    cursor = 0;
+    used = 0;
+    macroCommands.clear();
+    macroDepth = 0;
+}
+
+void History::setMemoryBudget(std::size_t bytes)
+{
+    budget = bytes;
+    trim();
+}
+
+// 超出预算时先丢弃可重做的命令（从最远的一步起），再从最早的命令开始丢弃（至少保留最近一步可撤销的命令）
+void History::trim()
+{
+    while (used > budget && entries.size() > cursor)
+    {
+        used -= entrySizes.back();
+        entries.pop_back();
+        entrySizes.pop_back();
+    }
+    while (used > budget && cursor > 1)
+    {
+        used -= entrySizes.front();
+        entries.pop_front();
+        entrySizes.pop_front();
+        --cursor;
+    }
+}
@@ -0,0 +1,193 @@
+#ifndef HISTORY_H
+#define HISTORY_H
+
+#include "shape.h"
+#include <QPoint>
+#include <QColor>
+#include <QTransform>
+#include <vector>
+#include <deque>
+#include <memory>
+#include <cstddef>
+
+class DrawEngine;
+
+/**
+ * @brief HistoryCommand —— 一步可撤销的编辑
+ *
+ * 命令在编辑完成之后记录（push 时不执行），只保存撤销 / 重做所需的最小差量：
+ * 增删记录图元对象本身与绘制序号，变换记录一个矩阵，几何编辑记录变化的顶点，样式编辑记录新旧样式
+ */
+class HistoryCommand
+{
+public:
+    virtual ~HistoryCommand() = default;
+    virtual void undo(DrawEngine& engine) = 0;
+    virtual void redo(DrawEngine& engine) = 0;
+    // 估算占用的字节数（计入历史的内存预算）
+    virtual std::size_t byteSize() const = 0;
+};
+
+// 加入图元（绘制、填充）：撤销时移除，重做时按原绘制序号放回；填充图元本身就是按行的 span 游程
+class AddShapeCommand : public HistoryCommand
+{
+public:
+    explicit AddShapeCommand(std::shared_ptr<Shape> s);
+    void undo(DrawEngine& engine) override;
+    void redo(DrawEngine& engine) override;
+    std::size_t byteSize() const override;
+
+private:
+    std::shared_ptr<Shape> shape;
+    qint64 z;
+};
+
+// 移除图元：必须在移除之前构造（记录其绘制序号）
+class RemoveShapeCommand : public HistoryCommand
+{
+public:
+    explicit RemoveShapeCommand(std::shared_ptr<Shape> s);
+    void undo(DrawEngine& engine) override;
+    void redo(DrawEngine& engine) override;
+    std::size_t byteSize() const override;
+
+private:
+    std::shared_ptr<Shape> shape;
+    qint64 z;
+};
+
+// 对一组图元施加同一个仿射变换：只保存矩阵，撤销时施加逆矩阵（矩阵必须可逆）
+class TransformCommand : public HistoryCommand
+{
+public:
+    TransformCommand(std::vector<std::shared_ptr<Shape>> shapes, const QTransform& m);
+    void undo(DrawEngine& engine) override;
+    void redo(DrawEngine& engine) override;
+    std::size_t byteSize() const override;
+
+private:
+    std::vector<std::shared_ptr<Shape>> shapes;
+    QTransform matrix;
+};
+
+/**
+ * @brief 图元的几何状态：源几何（直线端点 / 多边形顶点 / 圆弧参数）与累积矩阵
+ * 编辑前 capture()，编辑后再 capture() 一次，交给 GeometryCommand 求差量；
+ * 保存的是源几何而不是取整后的坐标，恢复后再做变换的撤销不会产生取整漂移
+ */
+struct GeometryState
+{
+    std::vector<QPointF> points;
+    QPoint center;
+    int radius = 0;
+    double startAngle = 0;
+    double endAngle = 0;
+    QTransform matrix;
+
+    static GeometryState capture(const Shape& s);
+};
+
+// 几何编辑（裁剪等）：顶点数不变时只保存变化的源顶点，否则保存新旧两份源顶点
+class GeometryCommand : public HistoryCommand
+{
+public:
+    GeometryCommand(std::shared_ptr<Shape> s, const GeometryState& before, const GeometryState& after);
+    void undo(DrawEngine& engine) override;
+    void redo(DrawEngine& engine) override;
+    std::size_t byteSize() const override;
+
+    // 两个状态完全相同（编辑没有改变几何，无需记录）
+    bool isEmpty() const { return empty; }
+
+private:
+    struct VertexDelta
+    {
+        int index;
+        QPointF before;
+        QPointF after;
+    };
+
+    void apply(bool forward);
+
+    std::shared_ptr<Shape> shape;
+    std::vector<VertexDelta> deltas;                                    // 顶点数不变时使用
+    std::vector<QPointF> fullBefore, fullAfter;                         // 顶点数改变时使用
+    bool resized = false;
+    QTransform matrixBefore, matrixAfter;
+    GeometryState arcBefore, arcAfter;                                  // 仅圆弧：参数与矩阵（points 为空）
+    bool empty = false;
+};
+
+// 图元的样式字段
+struct ShapeStyle
+{
+    QColor color;
+    int penWidth = 1;
+    LineStyle lineStyle = LineStyle::Solid;
+    LineCap lineCap = LineCap::Round;
+    LineJoin lineJoin = LineJoin::Round;
+    int dashOffset = 0;
+    bool filled = false;                                                // 仅多边形
+    QColor fillColor;
+
+    static ShapeStyle capture(const Shape& s);
+    void apply(Shape& s) const;
+};
+
+class StyleCommand : public HistoryCommand
+{
+public:
+    StyleCommand(std::shared_ptr<Shape> s, const ShapeStyle& before, const ShapeStyle& after);
+    void undo(DrawEngine& engine) override;
+    void redo(DrawEngine& engine) override;
+    std::size_t byteSize() const override { return sizeof(*this); }
+
+private:
+    std::shared_ptr<Shape> shape;
+    ShapeStyle before, after;
+};
+
+/**
+ * @brief History —— DrawEngine 的撤销 / 重做历史
+ *
+ * - 线性历史：undo 后再 push 新命令会丢弃可重做的部分
+ * - beginMacro() / endMacro() 之间 push 的命令合成一步（裁剪、对整个选区的变换）
+ * - 内存预算：全部命令的 byteSize() 之和超出预算时先丢弃可重做的命令，再从最早的命令开始丢弃
+ *   （最近一步可撤销的命令总是保留，即使它本身超出预算）
+ * 撤销 / 重做一步的代价只与该步改动的图元与顶点数有关，与场景规模无关
+ */
+class History
+{
+public:
+    static constexpr std::size_t DEFAULT_BUDGET = 64u << 20;            // 64 MB
+
+    void push(std::unique_ptr<HistoryCommand> cmd);
+
+    void beginMacro();
+    void endMacro();
+
+    bool undo(DrawEngine& engine);
+    bool redo(DrawEngine& engine);
+    bool canUndo() const { return cursor > 0; }
+    bool canRedo() const { return cursor < entries.size(); }
+
+    void clear();
+    void setMemoryBudget(std::size_t bytes);
+    std::size_t memoryBudget() const { return budget; }
+    std::size_t memoryUsed() const { return used; }
+    std::size_t size() const { return entries.size(); }
+
+private:
+    void trim();
+
+    std::deque<std::unique_ptr<HistoryCommand>> entries;
+    std::deque<std::size_t> entrySizes;                                 // push 时记录的 byteSize()
+    std::size_t cursor = 0;                                             // [0, cursor) 可撤销，[cursor, size) 可重做
+    std::size_t used = 0;
+    std::size_t budget = DEFAULT_BUDGET;
+
+    std::vector<std::unique_ptr<HistoryCommand>> macroCommands;         // 正在记录的宏
+    int macroDepth = 0;
+};
+
+#endif // HISTORY_H
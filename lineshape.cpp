@@ -1,18 +1,33 @@
 #include "lineshape.h"
 #include "drawengine.h"
+#include "stroker.h"
+#include "scanlinefiller.h"
+#include "pointtransform.h"
 
 /**
- * @brief 使用 Bresenham 算法绘制一条直线
+ * @brief 绘制直线
  *
+ * 线宽为 1 时使用 Bresenham 算法逐像素绘制（细线）：
  * 整个算法完全基于整数计算
  * 只使用加减法和比较操作
  * 避免浮点数计算，提高性能
  *
- * 每次迭代计算下一个像素点，并通过 DrawEngine::drawStyledPixelAtStep 写入画布
+ * 线宽大于 1 或引擎开启抗锯齿时由 Stroker 生成带线帽的描边轮廓，再用扫描线（覆盖率）填充；
+ * 线宽为 1 且 antialiased 时使用 Wu 细线（比覆盖率描边便宜得多），水平 / 竖直 / 45° 的直线两者结果相同，仍走 Bresenham
  */
 void LineShape::draw(DrawEngine* engine)
 {
     if (!engine) return;
+    resolve();
+
+    if (penWidth > 1 || (engine->isAntialiasing() && !antialiased))
+    {
+        ScanlineFiller& filler = engine->scanlineFiller();
+        Stroker(penWidth, lineCap, lineJoin).stroke({QPointF(start), QPointF(end)}, false,
+                                                    lineStyle, dashOffset, filler);
+        filler.fill(engine, color.rgb(), FillRule::NonZero);
+        return;
+    }
 
     int x0 = start.x();
     int y0 = start.y();
@@ -24,10 +39,18 @@ void LineShape::draw(DrawEngine* engine)
     int err = dx + dy, e2;
 
     int step = 0;
+    const QRgb rgb = color.rgb();                                   // 颜色只打包一次，逐步写入时不再构造 QColor
+
+    if (antialiased && dx != 0 && dy != 0 && dx != -dy)
+    {
+        drawWu(engine, rgb);
+        return;
+    }
 
     while (true)
     {
-        engine->drawStyledPixelAtStep(x0, y0, color, step, lineStyle, penWidth, dashOffset);
+        if (engine->shouldDrawAtStep(step, lineStyle, 1, dashOffset))
+            engine->setPixelRgb(x0, y0, rgb);
         ++step;
         if (x0 == x1 && y0 == y1) break;
         e2 = 2 * err;
@@ -37,6 +60,48 @@ void LineShape::draw(DrawEngine* engine)
 }
 
 
+/**
+ * @brief Wu 抗锯齿细线
+ * 沿主轴每步一个位置（步数与 Bresenham 相同，虚线照旧由 shouldDrawAtStep 按步判断）：
+ *  - 次轴坐标的小数部分用 32 位定点累加，溢出即次轴前进一格；
+ *    增量向上取整，保证最后一步恰好进位到终点，两端点的权重都是 0
+ *  - 取小数部分高 8 位 w，近侧像素覆盖率 255 - w，远侧像素 w，用 DrawEngine::blendSpan 的整数混合写入
+ */
+void LineShape::drawWu(DrawEngine* engine, QRgb rgb) const
+{
+    int x = start.x(), y = start.y();
+    const int dx = std::abs(end.x() - x), dy = std::abs(end.y() - y);
+    const int sx = x < end.x() ? 1 : -1;
+    const int sy = y < end.y() ? 1 : -1;
+
+    const bool xMajor = dx >= dy;
+    const int major = xMajor ? dx : dy;
+    const int minor = xMajor ? dy : dx;
+    const quint32 adj = quint32(((quint64(minor) << 32) + quint64(major) - 1) / quint64(major));
+
+    quint32 frac = 0;
+    for (int step = 0; step <= major; ++step)
+    {
+        if (engine->shouldDrawAtStep(step, lineStyle, 1, dashOffset))
+        {
+            const int w = int(frac >> 24);
+            if (w != 255)
+                engine->blendSpan(y, x, x, rgb, 255 - w);
+            if (w != 0)
+            {
+                if (xMajor) engine->blendSpan(y + sy, x, x, rgb, w);
+                else        engine->blendSpan(y, x + sx, x + sx, rgb, w);
+            }
+        }
+
+        const quint32 prev = frac;
+        frac += adj;
+        const bool carry = frac < prev;
+        if (xMajor) { x += sx; if (carry) y += sy; }
+        else        { y += sy; if (carry) x += sx; }
+    }
+}
+
 /**
  * @brief 判断点是否在直线段上（用于选中判断）
  *
@@ -47,6 +112,7 @@ void LineShape::draw(DrawEngine* engine)
  */
 bool LineShape::contains(const QPoint& pt) const
 {
+    resolve();
     double x0 = start.x(), y0 = start.y();
     double x1 = end.x(),   y1 = end.y();
     double x  = pt.x(),    y  = pt.y();
@@ -68,10 +134,82 @@ bool LineShape::contains(const QPoint& pt) const
 }
 
 
+// 包围盒：两端点构成的矩形，四周按加粗半径扩展
+QRect LineShape::boundingRect() const
+{
+    resolve();
+    int r = strokeRadius();
+    return QRect(QPoint(std::min(start.x(), end.x()) - r, std::min(start.y(), end.y()) - r),
+                 QPoint(std::max(start.x(), end.x()) + r, std::max(start.y(), end.y()) + r));
+}
+
+
 // centroid：线段重心（中点）
 QPointF LineShape::centroid() const
 {
+    resolve();
     return QPointF( (start.x() + end.x()) * 0.5, (start.y() + end.y()) * 0.5 );
 }
 
+// 端点总是从源几何经 matrix 解析，不会在连续变换里累积取整误差
+// 同一图元只由一个线程录制（TileRenderer 按图元分派），惰性解析不需要加锁
+void LineShape::resolve() const
+{
+    if (!endpointsDirty) return;
+    const QPointF src[2] = {sourceStart, sourceEnd};
+    QPoint pts[2];
+    PointTransform::map(matrix, src, pts, 2);
+    start = pts[0];
+    end = pts[1];
+    endpointsDirty = false;
+}
 
+void LineShape::setEndpoints(const QPoint& a, const QPoint& b)
+{
+    sourceStart = QPointF(a);
+    sourceEnd = QPointF(b);
+    start = a;
+    end = b;
+    matrix = QTransform();
+    endpointsDirty = false;
+}
+
+// 变换累积到 matrix，端点留到下一次读取时解析
+void LineShape::transform(const QTransform& m)
+{
+    matrix *= m;
+    endpointsDirty = true;
+    invalidate();
+}
+
+void LineShape::getSource(std::vector<QPointF>& pts, QTransform& m) const
+{
+    pts = {sourceStart, sourceEnd};
+    m = matrix;
+}
+
+void LineShape::setSource(std::vector<QPointF> pts, const QTransform& m)
+{
+    sourceStart = pts[0];
+    sourceEnd = pts[1];
+    matrix = m;
+    endpointsDirty = true;
+    invalidate();
+}
+
+bool LineShape::clipToRect(const QRect& window, const DrawEngine& engine)
+{
+    resolve();
+    int x0 = start.x(), y0 = start.y();
+    int x1 = end.x(),   y1 = end.y();
+    if (!engine.cohenSutherlandClip(x0, y0, x1, y1,
+                                    window.left(), window.top(), window.right(), window.bottom()))
+        return false;
+
+    if (QPoint(x0, y0) != start || QPoint(x1, y1) != end)
+    {
+        setEndpoints(QPoint(x0, y0), QPoint(x1, y1));                   // 裁剪后的端点即新的源几何
+        invalidate();
+    }
+    return true;
+}
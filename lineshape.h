@@ -2,17 +2,20 @@
 #define LINESHAPE_H
 
 #include "shape.h"
+#include <vector>
 
 /**
  * @brief LineShape —— 直线图元类
  *
  * 使用 Bresenham 算法绘制直线，完全在像素级实现
+ * antialiased 为 true 时细线改用 Wu 算法（整数定点，按覆盖率混合相邻两个像素）
  */
 class LineShape : public Shape
 {
 public:
-    QPoint start;                                               // 起点
-    QPoint end;                                                 // 终点
+    LineShape() : Shape(ShapeKind::Line) {}
+
+    bool antialiased = false;                                   // 线宽 1 时使用 Wu 抗锯齿细线
 
     /**
      * @brief 使用 Bresenham 算法绘制直线
@@ -29,6 +32,38 @@ public:
 
 
     QPointF centroid() const override;
+
+    QRect boundingRect() const override;
+
+    // 起点 / 终点：源端点经 matrix 解析后的像素坐标，矩阵变过之后在第一次读取时才重新解析
+    QPoint startPoint() const { resolve(); return start; }
+    QPoint endPoint() const { resolve(); return end; }
+    // 直接指定端点：端点即新的源几何，matrix 复位为单位阵（不触发 invalidate，由调用方决定何时重绘）
+    void setEndpoints(const QPoint& a, const QPoint& b);
+
+    // 变换只累积到 matrix 并标记端点待解析
+    void transform(const QTransform& m) override;
+    // 源端点与累积矩阵（撤销历史用）
+    void getSource(std::vector<QPointF>& pts, QTransform& m) const;
+    void setSource(std::vector<QPointF> pts, const QTransform& m);
+    // Cohen-Sutherland 裁剪
+    bool clipToRect(const QRect& window, const DrawEngine& engine) override;
+    int controlPointCount() const override { return 2; }
+    QPointF controlPoint(int i) const override { return QPointF(i == 0 ? startPoint() : endPoint()); }
+
+protected:
+    // 克隆前先解析，快照里的副本不会再在工作线程上改写缓存
+    std::shared_ptr<Shape> cloneShape() const override { resolve(); return std::make_shared<LineShape>(*this); }
+
+private:
+    // Wu 抗锯齿细线（线宽 1，非水平 / 竖直 / 45° 的直线）
+    void drawWu(DrawEngine* engine, QRgb rgb) const;
+    // 端点待解析时按 matrix 重新映射源端点
+    void resolve() const;
+
+    QPointF sourceStart, sourceEnd;                             // 源几何（浮点，不取整）
+    mutable QPoint start, end;                                  // 解析结果（像素坐标）
+    mutable bool endpointsDirty = false;                        // matrix 变过、start / end 尚未重新解析
 };
 
 #endif // LINESHAPE_H
@@ -29,16 +29,17 @@ void LineTool::onMousePress(QMouseEvent* e, DrawEngine* engine)
 
     // 创建一个新的 LineShape 对象
     currentLine = std::make_shared<LineShape>();
-    currentLine->start = e->pos();
-    currentLine->end = e->pos();                                        // 初始时起点和终点相同
+    currentLine->setEndpoints(e->pos(), e->pos());                      // 初始时起点和终点相同
 
     // 绑定当前画笔属性（从引擎读取）
     currentLine->penWidth = engine->getPenWidth();
     currentLine->lineStyle = engine->getLineStyle();
     currentLine->lineCap = engine->getLineCap();
+    currentLine->lineJoin = engine->getLineJoin();
+    currentLine->antialiased = engine->getLineAntialiased();
 
     // 设置虚线偏移，偏移取决于起点坐标，使得不同位置的线拥有不同的 dash 节奏
-    currentLine->dashOffset = (currentLine->start.x() + currentLine->start.y()) % 13;
+    currentLine->dashOffset = (e->pos().x() + e->pos().y()) % 13;
 
     engine->addShape(currentLine);                                      // 将图元加入引擎，使其参与后续的重绘
 }
@@ -46,7 +47,7 @@ void LineTool::onMousePress(QMouseEvent* e, DrawEngine* engine)
 /**
  * @brief 鼠标左键移动：实时更新线段终点
  *
- * 当鼠标按下拖动时，不断更新 currentLine->end
+ * 当鼠标按下拖动时，不断更新 currentLine 的终点
  * 并调用 DrawEngine 重绘当前线段，实现动态预览
  */
 void LineTool::onMouseMove(QMouseEvent* e, DrawEngine* engine)
@@ -56,7 +57,7 @@ void LineTool::onMouseMove(QMouseEvent* e, DrawEngine* engine)
     if (!(e->buttons() & Qt::LeftButton)) return;                       // 仅响应左键
 
     // 更新终点
-    currentLine->end = e->pos();
+    currentLine->setEndpoints(currentLine->startPoint(), e->pos());
 
     // 立即重新绘制当前线段
     engine->redrawShape(currentLine);
@@ -70,12 +71,11 @@ void LineTool::onMouseMove(QMouseEvent* e, DrawEngine* engine)
  */
 void LineTool::onMouseRelease(QMouseEvent* e, DrawEngine* engine)
 {
-    Q_UNUSED(e);
-    Q_UNUSED(engine);
-
     if (e->button() != Qt::LeftButton) return;                          // 仅响应左键
 
     // 用户确认终点，结束绘制，此处仅释放 LineTool 的持有引用，DrawEngine 仍保存该图形用于重绘
+    if (engine && currentLine)
+        engine->getHistory().push(std::make_unique<AddShapeCommand>(currentLine));
     currentLine.reset();
 }
 
@@ -3,14 +3,22 @@
 #include "canvaswidget.h"
 #include "linetool.h"
 #include "arctool.h"
+#include "ellipsetool.h"
 #include "polygontool.h"
 #include "cliptool.h"
 #include "selecttool.h"
 #include "filltool.h"
 #include "tangramgame.h"
 #include "tangramtool.h"
+#include "sceneio.h"
+#include "scenefile.h"
+#include "scenesvg.h"
 #include <QToolBar>
 #include <QAction>
+#include <QKeySequence>
+#include <QFileDialog>
+#include <QMessageBox>
+#include <QProgressDialog>
 #include <QDockWidget>
 #include <QLineEdit>
 #include <QFormLayout>
@@ -26,6 +34,7 @@ MainWindow::MainWindow(QWidget *parent)
     currentTool(nullptr),
     lineTool(nullptr),
     arcTool(nullptr),
+    ellipseTool(nullptr),
     selectTool(nullptr),
     tangramGame(nullptr),
     tangramTool(nullptr),
@@ -45,6 +54,7 @@ MainWindow::~MainWindow()
     delete lineTool;
     delete arcTool;
     delete polygonTool;
+    delete ellipseTool;
     delete clipTool;
     delete selectTool;
     delete tangramTool;
@@ -62,6 +72,7 @@ void MainWindow::initTools()
     lineTool = new LineTool();
     arcTool = new ArcTool();
     polygonTool = new PolygonTool();
+    ellipseTool = new EllipseTool();
     clipTool = new ClipTool();
     selectTool = new SelectTool();
     fillTool = new FillTool();
@@ -110,6 +121,23 @@ void MainWindow::initUI()
         if (tangramToolAction) tangramToolAction->setChecked(false);
     });
 
+    QAction* ellipseAction = toolbar->addAction("Ellipse");
+    connect(ellipseAction, &QAction::triggered, this, [=](){
+        currentTool = ellipseTool;
+        canvas->setTool(currentTool);
+        if (tangramToolAction) tangramToolAction->setChecked(false);
+    });
+
+    // 椭圆工具画出的形状：整椭圆 / 扇形 / 弓形（顺序与 EllipseShape::Form 一致）
+    QComboBox* ellipseFormCombo = new QComboBox(this);
+    ellipseFormCombo->addItem("Ellipse");
+    ellipseFormCombo->addItem("Pie");
+    ellipseFormCombo->addItem("Chord");
+    toolbar->addWidget(ellipseFormCombo);
+    connect(ellipseFormCombo, &QComboBox::currentIndexChanged, this, [=](int index){
+        if (ellipseTool) ellipseTool->setForm(static_cast<EllipseShape::Form>(index));
+    });
+
     QAction* clipAction = toolbar->addAction("Clip");
     connect(clipAction, &QAction::triggered, this, [=](){
         currentTool = clipTool;
@@ -214,13 +242,39 @@ void MainWindow::initUI()
             tangramToolAction->setChecked(true);
     }
 
-    // ---------- 多边形绘制时是否填充 checkbox ----------
-    fillPolygonsCheckbox = new QCheckBox("Fill polygons", this);
+    // ---------- 多边形 / 椭圆绘制时是否填充 checkbox ----------
+    fillPolygonsCheckbox = new QCheckBox("Fill shapes", this);
     fillPolygonsCheckbox->setChecked(false);
     toolbar->addWidget(fillPolygonsCheckbox);
-    // 连接 Checkbox 到 polygonTool
+    // 连接 Checkbox 到 polygonTool 与 ellipseTool
     connect(fillPolygonsCheckbox, &QCheckBox::toggled, this, [=](bool checked){
         if (polygonTool) polygonTool->setFillOnComplete(checked);
+        if (ellipseTool) ellipseTool->setFillOnComplete(checked);
+    });
+
+    // ---------- 分块多线程重绘开关 ----------
+    QCheckBox* tiledRenderCheckbox = new QCheckBox("Tiled render", this);
+    tiledRenderCheckbox->setChecked(false);
+    toolbar->addWidget(tiledRenderCheckbox);
+    connect(tiledRenderCheckbox, &QCheckBox::toggled, this, [=](bool checked){
+        if (drawEngine) drawEngine->setTiledRendering(checked);
+    });
+
+    // ---------- 抗锯齿开关 ----------
+    QCheckBox* antialiasCheckbox = new QCheckBox("Antialias", this);
+    antialiasCheckbox->setChecked(false);
+    toolbar->addWidget(antialiasCheckbox);
+    connect(antialiasCheckbox, &QCheckBox::toggled, this, [=](bool checked){
+        if (drawEngine) drawEngine->setAntialiasing(checked);
+        if (canvas) canvas->update();
+    });
+
+    // ---------- 新建直线使用 Wu 抗锯齿细线 ----------
+    QCheckBox* wuLinesCheckbox = new QCheckBox("Smooth lines", this);
+    wuLinesCheckbox->setChecked(false);
+    toolbar->addWidget(wuLinesCheckbox);
+    connect(wuLinesCheckbox, &QCheckBox::toggled, this, [=](bool checked){
+        if (drawEngine) drawEngine->setLineAntialiased(checked);
     });
 
     // 清除画布按钮
@@ -245,6 +299,117 @@ void MainWindow::initUI()
         if (canvas) canvas->update();
     });
 
+    // 撤销 / 重做（Ctrl+Z / Ctrl+Y 或平台对应的快捷键）
+    QAction* undoAction = toolbar->addAction("Undo");
+    undoAction->setShortcut(QKeySequence::Undo);
+    connect(undoAction, &QAction::triggered, this, [=](){
+        if (drawEngine && drawEngine->undo() && canvas) canvas->update();
+    });
+    QAction* redoAction = toolbar->addAction("Redo");
+    redoAction->setShortcut(QKeySequence::Redo);
+    connect(redoAction, &QAction::triggered, this, [=](){
+        if (drawEngine && drawEngine->redo() && canvas) canvas->update();
+    });
+
+    // 场景文件：.gscene 为二进制格式（内存映射读取），.jsonl 为逐行 JSON，.svg 与其它工具交换
+    // 后两种边读边建图元，读写时显示可取消的进度框
+    const QString sceneFilter = "Scene (*.gscene);;JSON Lines scene (*.jsonl);;SVG (*.svg)";
+    auto progressFor = [](QProgressDialog& dialog) {
+        dialog.setWindowModality(Qt::WindowModal);
+        dialog.setMinimumDuration(500);
+        return [&dialog](qint64 done, qint64 total) {
+            dialog.setValue(total > 0 ? int(done * 1000 / total) : 1000);
+            return !dialog.wasCanceled();
+        };
+    };
+    QAction* openAction = toolbar->addAction("Open");
+    openAction->setShortcut(QKeySequence::Open);
+    connect(openAction, &QAction::triggered, this, [=](){
+        if (!drawEngine) return;
+        const QString path = QFileDialog::getOpenFileName(this, "Open scene", QString(), sceneFilter);
+        if (path.isEmpty()) return;
+
+        SceneIO::SceneHeader header;
+        QString error;
+        SceneFile file;
+        const bool binary = path.endsWith(".gscene", Qt::CaseInsensitive);
+        if (binary && !file.open(path, &error))
+        {
+            QMessageBox::warning(this, "Open scene", error);
+            return;
+        }
+
+        drawEngine->clearAllShapes();
+        bool ok = true;
+        if (binary)
+        {
+            header.size = file.canvasSize();
+            header.background = QColor::fromRgb(file.background());
+            ok = file.loadInto(*drawEngine, &error);
+        }
+        else
+        {
+            QProgressDialog dialog("Loading scene...", "Cancel", 0, 1000, this);
+            const SceneIO::Progress progress = progressFor(dialog);
+            ok = path.endsWith(".svg", Qt::CaseInsensitive)
+                 ? SceneSvg::load(path, *drawEngine, &header, &error, progress)
+                 : SceneIO::loadJsonLines(path, *drawEngine, &header, &error, progress);
+        }
+
+        // 文件中的七巧板拼块换成游戏自己的拼块（保持姿态、样式与层次），文件里没有的拼块放回最上层
+        if (tangramGame)
+        {
+            const std::vector<std::shared_ptr<Shape>> loaded = drawEngine->getShapes();
+            for (const auto& s : loaded)
+            {
+                if (s->kind() != ShapeKind::TangramPiece) continue;
+                auto loadedPiece = std::static_pointer_cast<TangramPiece>(s);
+                for (const auto& piece : tangramGame->pieces())
+                {
+                    if (piece->owner || piece->pieceType() != loadedPiece->pieceType()) continue;
+                    piece->setPose(loadedPiece->pose());
+                    piece->color = loadedPiece->color;
+                    piece->fillColor = loadedPiece->fillColor;
+                    piece->filled = loadedPiece->filled;
+                    piece->penWidth = loadedPiece->penWidth;
+                    const qint64 z = loadedPiece->zOrder;
+                    drawEngine->removeShape(loadedPiece);
+                    drawEngine->addShapeAt(piece, z);
+                    break;
+                }
+            }
+            for (const auto& piece : tangramGame->pieces())
+                if (!piece->owner) drawEngine->addShape(piece);
+        }
+
+        if (!ok)
+            QMessageBox::warning(this, "Open scene", error);
+        if (canvas) canvas->update();
+    });
+    QAction* saveAction = toolbar->addAction("Save");
+    saveAction->setShortcut(QKeySequence::Save);
+    connect(saveAction, &QAction::triggered, this, [=](){
+        if (!drawEngine) return;
+        QString path = QFileDialog::getSaveFileName(this, "Save scene", QString(), sceneFilter);
+        if (path.isEmpty()) return;
+        if (!path.contains('.'))
+            path += ".gscene";
+
+        QString error;
+        const SceneSnapshot scene = drawEngine->snapshot();
+        QProgressDialog dialog("Saving scene...", "Cancel", 0, 1000, this);
+        const SceneIO::Progress progress = progressFor(dialog);
+        bool ok;
+        if (path.endsWith(".jsonl", Qt::CaseInsensitive))
+            ok = SceneIO::saveJsonLines(path, scene, &error, progress);
+        else if (path.endsWith(".svg", Qt::CaseInsensitive))
+            ok = SceneSvg::save(path, scene, &error, progress);
+        else
+            ok = SceneFile::save(path, scene, &error);
+        if (!ok)
+            QMessageBox::warning(this, "Save scene", error);
+    });
+
     // ------------------- 线型 ComboBox -------------------
     QComboBox* lineTypeBox = new QComboBox(this);
     lineTypeBox->addItem("Solid");
@@ -254,6 +419,7 @@ void MainWindow::initUI()
     toolbar->addWidget(lineTypeBox);
     connect(lineTypeBox, &QComboBox::currentTextChanged, this, [=](const QString &text){
         if(drawEngine) drawEngine->setLineStyle(text);
+        applyPenToSelection();
     });
 
     // ------------------- 线帽 ComboBox -------------------
@@ -264,6 +430,18 @@ void MainWindow::initUI()
     toolbar->addWidget(lineCapBox);
     connect(lineCapBox, &QComboBox::currentTextChanged, this, [=](const QString &text){
         if(drawEngine) drawEngine->setLineCap(text);
+        applyPenToSelection();
+    });
+
+    // ------------------- 连接 ComboBox -------------------
+    QComboBox* lineJoinBox = new QComboBox(this);
+    lineJoinBox->addItem("Round");
+    lineJoinBox->addItem("Miter");
+    lineJoinBox->addItem("Bevel");
+    toolbar->addWidget(lineJoinBox);
+    connect(lineJoinBox, &QComboBox::currentTextChanged, this, [=](const QString &text){
+        if(drawEngine) drawEngine->setLineJoin(text);
+        applyPenToSelection();
     });
 
     // ------------------- 左侧滑块：线宽 -------------------
@@ -279,6 +457,11 @@ void MainWindow::initUI()
     connect(penWidthSlider, &QSlider::valueChanged, this, [=](int value){
         if(drawEngine)
             drawEngine->setPenWidth(value);                                     // 滑块改变线宽
+        if (!penWidthSlider->isSliderDown())
+            applyPenToSelection();                                              // 拖动滑块时只在松开后记一步
+    });
+    connect(penWidthSlider, &QSlider::sliderReleased, this, [=](){
+        applyPenToSelection();
     });
 
     // 变换面板
@@ -328,6 +511,16 @@ void MainWindow::initUI()
     });
 }
 
+/**
+ * @brief 选择工具激活时，把当前画笔设置应用到选中的图元（可撤销）
+ */
+void MainWindow::applyPenToSelection()
+{
+    if (!drawEngine || !selectTool || currentTool != selectTool) return;
+    selectTool->applyPenToSelection(drawEngine);
+    if (canvas) canvas->update();
+}
+
 /**
  * @brief 切换到画线工具
  */
@@ -25,6 +25,7 @@ class DrawEngine;
 class QAction;
 class TangramGame;
 class TangramTool;
+class EllipseTool;
 
 /**
  * @brief MainWindow —— 应用程序主窗口
@@ -50,6 +51,7 @@ private slots:
 private:
     void initTools();                                                           // 初始化工具实例
     void initUI();                                                              // 初始化UI界面（工具栏、画布等）
+    void applyPenToSelection();                                                 // 选择工具下：画笔设置同时改写选中图元
 
 private:
     CanvasWidget* canvas;                                                       // 画布部件（显示绘图）
@@ -58,6 +60,7 @@ private:
     BaseTool* lineTool;                                                         // 画线工具
     BaseTool* arcTool;                                                          // 圆弧工具
     PolygonTool* polygonTool;
+    EllipseTool* ellipseTool;                                                   // 椭圆 / 扇形 / 弓形工具
     BaseTool* clipTool;
     SelectTool* selectTool;                                                     // 选择工具
     FillTool* fillTool;
@@ -0,0 +1,140 @@
+#include "pointtransform.h"
+
+#if defined(__AVX__)
+#include <immintrin.h>
+#define POINTTRANSFORM_AVX 1
+#endif
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define POINTTRANSFORM_SSE2 1
+#endif
+
+static_assert(sizeof(QPoint) == 2 * sizeof(int), "QPoint must be two packed ints");
+static_assert(sizeof(QPointF) == 2 * sizeof(double), "QPointF must be two packed doubles");
+
+namespace {
+
+struct Affine
+{
+    double m11, m12, m21, m22, dx, dy;
+};
+
+inline int roundHalfAway(double v)
+{
+    return int(v >= 0.0 ? v + 0.5 : v - 0.5);
+}
+
+inline void mapScalar(const Affine& a, int& x, int& y)
+{
+    const double fx = x, fy = y;
+    x = roundHalfAway(a.m11 * fx + a.m21 * fy + a.dx);
+    y = roundHalfAway(a.m12 * fx + a.m22 * fy + a.dy);
+}
+
+#ifdef POINTTRANSFORM_SSE2
+// v + copysign(0.5, v) 后截断，即 roundHalfAway
+inline __m128i roundHalfAway(__m128d v)
+{
+    const __m128d sign = _mm_and_pd(v, _mm_set1_pd(-0.0));
+    return _mm_cvttpd_epi32(_mm_add_pd(v, _mm_or_pd(_mm_set1_pd(0.5), sign)));
+}
+#endif
+
+#ifdef POINTTRANSFORM_AVX
+inline __m128i roundHalfAway(__m256d v)
+{
+    const __m256d sign = _mm256_and_pd(v, _mm256_set1_pd(-0.0));
+    return _mm256_cvttpd_epi32(_mm256_add_pd(v, _mm256_or_pd(_mm256_set1_pd(0.5), sign)));
+}
+#endif
+
+} // namespace
+
+void PointTransform::mapInPlace(const QTransform& m, QPoint* pts, std::size_t n)
+{
+    const Affine a{m.m11(), m.m12(), m.m21(), m.m22(), m.dx(), m.dy()};
+    int* xy = reinterpret_cast<int*>(pts);
+    std::size_t i = 0;
+
+    // 交错布局：一个点 (x, y) 的结果为 x·(m11, m12) + y·(m21, m22) + (dx, dy)
+#if defined(POINTTRANSFORM_AVX)
+    const __m256d cx = _mm256_setr_pd(a.m11, a.m12, a.m11, a.m12);
+    const __m256d cy = _mm256_setr_pd(a.m21, a.m22, a.m21, a.m22);
+    const __m256d d = _mm256_setr_pd(a.dx, a.dy, a.dx, a.dy);
+    for (; i + 2 <= n; i += 2)
+    {
+        const __m256d p = _mm256_cvtepi32_pd(_mm_loadu_si128(reinterpret_cast<const __m128i*>(xy + 2 * i)));
+        const __m256d x = _mm256_permute_pd(p, 0x0);                   // x0 x0 x1 x1
+        const __m256d y = _mm256_permute_pd(p, 0xF);                   // y0 y0 y1 y1
+        const __m256d r = _mm256_add_pd(_mm256_add_pd(_mm256_mul_pd(cx, x), _mm256_mul_pd(cy, y)), d);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(xy + 2 * i), roundHalfAway(r));
+    }
+#elif defined(POINTTRANSFORM_SSE2)
+    const __m128d cx = _mm_setr_pd(a.m11, a.m12);
+    const __m128d cy = _mm_setr_pd(a.m21, a.m22);
+    const __m128d d = _mm_setr_pd(a.dx, a.dy);
+    for (; i < n; ++i)
+    {
+        const __m128d p = _mm_cvtepi32_pd(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(xy + 2 * i)));
+        const __m128d x = _mm_unpacklo_pd(p, p);
+        const __m128d y = _mm_unpackhi_pd(p, p);
+        const __m128d r = _mm_add_pd(_mm_add_pd(_mm_mul_pd(cx, x), _mm_mul_pd(cy, y)), d);
+        _mm_storel_epi64(reinterpret_cast<__m128i*>(xy + 2 * i), roundHalfAway(r));
+    }
+#endif
+
+    for (; i < n; ++i)
+        mapScalar(a, xy[2 * i], xy[2 * i + 1]);
+}
+
+void PointTransform::map(const QTransform& m, const QPointF* src, QPoint* dst, std::size_t n)
+{
+    const Affine a{m.m11(), m.m12(), m.m21(), m.m22(), m.dx(), m.dy()};
+    const double* in = reinterpret_cast<const double*>(src);
+    int* out = reinterpret_cast<int*>(dst);
+    std::size_t i = 0;
+
+#if defined(POINTTRANSFORM_AVX)
+    const __m256d cx = _mm256_setr_pd(a.m11, a.m12, a.m11, a.m12);
+    const __m256d cy = _mm256_setr_pd(a.m21, a.m22, a.m21, a.m22);
+    const __m256d d = _mm256_setr_pd(a.dx, a.dy, a.dx, a.dy);
+    for (; i + 2 <= n; i += 2)
+    {
+        const __m256d p = _mm256_loadu_pd(in + 2 * i);
+        const __m256d x = _mm256_permute_pd(p, 0x0);
+        const __m256d y = _mm256_permute_pd(p, 0xF);
+        const __m256d r = _mm256_add_pd(_mm256_add_pd(_mm256_mul_pd(cx, x), _mm256_mul_pd(cy, y)), d);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + 2 * i), roundHalfAway(r));
+    }
+#elif defined(POINTTRANSFORM_SSE2)
+    const __m128d cx = _mm_setr_pd(a.m11, a.m12);
+    const __m128d cy = _mm_setr_pd(a.m21, a.m22);
+    const __m128d d = _mm_setr_pd(a.dx, a.dy);
+    for (; i < n; ++i)
+    {
+        const __m128d p = _mm_loadu_pd(in + 2 * i);
+        const __m128d x = _mm_unpacklo_pd(p, p);
+        const __m128d y = _mm_unpackhi_pd(p, p);
+        const __m128d r = _mm_add_pd(_mm_add_pd(_mm_mul_pd(cx, x), _mm_mul_pd(cy, y)), d);
+        _mm_storel_epi64(reinterpret_cast<__m128i*>(out + 2 * i), roundHalfAway(r));
+    }
+#endif
+
+    for (; i < n; ++i)
+    {
+        const double x = in[2 * i], y = in[2 * i + 1];
+        out[2 * i] = roundHalfAway(a.m11 * x + a.m21 * y + a.dx);
+        out[2 * i + 1] = roundHalfAway(a.m12 * x + a.m22 * y + a.dy);
+    }
+}
+
+const char* PointTransform::implementation()
+{
+#if defined(POINTTRANSFORM_AVX)
+    return "avx";
+#elif defined(POINTTRANSFORM_SSE2)
+    return "sse2";
+#else
+    return "scalar";
+#endif
+}
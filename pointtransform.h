@@ -0,0 +1,28 @@
+#ifndef POINTTRANSFORM_H
+#define POINTTRANSFORM_H
+
+#include <QPoint>
+#include <QPointF>
+#include <QTransform>
+#include <cstddef>
+
+/**
+ * @brief PointTransform —— 整数坐标数组的批量仿射变换
+ *
+ * 矩阵系数只取一次，按 AVX（每次 4 个点）/ SSE2（每次 2 个点）/ 标量的顺序选用编译目标支持的最宽实现，
+ * 结果四舍五入（0.5 远离零方向）到整数，与 Qt 6 的 QTransform::map(QPointF).toPoint() 一致。
+ * 只使用矩阵的仿射部分（透视分量被忽略）
+ */
+namespace PointTransform
+{
+    // QPoint 数组（x、y 交错存放）
+    void mapInPlace(const QTransform& m, QPoint* pts, std::size_t n);
+
+    // 浮点源几何 -> 整数坐标（图元由源几何与累积矩阵解析出绘制用顶点）
+    void map(const QTransform& m, const QPointF* src, QPoint* dst, std::size_t n);
+
+    // 当前构建使用的实现："avx" / "sse2" / "scalar"
+    const char* implementation();
+}
+
+#endif // POINTTRANSFORM_H
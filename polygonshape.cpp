@@ -1,5 +1,8 @@
 #include "polygonshape.h"
 #include "drawengine.h"
+#include "stroker.h"
+#include "scanlinefiller.h"
+#include "pointtransform.h"
 
 #include <algorithm>
 #include <limits>
@@ -8,7 +11,7 @@
  * @brief 构造函数（方便外部直接传点）
  */
 PolygonShape::PolygonShape(const std::vector<QPoint> &pts)
-    : vertices(pts)
+    : Shape(ShapeKind::Polygon), resolved(pts)
 {
 }
 
@@ -19,14 +22,15 @@ PolygonShape::PolygonShape(const std::vector<QPoint> &pts)
  */
 bool PolygonShape::contains(const QPoint& pt) const
 {
+    resolve();
     bool inside = false;
-    int n = (int)vertices.size();
+    int n = (int)resolved.size();
     if (n < 3) return false;
 
     for (int i = 0, j = n - 1; i < n; j = i++)
     {
-        const QPoint &pi = vertices[i];
-        const QPoint &pj = vertices[j];
+        const QPoint &pi = resolved[i];
+        const QPoint &pj = resolved[j];
         bool intersect = ((pi.y() > pt.y()) != (pj.y() > pt.y())) &&
                          (pt.x() < (pj.x() - pi.x()) * (pt.y() - pi.y()) / double(pj.y() - pi.y() + 0.0) + pi.x());
         if (intersect) inside = !inside;
@@ -36,106 +40,50 @@ bool PolygonShape::contains(const QPoint& pt) const
 
 /**
  * @brief draw - 多边形绘制入口
- * 设计：若 filled==true，先执行扫描线填充；随后用现有 LineShape 的绘制机制描边（保持样式）。
+ *
+ * 设计：若 filled==true，先执行扫描线填充；随后描边（保持样式）。
  *
  * 注意：
- *  - 填充使用 DrawEngine::setPixel 逐像素填充（填充不受线型/线帽控制）
- *  - 描边通过调用 DrawEngine 的线段绘制（例如你当前 LineShape 所使用的 drawLine 方法）
+ *  - 填充使用引擎复用的 ScanlineFiller（奇偶规则）按行区间填充（填充不受线型/线帽控制），
+ *    细线多边形反复绘制时不分配内存
+ *  - 线宽为 1 时用 Bresenham 逐边绘制细线；
+ *    线宽大于 1 时由 Stroker 把闭合折线转换为线段矩形 + 连接（lineJoin）的轮廓，非零规则填充
+ *  - 抗锯齿模式下填充与描边（细线也按 1 像素宽的轮廓）都由填充器按覆盖率输出
  */
 void PolygonShape::draw(DrawEngine* engine)
 {
     if (!engine) return;
+    resolve();
 
-    int n = (int)vertices.size();
+    int n = (int)resolved.size();
     if (n == 0) return;
 
+    const QRgb strokeRgb = color.rgb();
+    const QRgb fillRgb = fillColor.rgb();
+
+    ScanlineFiller& filler = engine->scanlineFiller();
+
     // 1) 若填充：扫描线填充（整数扫描线）
     if (filled && n >= 3)
     {
-        // 找到 minY, maxY
-        int minY = std::numeric_limits<int>::max();
-        int maxY = std::numeric_limits<int>::min();
-        for (const auto& p : vertices) {
-            minY = std::min(minY, p.y());
-            maxY = std::max(maxY, p.y());
-        }
-
-        struct Edge {
-            int ymax;
-            double x;
-            double invSlope;
-        };
-
-        int height = maxY - minY + 1;
-        std::vector<std::vector<Edge>> buckets(std::max(1, height));
-
-        for (int i = 0; i < n; ++i)
-        {
-            const QPoint &p1 = vertices[i];
-            const QPoint &p2 = vertices[(i + 1) % n];
-
-            if (p1.y() == p2.y()) continue;
-
-            int ymin = std::min(p1.y(), p2.y());
-            int ymax = std::max(p1.y(), p2.y());
-            double x_at_ymin = (p1.y() < p2.y()) ? p1.x() : p2.x();
-            double dx = double(p2.x() - p1.x());
-            double dy = double(p2.y() - p1.y());
-            double invslope = dx / dy;
-
-            int bucketIndex = ymin - minY;
-            if (bucketIndex >= 0 && bucketIndex < (int)buckets.size())
-            {
-                buckets[bucketIndex].push_back({ymax, x_at_ymin, invslope});
-            }
-        }
-
-        // AET
-        std::vector<Edge> AET;
-        AET.reserve(16);
+        filler.addContour(resolved);
+        filler.fill(engine, fillRgb, FillRule::EvenOdd);
+    }
 
-        for (int scanY = minY; scanY <= maxY; ++scanY)
-        {
-            int bucketIndex = scanY - minY;
-            if (bucketIndex >= 0 && bucketIndex < (int)buckets.size())
-            {
-                for (const Edge &e : buckets[bucketIndex])
-                    AET.push_back(e);
-            }
-
-            AET.erase(std::remove_if(AET.begin(), AET.end(),
-                                     [scanY](const Edge &e){ return e.ymax <= scanY; }),
-                      AET.end());
-
-            if (AET.empty()) {
-                for (auto &e : AET) e.x += e.invSlope;
-                continue;
-            }
-
-            std::sort(AET.begin(), AET.end(), [](const Edge &a, const Edge &b){
-                return a.x < b.x;
-            });
-
-            for (size_t i = 0; i + 1 < AET.size(); i += 2)
-            {
-                int xStart = int(std::ceil(AET[i].x));
-                int xEnd   = int(std::floor(AET[i+1].x));
-                if (xStart > xEnd) continue;
-
-                for (int x = xStart; x <= xEnd; ++x)
-                    engine->setPixel(x, scanY, fillColor);
-            }
-
-            for (auto &e : AET) e.x += e.invSlope;
-        }
+    // 2) 描边
+    if (penWidth > 1 || engine->isAntialiasing())
+    {
+        std::vector<QPointF> path(resolved.begin(), resolved.end());
+        Stroker(penWidth, lineCap, lineJoin).stroke(path, true, lineStyle, dashOffset, filler);
+        filler.fill(engine, strokeRgb, FillRule::NonZero);
+        return;
     }
 
-    // 2) 描边：把每条边交给 DrawEngine 或 LineShape 的 draw 实现
-    //    这里直接用简单 Bresenham 从 vertex i 到 i+1，并用图元的样式（lineStyle / penWidth / color）
+    //    细线：直接用简单 Bresenham 从 vertex i 到 i+1，并用图元的样式（lineStyle / color）
     for (int i = 0; i < n; ++i)
     {
-        QPoint p1 = vertices[i];
-        QPoint p2 = vertices[(i + 1) % n];
+        QPoint p1 = resolved[i];
+        QPoint p2 = resolved[(i + 1) % n];
 
         int x0 = p1.x(), y0 = p1.y();
         int x1 = p2.x(), y1 = p2.y();
@@ -145,7 +93,8 @@ void PolygonShape::draw(DrawEngine* engine)
         int step = 0;
         while (true)
         {
-            engine->drawStyledPixelAtStep(x0, y0, color, step, lineStyle, penWidth, dashOffset);
+            if (engine->shouldDrawAtStep(step, lineStyle, 1, dashOffset))
+                engine->setPixelRgb(x0, y0, strokeRgb);
             ++step;
             if (x0 == x1 && y0 == y1) break;
             e2 = 2 * err;
@@ -161,17 +110,18 @@ void PolygonShape::draw(DrawEngine* engine)
 // 多边形重心（基于顶点多边形重心公式；若退化则取平均）
 QPointF PolygonShape::centroid() const
 {
-    int n = vertices.size();
+    resolve();
+    int n = resolved.size();
     if (n == 0) return QPointF(0,0);
     // 使用多边形重心公式
     double A = 0.0;
     double cx = 0.0, cy = 0.0;
     for (int i = 0, j = n - 1; i < n; j = i++)
     {
-        double xi = vertices[i].x();
-        double yi = vertices[i].y();
-        double xj = vertices[j].x();
-        double yj = vertices[j].y();
+        double xi = resolved[i].x();
+        double yi = resolved[i].y();
+        double xj = resolved[j].x();
+        double yj = resolved[j].y();
         double cross = xj * yi - xi * yj;
         A += cross;
         cx += (xj + xi) * cross;
@@ -181,7 +131,7 @@ QPointF PolygonShape::centroid() const
     if (fabs(A) < 1e-6) {
         // 退化：返回顶点平均
         double sx = 0, sy = 0;
-        for (const auto &p : vertices) { sx += p.x(); sy += p.y(); }
+        for (const auto &p : resolved) { sx += p.x(); sy += p.y(); }
         return QPointF(sx / n, sy / n);
     }
     cx /= (6.0 * A);
@@ -189,3 +139,86 @@ QPointF PolygonShape::centroid() const
     return QPointF(cx, cy);
 }
 
+// 包围盒：顶点范围（填充区域不会超出），四周按描边加粗半径扩展
+QRect PolygonShape::boundingRect() const
+{
+    resolve();
+    if (resolved.empty()) return QRect();
+    int minX = resolved[0].x(), maxX = minX;
+    int minY = resolved[0].y(), maxY = minY;
+    for (const auto &p : resolved)
+    {
+        minX = std::min(minX, p.x());
+        maxX = std::max(maxX, p.x());
+        minY = std::min(minY, p.y());
+        maxY = std::max(maxY, p.y());
+    }
+    int r = strokeRadius();
+    return QRect(QPoint(minX - r, minY - r), QPoint(maxX + r, maxY + r));
+}
+
+// 全部顶点从源几何经 matrix 一次性批量解析，不会在连续变换里累积取整误差
+// 同一图元只由一个线程录制（TileRenderer 按图元分派），惰性解析不需要加锁
+void PolygonShape::resolve() const
+{
+    if (!verticesDirty) return;
+    resolved.resize(source.size());
+    PointTransform::map(matrix, source.data(), resolved.data(), resolved.size());
+    verticesDirty = false;
+}
+
+void PolygonShape::setVertices(std::vector<QPoint> pts)
+{
+    resolved = std::move(pts);
+    source.clear();
+    source.shrink_to_fit();
+    verticesDirty = false;
+    matrix = QTransform();
+}
+
+// 变换累积到 matrix，顶点留到下一次读取时解析；首次变换时以当前顶点为源几何
+void PolygonShape::transform(const QTransform& m)
+{
+    if (source.empty())
+        source.assign(resolved.begin(), resolved.end());
+    matrix *= m;
+    verticesDirty = true;
+    invalidate();
+}
+
+void PolygonShape::getSource(std::vector<QPointF>& pts, QTransform& m) const
+{
+    if (source.empty())
+    {
+        pts.assign(resolved.begin(), resolved.end());
+        m = QTransform();
+        return;
+    }
+    pts = source;
+    m = matrix;
+}
+
+void PolygonShape::setSource(std::vector<QPointF> pts, const QTransform& m)
+{
+    source = std::move(pts);
+    matrix = m;
+    verticesDirty = true;
+    invalidate();
+}
+
+bool PolygonShape::clipToRect(const QRect& window, const DrawEngine& engine)
+{
+    resolve();
+    std::vector<QPoint> clipped = engine.clipPolygonWithRect(resolved,
+                                                             window.left(), window.top(),
+                                                             window.right(), window.bottom());
+    if (clipped.size() < 3)
+        return false;
+
+    if (clipped != resolved)
+    {
+        setVertices(std::move(clipped));
+        invalidate();
+    }
+    return true;
+}
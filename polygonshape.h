@@ -9,14 +9,15 @@
  * 支持：仅轮廓绘制 或 扫描线填充（填充色独立于边颜色）
  *
  * 使用说明：
- *  - vertices 存储顶点（按用户输入顺序）
+ *  - vertices() 返回顶点（按用户输入顺序），是源几何经 matrix 解析后的整数坐标，
+ *    变换之后在第一次读取时才重新解析；整体替换几何请用 setVertices()，它同时清除累积变换
  *  - filled 控制是否执行扫描线填充
  *  - fillColor 为填充颜色（默认为 color 的淡色，工具可设置）
  */
 class PolygonShape : public Shape
 {
 public:
-    PolygonShape() = default;
+    PolygonShape() : Shape(ShapeKind::Polygon) {}
     explicit PolygonShape(const std::vector<QPoint> &pts);
 
     // 绘制：若 filled 则先填充再描边（以保证边可见）
@@ -27,16 +28,40 @@ public:
 
     QPointF centroid() const override;
 
+    QRect boundingRect() const override;
 
-    // 顶点数据
-    std::vector<QPoint> vertices;
+    // 顶点数据（必要时先解析）
+    const std::vector<QPoint>& vertices() const { resolve(); return resolved; }
+    // 替换全部顶点，作为新的源几何（不调用 invalidate()，由调用者决定何时重绘）
+    void setVertices(std::vector<QPoint> pts);
+
+    // 变换只累积到 matrix 并标记顶点待解析
+    void transform(const QTransform& m) override;
+    // 源几何与累积矩阵（撤销历史用）
+    void getSource(std::vector<QPointF>& pts, QTransform& m) const;
+    void setSource(std::vector<QPointF> pts, const QTransform& m);
+    // Sutherland-Hodgman 裁剪，剩余不足 3 个顶点时视为完全裁掉
+    bool clipToRect(const QRect& window, const DrawEngine& engine) override;
+    int controlPointCount() const override { return int(vertices().size()); }
+    QPointF controlPoint(int i) const override { return QPointF(vertices()[i]); }
 
     // 填充相关
     bool filled = false;
     QColor fillColor = Qt::white; // 默认填充色（可由工具或 UI 设置）
 
+protected:
+    // 派生图元（七巧板拼块）使用自己的类型标签
+    explicit PolygonShape(ShapeKind k) : Shape(k) {}
+    // 顶点待解析时按 matrix 重新映射源几何
+    void resolve() const;
 
+    // 克隆前先解析，快照里的副本不会再在工作线程上改写缓存
+    std::shared_ptr<Shape> cloneShape() const override { resolve(); return std::make_shared<PolygonShape>(*this); }
 
+private:
+    std::vector<QPointF> source;                                // 源几何（首次变换前为空，此时 resolved 即源几何）
+    mutable std::vector<QPoint> resolved;                       // 解析结果（像素坐标）
+    mutable bool verticesDirty = false;                         // matrix 变过、resolved 尚未重新解析
 };
 
 #endif // POLYGONSHAPE_H
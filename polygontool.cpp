@@ -42,6 +42,7 @@ void PolygonTool::onMousePress(QMouseEvent* e, DrawEngine* engine)
             previewShape->penWidth = engine->getPenWidth();
             previewShape->lineStyle = engine->getLineStyle();
             previewShape->lineCap = engine->getLineCap();
+            previewShape->lineJoin = engine->getLineJoin();
             previewShape->dashOffset = (tempVertices.front().x() + tempVertices.front().y()) % 13;
 
             previewShape->filled = fillOnComplete;
@@ -59,7 +60,7 @@ void PolygonTool::onMousePress(QMouseEvent* e, DrawEngine* engine)
         else
         {
             // 正在绘制，只更新 previewShape 的顶点（固定部分）
-            previewShape->vertices = tempVertices;
+            previewShape->setVertices(tempVertices);
             engine->redrawShape(previewShape);
         }
     }
@@ -72,6 +73,8 @@ void PolygonTool::onMousePress(QMouseEvent* e, DrawEngine* engine)
             // 完成：previewShape 已在 engine->shapes 中，保持即可。
             // 可在此处对 previewShape 做最终设置（颜色、filled 等），目前保持默认。
             // 清理临时状态（注意不要 remove previewShape）
+            if (previewShape)
+                engine->getHistory().push(std::make_unique<AddShapeCommand>(previewShape));
             tempVertices.clear();
             previewShape.reset();
             isDrawing = false;
@@ -102,7 +105,7 @@ void PolygonTool::onMouseMove(QMouseEvent* e, DrawEngine* engine)
         tempVertices.pop_back();
         tempVertices.push_back(e->pos());
 
-        previewShape->vertices = tempVertices;
+        previewShape->setVertices(tempVertices);
         engine->redrawShape(previewShape);
     }
 }
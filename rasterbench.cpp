@@ -0,0 +1,688 @@
+#include "drawengine.h"
+#include "lineshape.h"
+#include "arcshape.h"
+#include "ellipseshape.h"
+#include "polygonshape.h"
+#include "rasterfillshape.h"
+#include "stroker.h"
+#include "pointtransform.h"
+
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QJsonObject>
+#include <QJsonDocument>
+#include <QTextStream>
+#include <QtMath>
+#include <chrono>
+#include <cmath>
+#include <functional>
+#include <random>
+
+/**
+ * graphicbench —— 光栅化原语的微基准
+ *
+ * 覆盖直线（长度/斜率/线宽/线型）、细线的走样 / Wu / 覆盖率三种画法、圆弧（半径/角度跨度）、
+ * 椭圆 / 扇形 / 弓形（半径/是否填充/是否旋转，对比折线化后按多边形填充）、多边形（顶点数/面积/是否填充）、
+ * 种子填充（区域大小/复杂度）、Cohen-Sutherland 线段裁剪、Sutherland-Hodgman 多边形裁剪，
+ * 点选/框选查询（图元数量）、混合图元的仿射变换、
+ * 写时复制场景快照与整体深拷贝的对比，以及 setPixel / setPixelRgb / fillSpan 三种像素写入路径；
+ * 抗锯齿模式下的多边形 / 描边 / 圆弧光栅化，以及 1080p 画布上数千图元整帧重绘（冷缓存与回放缓存）
+ *
+ * 每个用例输出一行结果（默认 JSON Lines，--csv 输出 CSV）：
+ *   group, case, iterations, ns_per_op, shapes_per_s, pixels_per_s
+ * pixels 为一次操作实际写入（或填充）的像素数，裁剪类用例没有像素，pixels_per_s 为 0
+ */
+
+namespace {
+
+const int CANVAS_SIZE = 1024;
+
+struct Options
+{
+    double minSeconds = 0.05;                                   // 每轮最短计时
+    int rounds = 3;                                             // 取最快一轮
+    QString filter;
+    bool csv = false;
+};
+
+class Bench
+{
+public:
+    explicit Bench(const Options& o) : opt(o), out(stdout)
+    {
+        if (opt.csv)
+            out << "group,case,iterations,ns_per_op,shapes_per_s,pixels_per_s\n";
+    }
+
+    // 运行一个用例：op 执行一次操作，pixelsPerOp 为每次操作的像素数（无意义时为 0）
+    void run(const QString& group, const QString& name, double pixelsPerOp,
+             const std::function<void()>& op)
+    {
+        const QString id = group + "/" + name;
+        if (!opt.filter.isEmpty() && !id.contains(opt.filter))
+            return;
+
+        using Clock = std::chrono::steady_clock;
+
+        // 预热并估计单次耗时，按 minSeconds 确定每轮迭代次数
+        long long iters = 1;
+        for (;;)
+        {
+            auto t0 = Clock::now();
+            for (long long i = 0; i < iters; ++i) op();
+            double s = std::chrono::duration<double>(Clock::now() - t0).count();
+            if (s >= opt.minSeconds / 4 || iters >= (1LL << 30)) break;
+            iters *= 2;
+        }
+        iters = std::max(1LL, iters * 4);
+
+        double best = 1e300;
+        for (int r = 0; r < opt.rounds; ++r)
+        {
+            auto t0 = Clock::now();
+            for (long long i = 0; i < iters; ++i) op();
+            double s = std::chrono::duration<double>(Clock::now() - t0).count();
+            best = std::min(best, s / double(iters));
+        }
+
+        const double opsPerSec = best > 0 ? 1.0 / best : 0.0;
+        if (opt.csv)
+        {
+            out << group << ",\"" << name << "\"," << iters << ","
+                << QString::number(best * 1e9, 'f', 1) << ","
+                << QString::number(opsPerSec, 'f', 1) << ","
+                << QString::number(opsPerSec * pixelsPerOp, 'f', 0) << "\n";
+        }
+        else
+        {
+            QJsonObject o;
+            o["group"] = group;
+            o["case"] = name;
+            o["iterations"] = qint64(iters);
+            o["ns_per_op"] = best * 1e9;
+            o["shapes_per_s"] = opsPerSec;
+            o["pixels_per_s"] = opsPerSec * pixelsPerOp;
+            out << QJsonDocument(o).toJson(QJsonDocument::Compact) << "\n";
+        }
+        out.flush();
+    }
+
+private:
+    Options opt;
+    QTextStream out;
+};
+
+// 图元一次光栅化写入的像素数（按录制得到的 span 统计，已去除重叠）
+double pixelCount(DrawEngine& engine, Shape& s)
+{
+    double n = 0;
+    auto spans = engine.recordShape(&s);
+    for (const RasterSpan& sp : *spans)
+        n += sp.x1 - sp.x0 + 1;
+    return n;
+}
+
+const char* styleName(LineStyle s)
+{
+    switch (s) {
+    case LineStyle::Solid:   return "Solid";
+    case LineStyle::Dash:    return "Dash";
+    case LineStyle::Dot:     return "Dot";
+    case LineStyle::DashDot: return "DashDot";
+    }
+    return "Solid";
+}
+
+// 以 (cx, cy) 为中心、半径 r 的 n 边形；star 为 true 时内外半径交替（凹多边形）
+std::vector<QPoint> makePolygon(int n, int r, bool star, int cx, int cy)
+{
+    std::vector<QPoint> pts;
+    pts.reserve(n);
+    for (int i = 0; i < n; ++i)
+    {
+        double a = 2.0 * M_PI * i / n;
+        double rr = (star && (i & 1)) ? r * 0.45 : r;
+        pts.emplace_back(cx + int(std::lround(rr * std::cos(a))),
+                         cy + int(std::lround(rr * std::sin(a))));
+    }
+    return pts;
+}
+
+void benchSpanWrites(Bench& bench, DrawEngine& engine)
+{
+    const QColor color(30, 120, 200);
+    const QRgb rgb = color.rgb();
+    for (int w : {8, 64, 512})
+    {
+        const QString c = QString("width=%1").arg(w);
+        bench.run("pixel_write", c + ",api=setPixel", w, [&]() {
+            for (int x = 0; x < w; ++x) engine.setPixel(x, 100, color);
+        });
+        bench.run("pixel_write", c + ",api=setPixelRgb", w, [&]() {
+            for (int x = 0; x < w; ++x) engine.setPixelRgb(x, 100, rgb);
+        });
+        bench.run("pixel_write", c + ",api=fillSpan", w, [&]() {
+            engine.fillSpan(100, 0, w - 1, rgb);
+        });
+    }
+}
+
+void benchLines(Bench& bench, DrawEngine& engine)
+{
+    const int c = CANVAS_SIZE / 2;
+    for (int len : {16, 128, 1000})
+    {
+        for (int slope : {0, 30, 45, 80})
+        {
+            double a = slope * M_PI / 180.0;
+            int dx = int(std::lround(len * std::cos(a) / 2));
+            int dy = int(std::lround(len * std::sin(a) / 2));
+            for (int width : {1, 4, 12})
+            {
+                for (LineStyle style : {LineStyle::Solid, LineStyle::Dash, LineStyle::Dot, LineStyle::DashDot})
+                {
+                    LineShape line;
+                    line.setEndpoints(QPoint(c - dx, c - dy), QPoint(c + dx, c + dy));
+                    line.penWidth = width;
+                    line.lineStyle = style;
+                    line.color = Qt::black;
+                    bench.run("line",
+                              QString("len=%1,slope=%2,width=%3,style=%4")
+                                  .arg(len).arg(slope).arg(width).arg(styleName(style)),
+                              pixelCount(engine, line),
+                              [&]() { line.draw(&engine); });
+                }
+            }
+        }
+    }
+}
+
+void benchHairlines(Bench& bench)
+{
+    // 线宽 1 的三种画法：Bresenham、Wu 细线、抗锯齿模式下的覆盖率描边
+    DrawEngine engine(CANVAS_SIZE, CANVAS_SIZE);
+    DrawEngine coverageEngine(CANVAS_SIZE, CANVAS_SIZE);
+    coverageEngine.setAntialiasing(true);
+    const int c = CANVAS_SIZE / 2;
+    for (int len : {16, 128, 1000})
+    {
+        for (int slope : {10, 30, 80})
+        {
+            double a = slope * M_PI / 180.0;
+            int dx = int(std::lround(len * std::cos(a) / 2));
+            int dy = int(std::lround(len * std::sin(a) / 2));
+            for (LineStyle style : {LineStyle::Solid, LineStyle::Dash})
+            {
+                for (const char* mode : {"aliased", "wu", "coverage"})
+                {
+                    const bool coverage = QString(mode) == "coverage";
+                    DrawEngine& target = coverage ? coverageEngine : engine;
+                    LineShape line;
+                    line.setEndpoints(QPoint(c - dx, c - dy), QPoint(c + dx, c + dy));
+                    line.lineStyle = style;
+                    line.color = Qt::black;
+                    line.antialiased = QString(mode) == "wu";
+                    bench.run("hairline",
+                              QString("len=%1,slope=%2,style=%3,mode=%4")
+                                  .arg(len).arg(slope).arg(styleName(style)).arg(mode),
+                              pixelCount(target, line),
+                              [&]() { line.draw(&target); });
+                }
+            }
+        }
+    }
+}
+
+void benchArcs(Bench& bench, DrawEngine& engine)
+{
+    const QPoint c(CANVAS_SIZE / 2, CANVAS_SIZE / 2);
+    for (int r : {10, 64, 256, 500, 2000})
+    {
+        for (int span : {45, 180, 360})
+        {
+            for (int width : {1, 4})
+            {
+                ArcShape arc(c, r, 10, 10 + span, Qt::black);
+                arc.penWidth = width;
+                bench.run("arc",
+                          QString("radius=%1,span=%2,width=%3").arg(r).arg(span).arg(width),
+                          pixelCount(engine, arc),
+                          [&]() { arc.draw(&engine); });
+            }
+        }
+    }
+}
+
+void benchEllipses(Bench& bench, DrawEngine& engine)
+{
+    const QPoint c(CANVAS_SIZE / 2, CANVAS_SIZE / 2);
+    const char* const FORMS[] = {"ellipse", "pie", "chord"};
+    for (int r : {10, 64, 256, 500})
+    {
+        for (int form = 0; form < 3; ++form)
+        {
+            for (bool filled : {false, true})
+            {
+                for (bool rotated : {false, true})
+                {
+                    EllipseShape ellipse(c, r, r / 2 + 1, Qt::black);
+                    ellipse.form = EllipseShape::Form(form);
+                    ellipse.startAngle = 30;
+                    ellipse.endAngle = 300;
+                    ellipse.filled = filled;
+                    ellipse.fillColor = QColor(200, 220, 255);
+                    if (rotated)
+                        ellipse.transform(QTransform::fromTranslate(-c.x(), -c.y()) * QTransform().rotate(30)
+                                          * QTransform::fromTranslate(c.x(), c.y()));
+                    bench.run("ellipse",
+                              QString("radius=%1,form=%2,filled=%3,rotated=%4")
+                                  .arg(r).arg(FORMS[form]).arg(filled ? 1 : 0).arg(rotated ? 1 : 0),
+                              pixelCount(engine, ellipse),
+                              [&]() { ellipse.draw(&engine); });
+                }
+            }
+        }
+
+        // 对比：同一椭圆折线化（弦高误差 1/4 像素）后按多边形填充，即没有椭圆图元时的做法
+        const std::vector<QPointF> outline = Stroker::arcPolyline(QPointF(c), r, 0, 360);
+        std::vector<QPoint> pts;
+        for (const QPointF& p : outline)
+            pts.emplace_back(qRound(p.x()), c.y() + qRound((p.y() - c.y()) * (r / 2 + 1) / r));
+        PolygonShape poly(pts);
+        poly.filled = true;
+        poly.fillColor = QColor(200, 220, 255);
+        poly.color = Qt::black;
+        bench.run("ellipse",
+                  QString("radius=%1,form=tessellated,filled=1,rotated=0").arg(r),
+                  pixelCount(engine, poly),
+                  [&]() { poly.draw(&engine); });
+
+        // 点选：中心、边界附近与外部各取一点轮流查询
+        EllipseShape ellipse(c, r, r / 2 + 1, Qt::black);
+        ellipse.filled = true;
+        const QPoint probes[3] = {c, c + QPoint(r, 0), c + QPoint(r, r)};
+        int next = 0;
+        volatile int sink = 0;
+        bench.run("ellipse", QString("radius=%1,contains").arg(r), 0, [&]() {
+            sink = sink + (ellipse.contains(probes[next++ % 3]) ? 1 : 0);
+        });
+    }
+}
+
+void benchPolygons(Bench& bench, DrawEngine& engine)
+{
+    const int c = CANVAS_SIZE / 2;
+    for (int n : {3, 16, 128, 1024, 10000})
+    {
+        for (int r : {16, 128, 500})
+        {
+            for (bool star : {false, true})
+            {
+                for (bool filled : {false, true})
+                {
+                    PolygonShape poly(makePolygon(n, r, star, c, c));
+                    poly.filled = filled;
+                    poly.fillColor = QColor(200, 220, 255);
+                    poly.color = Qt::black;
+                    bench.run("polygon",
+                              QString("vertices=%1,radius=%2,shape=%3,filled=%4")
+                                  .arg(n).arg(r).arg(star ? "star" : "convex").arg(filled ? 1 : 0),
+                              pixelCount(engine, poly),
+                              [&]() { poly.draw(&engine); });
+                }
+            }
+        }
+    }
+}
+
+void benchAntialias(Bench& bench)
+{
+    DrawEngine engine(CANVAS_SIZE, CANVAS_SIZE);
+    engine.setAntialiasing(true);
+    const int c = CANVAS_SIZE / 2;
+
+    for (int n : {16, 1024})
+    {
+        for (int r : {16, 128, 500})
+        {
+            PolygonShape poly(makePolygon(n, r, true, c, c));
+            poly.filled = true;
+            poly.fillColor = QColor(200, 220, 255);
+            poly.color = Qt::black;
+            bench.run("aa_polygon", QString("vertices=%1,radius=%2,shape=star,filled=1").arg(n).arg(r),
+                      pixelCount(engine, poly), [&]() { poly.draw(&engine); });
+        }
+    }
+    for (int len : {128, 1000})
+    {
+        for (int width : {1, 4, 12})
+        {
+            LineShape line;
+            line.setEndpoints(QPoint(c - len * 4 / 10, c - len * 3 / 10), QPoint(c + len * 4 / 10, c + len * 3 / 10));
+            line.penWidth = width;
+            bench.run("aa_line", QString("len=%1,slope=37,width=%2").arg(len).arg(width),
+                      pixelCount(engine, line), [&]() { line.draw(&engine); });
+        }
+    }
+    for (int r : {64, 500})
+    {
+        for (int width : {1, 4})
+        {
+            ArcShape arc(QPoint(c, c), r, 10, 370, Qt::black);
+            arc.penWidth = width;
+            bench.run("aa_arc", QString("radius=%1,span=360,width=%2").arg(r).arg(width),
+                      pixelCount(engine, arc), [&]() { arc.draw(&engine); });
+        }
+    }
+
+    // 整帧：1920x1080 画布上的混合图元，cold 每帧清空光栅缓存，cached 从缓存回放（60 fps 预算约 16.7 ms）
+    for (int count : {1000, 5000})
+    {
+        for (bool aa : {false, true})
+        {
+            DrawEngine frame(1920, 1080);
+            frame.setAntialiasing(aa);
+            std::mt19937 rng(99);
+            std::uniform_int_distribution<int> px(0, 1919), py(0, 1079), off(-60, 60), width(1, 6);
+            for (int i = 0; i < count; ++i)
+            {
+                const QPoint p(px(rng), py(rng));
+                std::shared_ptr<Shape> s;
+                switch (i % 3)
+                {
+                case 0: {
+                    auto line = std::make_shared<LineShape>();
+                    line->setEndpoints(p, p + QPoint(off(rng), off(rng)));
+                    s = line;
+                    break;
+                }
+                case 1:
+                    s = std::make_shared<ArcShape>(p, 5 + std::abs(off(rng)) / 2, 0, 270, Qt::black);
+                    break;
+                default: {
+                    auto poly = std::make_shared<PolygonShape>(makePolygon(5, 10 + std::abs(off(rng)) / 2, true,
+                                                                           p.x(), p.y()));
+                    poly->filled = true;
+                    poly->fillColor = QColor::fromRgb(rng() & 0xffffff);
+                    s = poly;
+                    break;
+                }
+                }
+                s->penWidth = width(rng);
+                s->color = QColor::fromRgb(rng() & 0xffffff);
+                frame.addShape(s);
+            }
+            frame.renderDamage();
+
+            const QString name = QString("shapes=%1,size=1920x1080,aa=%2").arg(count).arg(aa ? 1 : 0);
+            bench.run("frame", name + ",cache=cold", 1920.0 * 1080.0, [&]() {
+                frame.setRasterCacheBudget(0);
+                frame.setRasterCacheBudget(256 * 1024 * 1024);
+                frame.invalidateAll();
+                frame.renderDamage();
+            });
+            bench.run("frame", name + ",cache=warm", 1920.0 * 1080.0, [&]() {
+                frame.invalidateAll();
+                frame.renderDamage();
+            });
+        }
+    }
+}
+
+// 种子填充：open 为空白区域；comb 为梳状隔墙形成的蛇形通道；dots 为随机散布的障碍点
+void benchFloodFill(Bench& bench)
+{
+    for (int size : {64, 256, 1024})
+    {
+        for (const char* layout : {"open", "comb", "dots"})
+        {
+            DrawEngine engine(size, size);
+            const QString kind = layout;
+            if (kind == "comb")
+            {
+                for (int x = 8; x < size - 1; x += 8)
+                {
+                    auto wall = std::make_shared<LineShape>();
+                    bool fromTop = (x / 8) & 1;
+                    wall->setEndpoints(QPoint(x, fromTop ? 0 : 4), QPoint(x, fromTop ? size - 5 : size - 1));
+                    wall->penWidth = 1;
+                    engine.addShape(wall);
+                }
+            }
+            else if (kind == "dots")
+            {
+                std::mt19937 rng(12345);
+                std::uniform_int_distribution<int> d(0, size - 1);
+                std::vector<QPoint> pts;
+                for (int i = 0; i < size * size / 32; ++i)
+                {
+                    QPoint p(d(rng), d(rng));
+                    if (p != QPoint(0, 0)) pts.push_back(p);
+                }
+                engine.addShape(std::make_shared<RasterFillShape>(pts, Qt::black));
+            }
+            engine.renderDamage();
+
+            auto probe = engine.floodFillAddShape(0, 0, Qt::red);
+            const double pixels = probe ? double(probe->pixelCount()) : 0.0;
+            bench.run("flood_fill", QString("size=%1,layout=%2").arg(size).arg(kind), pixels,
+                      [&]() { engine.floodFillAddShape(0, 0, Qt::red); });
+        }
+    }
+}
+
+void benchClipping(Bench& bench, DrawEngine& engine)
+{
+    std::mt19937 rng(2024);
+    std::uniform_int_distribution<int> d(-CANVAS_SIZE / 2, CANVAS_SIZE * 3 / 2);
+    const int xmin = 100, ymin = 100, xmax = CANVAS_SIZE - 100, ymax = CANVAS_SIZE - 100;
+
+    // 一批随机线段：内部、跨边界、完全在外都有
+    const int SEGMENTS = 4096;
+    std::vector<int> seg(SEGMENTS * 4);
+    for (int& v : seg) v = d(rng);
+    size_t next = 0;
+    volatile int sink = 0;
+    bench.run("clip_line", "cohen_sutherland,random", 0, [&]() {
+        int* s = &seg[(next++ % SEGMENTS) * 4];
+        int x0 = s[0], y0 = s[1], x1 = s[2], y1 = s[3];
+        if (engine.cohenSutherlandClip(x0, y0, x1, y1, xmin, ymin, xmax, ymax))
+            sink = sink + x0 + y1;
+    });
+
+    for (int n : {4, 32, 256, 2048})
+    {
+        for (bool star : {false, true})
+        {
+            // 多边形中心偏向一角，与裁剪矩形部分相交
+            auto poly = makePolygon(n, CANVAS_SIZE / 2, star, xmin + 50, ymin + 50);
+            bench.run("clip_polygon",
+                      QString("sutherland_hodgman,vertices=%1,shape=%2").arg(n).arg(star ? "star" : "convex"),
+                      0, [&]() {
+                          sink = sink + int(engine.clipPolygonWithRect(poly, xmin, ymin, xmax, ymax).size());
+                      });
+        }
+    }
+}
+
+void benchHitTest(Bench& bench)
+{
+    // 随机短线段铺满画布，点选 / 小范围框选的耗时应与图元总数基本无关
+    for (int count : {1000, 10000, 100000})
+    {
+        DrawEngine engine(CANVAS_SIZE, CANVAS_SIZE);
+        std::mt19937 rng(777);
+        std::uniform_int_distribution<int> pos(0, CANVAS_SIZE - 1);
+        std::uniform_int_distribution<int> off(-20, 20);
+        for (int i = 0; i < count; ++i)
+        {
+            auto line = std::make_shared<LineShape>();
+            const QPoint a(pos(rng), pos(rng));
+            line->setEndpoints(a, a + QPoint(off(rng), off(rng)));
+            engine.addShape(line);
+        }
+
+        const int PROBES = 1024;
+        std::vector<QPoint> probes(PROBES);
+        for (QPoint& p : probes) p = QPoint(pos(rng), pos(rng));
+        size_t next = 0;
+        volatile int sink = 0;
+
+        bench.run("hit_test", QString("click,shapes=%1").arg(count), 0, [&]() {
+            sink = sink + (engine.shapeAt(probes[next++ % PROBES]) ? 1 : 0);
+        });
+        bench.run("hit_test", QString("box=32,shapes=%1").arg(count), 0, [&]() {
+            const QPoint& p = probes[next++ % PROBES];
+            sink = sink + int(engine.shapesInRect(QRect(p, QSize(32, 32))).size());
+        });
+    }
+}
+
+void benchTransform(Bench& bench)
+{
+    // 直线/圆弧/多边形混合的 10 万个图元逐个经 Shape::transform 变换（不挂在引擎上，只计几何）
+    const int COUNT = 100000;
+    std::mt19937 rng(4242);
+    std::uniform_int_distribution<int> pos(0, CANVAS_SIZE - 1);
+    std::uniform_int_distribution<int> off(-30, 30);
+    std::vector<std::shared_ptr<Shape>> shapes;
+    shapes.reserve(COUNT);
+    for (int i = 0; i < COUNT; ++i)
+    {
+        QPoint p(pos(rng), pos(rng));
+        switch (i % 3)
+        {
+        case 0:
+        {
+            auto line = std::make_shared<LineShape>();
+            line->setEndpoints(p, p + QPoint(off(rng), off(rng)));
+            shapes.push_back(line);
+            break;
+        }
+        case 1:
+            shapes.push_back(std::make_shared<ArcShape>(p, 5 + std::abs(off(rng)), 30, 240, Qt::black));
+            break;
+        default:
+            shapes.push_back(std::make_shared<PolygonShape>(std::vector<QPoint>{
+                p, p + QPoint(off(rng), off(rng)), p + QPoint(off(rng), off(rng)),
+                p + QPoint(off(rng), off(rng)), p + QPoint(off(rng), off(rng))}));
+            break;
+        }
+    }
+
+    // 正反两个变换交替施加，几何不会持续漂移出画布
+    const QPointF c(CANVAS_SIZE / 2.0, CANVAS_SIZE / 2.0);
+    QTransform fwd = QTransform::fromTranslate(c.x(), c.y()).rotate(15).scale(1.1, 1.1).translate(-c.x(), -c.y());
+    QTransform inv = fwd.inverted();
+    bool flip = false;
+    bench.run("transform", QString("mixed,shapes=%1").arg(COUNT), 0, [&]() {
+        const QTransform& t = flip ? inv : fwd;
+        flip = !flip;
+        for (auto& s : shapes)
+            s->transform(t);
+    });
+
+    // 100 万个顶点的选区：逐点 QTransform::map 与 PointTransform 批量内核对比
+    const int POINTS = 1000000;
+    std::vector<QPoint> pts(POINTS);
+    for (QPoint& p : pts) p = QPoint(pos(rng), pos(rng));
+    bench.run("transform", QString("points,qtransform_map,n=%1").arg(POINTS), 0, [&]() {
+        const QTransform& t = flip ? inv : fwd;
+        flip = !flip;
+        for (QPoint& p : pts)
+            p = t.map(QPointF(p)).toPoint();
+    });
+    bench.run("transform", QString("points,batch_%1,n=%2").arg(PointTransform::implementation()).arg(POINTS), 0, [&]() {
+        PointTransform::mapInPlace(flip ? inv : fwd, pts.data(), pts.size());
+        flip = !flip;
+    });
+}
+
+void benchSnapshot(Bench& bench)
+{
+    // 10 万个图元的场景：未变化 / 改动一个 / 新增一个之后发布快照，与逐个深拷贝整个场景对比
+    const int COUNT = 100000;
+    DrawEngine engine(CANVAS_SIZE, CANVAS_SIZE);
+    std::mt19937 rng(2024);
+    std::uniform_int_distribution<int> pos(0, CANVAS_SIZE - 1);
+    std::uniform_int_distribution<int> off(-30, 30);
+    for (int i = 0; i < COUNT; ++i)
+    {
+        auto line = std::make_shared<LineShape>();
+        const QPoint a(pos(rng), pos(rng));
+        line->setEndpoints(a, a + QPoint(off(rng), off(rng)));
+        engine.addShape(line);
+    }
+    engine.snapshot();
+
+    const std::vector<std::shared_ptr<Shape>> shapes = engine.getShapes();
+    volatile std::size_t sink = 0;
+    QTransform nudge = QTransform::fromTranslate(1, 0);
+    std::size_t next = 0;
+
+    bench.run("snapshot", QString("unchanged,shapes=%1").arg(COUNT), 0, [&]() {
+        sink = sink + engine.snapshot().size();
+    });
+    bench.run("snapshot", QString("edit=1,shapes=%1").arg(COUNT), 0, [&]() {
+        shapes[next++ % shapes.size()]->transform(nudge);
+        sink = sink + engine.snapshot().size();
+    });
+    bench.run("snapshot", QString("append=1,shapes=%1").arg(COUNT), 0, [&]() {
+        auto line = std::make_shared<LineShape>();
+        const QPoint a(pos(rng), pos(rng));
+        line->setEndpoints(a, a + QPoint(off(rng), off(rng)));
+        engine.addShape(line);
+        sink = sink + engine.snapshot().size();
+    });
+    bench.run("snapshot", QString("deep_copy,shapes=%1").arg(COUNT), 0, [&]() {
+        std::vector<std::shared_ptr<Shape>> copy;
+        copy.reserve(shapes.size());
+        for (const auto& s : shapes)
+            copy.push_back(s->clone());
+        sink = sink + copy.size();
+    });
+}
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName("graphicbench");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Microbenchmarks for the GraphicEngine rasterization primitives.");
+    parser.addHelpOption();
+    QCommandLineOption csvOpt("csv", "Write CSV instead of JSON Lines.");
+    QCommandLineOption filterOpt("filter", "Only run cases whose group/case contains text.", "text");
+    QCommandLineOption timeOpt("min-time", "Minimum measured time per round in ms (default 50).", "ms", "50");
+    QCommandLineOption roundsOpt("rounds", "Measured rounds per case, fastest wins (default 3).", "n", "3");
+    parser.addOption(csvOpt);
+    parser.addOption(filterOpt);
+    parser.addOption(timeOpt);
+    parser.addOption(roundsOpt);
+    parser.process(app);
+
+    Options opt;
+    opt.csv = parser.isSet(csvOpt);
+    opt.filter = parser.value(filterOpt);
+    opt.minSeconds = std::max(1, parser.value(timeOpt).toInt()) / 1000.0;
+    opt.rounds = std::max(1, parser.value(roundsOpt).toInt());
+
+    Bench bench(opt);
+    DrawEngine engine(CANVAS_SIZE, CANVAS_SIZE);
+
+    benchSpanWrites(bench, engine);
+    benchLines(bench, engine);
+    benchHairlines(bench);
+    benchArcs(bench, engine);
+    benchEllipses(bench, engine);
+    benchPolygons(bench, engine);
+    benchAntialias(bench);
+    benchFloodFill(bench);
+    benchClipping(bench, engine);
+    benchHitTest(bench);
+    benchTransform(bench);
+    benchSnapshot(bench);
+    return 0;
+}
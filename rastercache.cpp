@@ -0,0 +1,116 @@
+#include "rastercache.h"
+
+#include <algorithm>
+
+RasterCache::RasterCache(std::size_t budgetBytes)
+    : budgetBytes(budgetBytes)
+{
+}
+
+std::shared_ptr<const SpanList> RasterCache::find(const Shape* s)
+{
+    auto it = index.find(s);
+    if (it == index.end()) return nullptr;
+
+    // 命中：移动到 LRU 头部
+    lru.splice(lru.begin(), lru, it->second);
+    return it->second->spans;
+}
+
+void RasterCache::insert(const Shape* s, std::shared_ptr<const SpanList> spans)
+{
+    if (!s || !spans) return;
+    remove(s);
+
+    std::size_t bytes = bytesFor(*spans);
+    // 单个图元超过预算的 1/4 时不缓存，避免一个大图元把其他条目全部挤掉
+    if (bytes > budgetBytes / 4) return;
+
+    lru.push_front({s, std::move(spans), bytes});
+    index[s] = lru.begin();
+    usedBytes += bytes;
+    evictToBudget();
+}
+
+void RasterCache::remove(const Shape* s)
+{
+    auto it = index.find(s);
+    if (it == index.end()) return;
+
+    usedBytes -= it->second->bytes;
+    lru.erase(it->second);
+    index.erase(it);
+}
+
+void RasterCache::clear()
+{
+    lru.clear();
+    index.clear();
+    usedBytes = 0;
+}
+
+void RasterCache::setBudget(std::size_t bytes)
+{
+    budgetBytes = bytes;
+    evictToBudget();
+}
+
+void RasterCache::evictToBudget()
+{
+    while (usedBytes > budgetBytes && !lru.empty())
+    {
+        const Entry& victim = lru.back();
+        usedBytes -= victim.bytes;
+        index.erase(victim.key);
+        lru.pop_back();
+    }
+}
+
+std::size_t RasterCache::bytesFor(const SpanList& spans)
+{
+    // span 数据 + 条目/索引的固定开销
+    return spans.capacity() * sizeof(RasterSpan) + sizeof(Entry) + 4 * sizeof(void*);
+}
+
+void RasterCache::compact(SpanList& spans)
+{
+    if (spans.size() < 2) return;
+
+    std::size_t out = 0;
+    std::size_t i = 0;
+    const std::size_t n = spans.size();
+    while (i < n)
+    {
+        // [i, j) 为同色的一段（不计 alpha）
+        const QRgb color = spans[i].rgb & 0x00ffffff;
+        std::size_t j = i + 1;
+        while (j < n && (spans[j].rgb & 0x00ffffff) == color) ++j;
+
+        std::sort(spans.begin() + i, spans.begin() + j,
+                  [](const RasterSpan& a, const RasterSpan& b) {
+                      return a.y != b.y ? a.y < b.y : a.x0 < b.x0;
+                  });
+
+        // 合并同一行上重叠或相邻的区间
+        std::size_t runStart = out;
+        for (std::size_t k = i; k < j; ++k)
+        {
+            const RasterSpan& s = spans[k];
+            if (out > runStart)
+            {
+                RasterSpan& last = spans[out - 1];
+                const bool opaque = qAlpha(s.rgb) == 255;
+                if (last.y == s.y && last.rgb == s.rgb
+                    && (opaque ? s.x0 <= last.x1 + 1 : s.x0 == last.x1 + 1))
+                {
+                    last.x1 = std::max(last.x1, s.x1);
+                    continue;
+                }
+            }
+            spans[out++] = s;
+        }
+        i = j;
+    }
+    spans.resize(out);
+    spans.shrink_to_fit();
+}
@@ -0,0 +1,82 @@
+#ifndef RASTERCACHE_H
+#define RASTERCACHE_H
+
+#include <QColor>
+#include <vector>
+#include <list>
+#include <memory>
+#include <unordered_map>
+#include <cstddef>
+
+class Shape;
+
+/**
+ * @brief RasterSpan —— 光栅化结果中的一个水平区间
+ * 第 y 行的 [x0, x1] 闭区间填为 rgb；rgb 的 alpha 不为 255 时表示以该覆盖率混合（抗锯齿边缘）
+ */
+struct RasterSpan
+{
+    int y;
+    int x0;
+    int x1;
+    QRgb rgb;
+};
+
+using SpanList = std::vector<RasterSpan>;
+
+/**
+ * @brief RasterCache —— 图元光栅化结果缓存（按图元索引的 span 列表）
+ *
+ * 静态图元每帧重新执行 Bresenham / 中点圆 / 扫描线填充是浪费，
+ * 这里把图元第一次光栅化得到的 span 列表保存下来，重绘时直接回放。
+ *
+ * - 图元几何或样式变化时（Shape::invalidate）由 DrawEngine 调用 remove() 失效
+ * - 总内存受 budget 限制，超出时按 LRU（最近最少使用）淘汰
+ * - 条目以 shared_ptr 持有，正在使用的 span 列表即使被淘汰也不会提前释放
+ */
+class RasterCache
+{
+public:
+    explicit RasterCache(std::size_t budgetBytes = 64 * 1024 * 1024);
+
+    // 查找图元的缓存（命中时移动到 LRU 头部），未命中返回 nullptr
+    std::shared_ptr<const SpanList> find(const Shape* s);
+
+    // 插入/替换图元的缓存，必要时淘汰最久未使用的条目
+    void insert(const Shape* s, std::shared_ptr<const SpanList> spans);
+
+    // 移除图元的缓存（图元被修改或删除时）
+    void remove(const Shape* s);
+
+    void clear();
+
+    void setBudget(std::size_t bytes);
+    std::size_t budget() const { return budgetBytes; }
+    std::size_t memoryUsage() const { return usedBytes; }
+    std::size_t entryCount() const { return index.size(); }
+
+    // 整理录制得到的 span：同色的连续一段内按 (y, x0) 排序并合并重叠/相邻区间
+    // 同色区间重复写入结果不变，因此只在同色段内重排，不同颜色之间的先后顺序保持不变
+    // 同色的混合与覆盖写入之间次序可交换，按颜色（不含 alpha）分段；混合 span 重叠时各混合一次，只合并相邻的
+    static void compact(SpanList& spans);
+
+    // 估算一条缓存占用的字节数
+    static std::size_t bytesFor(const SpanList& spans);
+
+private:
+    struct Entry
+    {
+        const Shape* key;
+        std::shared_ptr<const SpanList> spans;
+        std::size_t bytes;
+    };
+
+    void evictToBudget();
+
+    std::size_t budgetBytes;
+    std::size_t usedBytes = 0;
+    std::list<Entry> lru;                                               // 头部为最近使用
+    std::unordered_map<const Shape*, std::list<Entry>::iterator> index;
+};
+
+#endif // RASTERCACHE_H
@@ -1,13 +1,71 @@
 #include "rasterfillshape.h"
 #include "drawengine.h"
+#include <algorithm>
+
+namespace {
+
+bool spanLess(const RasterFillShape::Span& a, const RasterFillShape::Span& b)
+{
+    return a.y != b.y ? a.y < b.y : a.x0 < b.x0;
+}
+
+} // namespace
+
+RasterFillShape::RasterFillShape(std::vector<Span> s, const QColor &c)
+    : Shape(ShapeKind::RasterFill), spans(std::move(s))
+{
+    color = c;
+    if (!std::is_sorted(spans.begin(), spans.end(), spanLess))
+        std::sort(spans.begin(), spans.end(), spanLess);
+}
+
+RasterFillShape::RasterFillShape(const std::vector<QPoint>& pts, const QColor &c)
+    : Shape(ShapeKind::RasterFill)
+{
+    color = c;
+    std::vector<QPoint> sorted(pts);
+    std::sort(sorted.begin(), sorted.end(), [](const QPoint& a, const QPoint& b) {
+        return a.y() != b.y() ? a.y() < b.y() : a.x() < b.x();
+    });
+    for (const QPoint& p : sorted)
+    {
+        if (!spans.empty() && spans.back().y == p.y() && p.x() <= spans.back().x1 + 1)
+            spans.back().x1 = std::max(spans.back().x1, p.x());
+        else
+            spans.push_back({p.y(), p.x(), p.x()});
+    }
+}
 
 void RasterFillShape::draw(DrawEngine* engine)
 {
     if (!engine) return;
-    // 逐像素写回画布，直接用 engine->setPixel（填充不受线型/线帽影响）
-    for (const QPoint &p : pixels)
+    // 写回画布（填充不受线型/线帽影响）
+    // 区间按 y 有序：二分跳到裁剪矩形的首行，越过末行即停止（分块重绘时只处理本块的行）
+    const QRgb rgb = color.rgb();
+    const QRect clip = engine->currentClip();
+    auto it = std::lower_bound(spans.begin(), spans.end(), clip.top(),
+                               [](const Span& s, int y) { return s.y < y; });
+    for (; it != spans.end() && it->y <= clip.bottom(); ++it)
+        engine->fillSpan(it->y, it->x0, it->x1, rgb);
+}
+
+// 包围盒：所有区间的范围（只在图元登记/修改时计算一次）
+QRect RasterFillShape::boundingRect() const
+{
+    if (spans.empty()) return QRect();
+    int minX = spans.front().x0, maxX = spans.front().x1;
+    for (const Span &s : spans)
     {
-        engine->setPixel(p.x(), p.y(), color);
+        minX = std::min(minX, s.x0);
+        maxX = std::max(maxX, s.x1);
     }
+    return QRect(QPoint(minX, spans.front().y), QPoint(maxX, spans.back().y));
 }
 
+size_t RasterFillShape::pixelCount() const
+{
+    size_t n = 0;
+    for (const Span &s : spans)
+        n += size_t(s.x1 - s.x0 + 1);
+    return n;
+}
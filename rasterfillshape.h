@@ -7,22 +7,41 @@
 
 /**
  * @brief RasterFillShape
- * 将一次像素级填充的结果（若干像素点集合）作为一个 Shape 持久化保存。
- * draw() 会把这些像素写回 DrawEngine 的画布。
+ * 将一次像素级填充的结果作为一个 Shape 持久化保存。
+ * 像素按行存成 [y, x0, x1] 区间（按 y、x0 升序），内存与区域边界长度成正比，
+ * draw() 对每个区间做一次连续的行写入。
  *
  * 优点：填充效果会随着 engine 的重绘持久化显示，不会在下一次 paintEvent 中丢失。
  */
 class RasterFillShape : public Shape
 {
 public:
-    RasterFillShape() = default;
-    explicit RasterFillShape(const std::vector<QPoint>& pts, const QColor &c = Qt::black)
-        : pixels(pts) { color = c; }
+    // 第 y 行 [x0, x1] 闭区间
+    struct Span
+    {
+        int y;
+        int x0;
+        int x1;
+    };
+
+    RasterFillShape() : Shape(ShapeKind::RasterFill) {}
+    explicit RasterFillShape(std::vector<Span> s, const QColor &c = Qt::black);
+    // 由离散像素构造：同一行上 x 连续的像素合并为一个区间
+    explicit RasterFillShape(const std::vector<QPoint>& pts, const QColor &c = Qt::black);
 
     void draw(DrawEngine* engine) override;
     bool contains(const QPoint& pt) const override { return false; }
+    QRect boundingRect() const override;
+    // 本身就是 span 列表，不需要再录制进光栅缓存
+    bool cacheRaster() const override { return false; }
+
+    // 填充的像素总数
+    size_t pixelCount() const;
+
+    std::vector<Span> spans;
 
-    std::vector<QPoint> pixels;
+protected:
+    std::shared_ptr<Shape> cloneShape() const override { return std::make_shared<RasterFillShape>(*this); }
 };
 
 #endif // RASTERFILLSHAPE_H
@@ -0,0 +1,221 @@
+#include "scanlinefiller.h"
+#include "coveragerasterizer.h"
+#include "drawengine.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+    constexpr int FRACTION_BITS = 32;
+    constexpr qint64 FIXED_ONE = qint64(1) << FRACTION_BITS;
+    constexpr double FIXED_LIMIT = double(1 << 30);                     // 坐标限幅（像素），保证乘以 FIXED_ONE 后不溢出
+
+    inline qint64 toFixed(double v)
+    {
+        return qint64(std::llround(std::clamp(v, -FIXED_LIMIT, FIXED_LIMIT) * double(FIXED_ONE)));
+    }
+    // 定点数向上 / 向下取整到整数像素（算术右移即向负无穷取整）
+    inline int fixedCeil(qint64 v) { return int((v + FIXED_ONE - 1) >> FRACTION_BITS); }
+    inline int fixedFloor(qint64 v) { return int(v >> FRACTION_BITS); }
+}
+
+ScanlineFiller::ScanlineFiller() = default;
+ScanlineFiller::~ScanlineFiller() = default;
+
+void ScanlineFiller::setAntialiased(bool on)
+{
+    clear();
+    antialiased = on;
+    if (on && !coverage)
+        coverage = std::make_unique<CoverageRasterizer>();
+}
+
+void ScanlineFiller::clear()
+{
+    edges.clear();
+    if (coverage) coverage->clear();
+}
+
+bool ScanlineFiller::isEmpty() const
+{
+    return antialiased ? coverage->isEmpty() : edges.empty();
+}
+
+void ScanlineFiller::addEdge(double x0, double y0, double x1, double y1)
+{
+    if (antialiased)
+    {
+        coverage->addLine(x0, y0, x1, y1);                              // 覆盖率光栅器需要保留原始方向与浮点端点
+        return;
+    }
+
+    if (y0 == y1) return;                                               // 水平边不参与求交
+
+    int dir = 1;
+    if (y0 > y1)
+    {
+        std::swap(x0, x1);
+        std::swap(y0, y1);
+        dir = -1;
+    }
+
+    int yStart = int(std::ceil(y0));
+    int yEnd = int(std::ceil(y1));
+    if (yStart >= yEnd) return;                                         // 不跨越任何整数扫描线
+
+    double invSlope = (x1 - x0) / (y1 - y0);
+    double x = x0;
+    if (yStart != y0)
+        x += (yStart - y0) * invSlope;
+    edges.push_back({yStart, yEnd, toFixed(x), toFixed(invSlope), dir});
+}
+
+void ScanlineFiller::addContour(const std::vector<QPoint>& pts)
+{
+    int n = int(pts.size());
+    for (int i = 0; i < n; ++i)
+    {
+        const QPoint& p1 = pts[i];
+        const QPoint& p2 = pts[(i + 1) % n];
+        addEdge(p1.x(), p1.y(), p2.x(), p2.y());
+    }
+}
+
+void ScanlineFiller::addContour(const std::vector<QPointF>& pts)
+{
+    addContour(pts.data(), int(pts.size()));
+}
+
+void ScanlineFiller::addContour(const QPointF* pts, int n)
+{
+    for (int i = 0; i < n; ++i)
+    {
+        const QPointF& p1 = pts[i];
+        const QPointF& p2 = pts[(i + 1) % n];
+        addEdge(p1.x(), p1.y(), p2.x(), p2.y());
+    }
+}
+
+/**
+ * @brief 把 edges[first, last)（同一起始行，已按 x 排序）并入有序的 AET
+ * 从尾部向前归并，每行只移动一遍 AET，与新边条数无关
+ */
+void ScanlineFiller::mergeActive(size_t first, size_t last)
+{
+    size_t i = active.size();
+    size_t k = last;
+    active.resize(active.size() + (last - first));
+    size_t out = active.size();
+    while (k > first)
+    {
+        if (i > 0 && active[i - 1].x > edges[k - 1].x)
+            active[--out] = active[--i];
+        else
+            active[--out] = edges[--k];
+    }
+}
+
+void ScanlineFiller::emitSpans(DrawEngine* engine, int y, QRgb rgb, FillRule rule) const
+{
+    if (rule == FillRule::EvenOdd)
+    {
+        for (size_t i = 0; i + 1 < active.size(); i += 2)
+        {
+            int xStart = fixedCeil(active[i].x);
+            int xEnd   = fixedFloor(active[i + 1].x);
+            if (xStart <= xEnd)
+                engine->fillSpan(y, xStart, xEnd, rgb);
+        }
+        return;
+    }
+
+    int winding = 0;
+    Fixed left = 0;
+    for (const Edge& e : active)
+    {
+        int before = winding;
+        winding += e.dir;
+        if (before == 0 && winding != 0)
+            left = e.x;
+        else if (before != 0 && winding == 0)
+        {
+            int xStart = fixedCeil(left);
+            int xEnd   = fixedFloor(e.x);
+            if (xStart <= xEnd)
+                engine->fillSpan(y, xStart, xEnd, rgb);
+        }
+    }
+}
+
+/**
+ * @brief 扫描线填充
+ * 1. 边按起始扫描线（同一行内按 x）排序，std::sort 原地进行，不申请临时缓冲；
+ * 2. 逐行：把从本行开始的边归并进 AET 的有序位置，输出 span；
+ * 3. 删除在本行结束的边，其余边 x 累加一步，再以插入排序恢复有序；
+ *    AET 为空时直接跳到下一条边的起始行。
+ * edges 与 active 只清空不释放，同一个填充器再次使用时不分配内存
+ */
+void ScanlineFiller::fill(DrawEngine* engine, QRgb rgb, FillRule rule)
+{
+    if (antialiased)
+    {
+        coverage->fill(engine, rgb, rule);
+        return;
+    }
+    if (!engine || edges.empty()) return;
+
+    std::sort(edges.begin(), edges.end(), [](const Edge& a, const Edge& b) {
+        return a.yStart < b.yStart || (a.yStart == b.yStart && a.x < b.x);
+    });
+
+    active.clear();
+    const size_t count = edges.size();
+    size_t next = 0;
+    int scanY = edges.front().yStart;
+
+    while (next < count || !active.empty())
+    {
+        if (active.empty() && scanY < edges[next].yStart)
+            scanY = edges[next].yStart;
+
+        const size_t first = next;
+        while (next < count && edges[next].yStart == scanY)
+            ++next;
+        if (next > first)
+            mergeActive(first, next);
+
+        emitSpans(engine, scanY, rgb, rule);
+
+        // 删除结束的边并步进，保持原有次序（缩小 active 不会重新分配，aet 在本行内一直有效）
+        Edge* const aet = active.data();
+        const size_t n = active.size();
+        size_t kept = 0;
+        for (size_t i = 0; i < n; ++i)
+        {
+            if (aet[i].yEnd <= scanY + 1) continue;
+            aet[kept] = aet[i];
+            aet[kept].x += aet[kept].step;
+            ++kept;
+        }
+        active.resize(kept);
+
+        // 插入排序：交叉的边只与相邻的少数几条交换位置
+        for (size_t i = 1; i < kept; ++i)
+        {
+            if (aet[i - 1].x <= aet[i].x) continue;
+            const Edge e = aet[i];
+            size_t j = i;
+            do
+            {
+                aet[j] = aet[j - 1];
+                --j;
+            } while (j > 0 && aet[j - 1].x > e.x);
+            aet[j] = e;
+        }
+
+        ++scanY;
+    }
+
+    edges.clear();
+}
@@ -0,0 +1,81 @@
+#ifndef SCANLINEFILLER_H
+#define SCANLINEFILLER_H
+
+#include <QPoint>
+#include <QPointF>
+#include <QColor>
+#include <vector>
+#include <memory>
+
+class DrawEngine;
+class CoverageRasterizer;
+
+// 填充规则：奇偶规则 / 非零环绕规则
+enum class FillRule {EvenOdd, NonZero};
+
+/**
+ * @brief ScanlineFiller —— 通用扫描线多边形填充（边表 ET + 活动边表 AET）
+ *
+ * 可以累积任意多个闭合轮廓（坐标可为浮点），再一次性按行填充：
+ *  - 扫描线取整数 y，边覆盖 ceil(yTop) <= y < ceil(yBottom) 的行；
+ *  - 边的交点 x 与每行增量为 32.32 定点数，逐行只做整数加法；
+ *  - AET 始终按 x 有序：新边插入到有序位置，逐行步进后用插入排序修正
+ *    （相邻两行边的次序几乎不变，插入排序接近线性）；
+ *  - 奇偶规则按两两配对、非零规则按环绕数区间取 span，
+ *    span 取 [ceil(xl), floor(xr)]，通过 DrawEngine::fillSpan 写入（受裁剪限制）。
+ *
+ * 边表与 AET 在 clear() / fill() 后保留容量：DrawEngine 为每个引擎持有一个填充器
+ * （scanlineFiller()），图元反复绘制时不再分配内存
+ *
+ * PolygonShape 的内部填充（奇偶规则）与描边轮廓（非零规则，各部件取并集）共用此填充器
+ *
+ * 抗锯齿模式（setAntialiased）下边转交 CoverageRasterizer，按面积覆盖率混合输出，调用方式不变
+ */
+class ScanlineFiller
+{
+public:
+    ScanlineFiller();
+    ~ScanlineFiller();
+
+    // 抗锯齿开关（由 DrawEngine::setAntialiasing 设置），切换时丢弃已添加的边
+    void setAntialiased(bool on);
+    bool isAntialiased() const { return antialiased; }
+
+    // 添加一个闭合轮廓（最后一个顶点自动与第一个相连）
+    void addContour(const std::vector<QPoint>& pts);
+    void addContour(const std::vector<QPointF>& pts);
+    void addContour(const QPointF* pts, int n);
+
+    void clear();
+    bool isEmpty() const;
+
+    // 按 rule 填充已添加的全部轮廓
+    void fill(DrawEngine* engine, QRgb rgb, FillRule rule);
+
+private:
+    // 32.32 定点数：高 32 位为整数像素，低 32 位为小数
+    // （16 位小数在上千行的长边上累积误差可达 1/100 像素，会让恰好落在像素边界附近的 span 端点偏移一格）
+    using Fixed = qint64;
+
+    struct Edge
+    {
+        int yStart;                                                     // 第一条扫描线
+        int yEnd;                                                       // 最后一条扫描线 + 1
+        Fixed x;                                                        // 当前扫描线处的交点
+        Fixed step;                                                     // 每行 x 的增量（dx / dy）
+        int dir;                                                        // 方向（向下 +1，向上 -1），用于非零规则
+    };
+
+    void addEdge(double x0, double y0, double x1, double y1);
+    // 把同一行开始的一批边归并进 AET（保持按 x 有序）
+    void mergeActive(size_t first, size_t last);
+    // 输出第 y 行的 span
+    void emitSpans(DrawEngine* engine, int y, QRgb rgb, FillRule rule) const;
+
+    std::vector<Edge> edges;
+    std::vector<Edge> active;                                           // AET（多次 fill 之间复用内存）
+    bool antialiased = false;
+    std::unique_ptr<CoverageRasterizer> coverage;                       // 抗锯齿光栅器（首次开启时创建）
+};
+
+#endif // SCANLINEFILLER_H
@@ -0,0 +1,517 @@
+#include "scenefile.h"
+#include "drawengine.h"
+#include "scenesnapshot.h"
+#include "lineshape.h"
+#include "arcshape.h"
+#include "ellipseshape.h"
+#include "polygonshape.h"
+#include "tangrampiece.h"
+#include "tangramgame.h"
+#include "sceneio.h"
+
+#include <QtGlobal>
+#include <vector>
+#include <memory>
+#include <type_traits>
+#include <cmath>
+
+static_assert(sizeof(SceneFile::Header) == 88, "SceneFile::Header layout");
+static_assert(sizeof(SceneFile::Record) == 40, "SceneFile::Record layout");
+static_assert(sizeof(QPoint) == 8 && std::is_standard_layout<QPoint>::value, "QPoint stored as two qint32");
+static_assert(sizeof(RasterFillShape::Span) == 12, "Span stored as three int32");
+
+namespace {
+
+const int ARC_REALS = 11;                                               // cx, cy, r, start, end, 6 个矩阵元素
+const int ELLIPSE_REALS = 12;                                           // cx, cy, rx, ry, start, end, 6 个矩阵元素
+const int TANGRAM_REALS = 3;                                            // x, y, rotation
+
+quint64 align8(quint64 n)
+{
+    return (n + 7) & ~quint64(7);
+}
+
+// 写文件时按类型收集的各数组
+struct Columns
+{
+    std::vector<SceneFile::Record> records;
+    std::vector<QPoint> points;
+    std::vector<RasterFillShape::Span> spans;
+    std::vector<double> reals;
+
+    void append(const Shape& s)
+    {
+        SceneFile::Record r = {};
+        r.zOrder = s.zOrder;
+        r.color = s.color.rgba();
+        r.penWidth = s.penWidth;
+        r.dashOffset = s.dashOffset;
+        r.kind = quint8(s.kind());
+        r.lineStyle = quint8(s.lineStyle);
+        r.lineCap = quint8(s.lineCap);
+        r.lineJoin = quint8(s.lineJoin);
+
+        switch (s.kind())
+        {
+        case ShapeKind::Line:
+        {
+            const LineShape& line = static_cast<const LineShape&>(s);
+            r.first = quint32(points.size());
+            r.count = 2;
+            points.push_back(line.startPoint());
+            points.push_back(line.endPoint());
+            r.flags = line.antialiased ? SceneFile::Antialiased : 0;
+            break;
+        }
+        case ShapeKind::Arc:
+        {
+            const ArcShape& arc = static_cast<const ArcShape&>(s);
+            const QTransform& m = arc.matrix;
+            r.first = quint32(reals.size());
+            r.count = ARC_REALS;
+            reals.insert(reals.end(), {double(arc.center.x()), double(arc.center.y()), double(arc.radius),
+                                       arc.startAngle, arc.endAngle,
+                                       m.m11(), m.m12(), m.m21(), m.m22(), m.dx(), m.dy()});
+            break;
+        }
+        case ShapeKind::Ellipse:
+        {
+            const EllipseShape& ellipse = static_cast<const EllipseShape&>(s);
+            const QTransform& m = ellipse.matrix;
+            r.first = quint32(reals.size());
+            r.count = ELLIPSE_REALS;
+            r.fillColor = ellipse.fillColor.rgba();
+            r.flags = quint8((ellipse.filled ? SceneFile::Filled : 0)
+                             | (ellipse.form == EllipseShape::Form::Pie ? SceneFile::Pie : 0)
+                             | (ellipse.form == EllipseShape::Form::Chord ? SceneFile::Chord : 0));
+            reals.insert(reals.end(), {double(ellipse.center.x()), double(ellipse.center.y()),
+                                       double(ellipse.radiusX), double(ellipse.radiusY),
+                                       ellipse.startAngle, ellipse.endAngle,
+                                       m.m11(), m.m12(), m.m21(), m.m22(), m.dx(), m.dy()});
+            break;
+        }
+        case ShapeKind::Polygon:
+        {
+            const PolygonShape& poly = static_cast<const PolygonShape&>(s);
+            r.first = quint32(points.size());
+            const std::vector<QPoint>& vertices = poly.vertices();
+            r.count = quint32(vertices.size());
+            r.fillColor = poly.fillColor.rgba();
+            r.flags = poly.filled ? SceneFile::Filled : 0;
+            points.insert(points.end(), vertices.begin(), vertices.end());
+            break;
+        }
+        case ShapeKind::RasterFill:
+        {
+            const RasterFillShape& fill = static_cast<const RasterFillShape&>(s);
+            r.first = quint32(spans.size());
+            r.count = quint32(fill.spans.size());
+            spans.insert(spans.end(), fill.spans.begin(), fill.spans.end());
+            break;
+        }
+        case ShapeKind::TangramPiece:
+        {
+            const TangramPiece& piece = static_cast<const TangramPiece&>(s);
+            const TangramPose pose = piece.pose();
+            r.first = quint32(reals.size());
+            r.count = TANGRAM_REALS;
+            r.fillColor = piece.fillColor.rgba();
+            r.flags = quint8((piece.filled ? SceneFile::Filled : 0) | (pose.flipped ? SceneFile::Flipped : 0));
+            r.piece = quint8(piece.pieceType());
+            reals.insert(reals.end(), {pose.position.x(), pose.position.y(), pose.rotationDeg});
+            break;
+        }
+        default:
+            return;                                                     // 未知类型：不写出
+        }
+        records.push_back(r);
+    }
+};
+
+template <class T>
+bool writeArray(QFile& file, const std::vector<T>& v, quint64 offset)
+{
+    // 补齐到数组的对齐起点
+    static const char zeros[8] = {};
+    const qint64 pad = qint64(offset) - file.pos();
+    if (pad < 0 || pad > 8 || (pad > 0 && file.write(zeros, pad) != pad))
+        return false;
+    const qint64 bytes = qint64(v.size() * sizeof(T));
+    return bytes == 0 || file.write(reinterpret_cast<const char*>(v.data()), bytes) == bytes;
+}
+
+bool writeFile(const QString& path, const QSize& size, QRgb background, const Columns& c, QString* error)
+{
+    SceneFile::Header h = {};
+    h.magic = SceneFile::MAGIC;
+    h.version = SceneFile::VERSION;
+    h.headerSize = sizeof(SceneFile::Header);
+    h.width = size.width();
+    h.height = size.height();
+    h.background = background;
+
+    quint64 offset = align8(sizeof(SceneFile::Header));
+    h.recordCount = c.records.size();
+    h.recordsOffset = offset;
+    offset = align8(offset + c.records.size() * sizeof(SceneFile::Record));
+    h.pointCount = c.points.size();
+    h.pointsOffset = offset;
+    offset = align8(offset + c.points.size() * sizeof(QPoint));
+    h.spanCount = c.spans.size();
+    h.spansOffset = offset;
+    offset = align8(offset + c.spans.size() * sizeof(RasterFillShape::Span));
+    h.realCount = c.reals.size();
+    h.realsOffset = offset;
+
+    QFile file(path);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate))
+    {
+        if (error) *error = QString("cannot write %1").arg(path);
+        return false;
+    }
+    const bool ok = file.write(reinterpret_cast<const char*>(&h), sizeof(h)) == qint64(sizeof(h))
+                    && writeArray(file, c.records, h.recordsOffset)
+                    && writeArray(file, c.points, h.pointsOffset)
+                    && writeArray(file, c.spans, h.spansOffset)
+                    && writeArray(file, c.reals, h.realsOffset);
+    if (!ok && error) *error = QString("write error on %1").arg(path);
+    return ok;
+}
+
+// 数组 [offset, offset + count * elem) 完整落在文件内且按 8 字节对齐
+bool arrayFits(quint64 offset, quint64 count, quint64 elem, qint64 size)
+{
+    return offset % 8 == 0 && offset <= quint64(size) && count <= (quint64(size) - offset) / elem;
+}
+
+bool rangeFits(quint32 first, quint32 count, quint64 total)
+{
+    return quint64(first) + count <= total;
+}
+
+// 实数全部有限（NaN / inf 会在转 int 或光栅化时产生未定义行为）
+bool allFinite(const double* a, int n)
+{
+    for (int i = 0; i < n; ++i)
+        if (!std::isfinite(a[i]))
+            return false;
+    return true;
+}
+
+bool pointsValid(const QPoint* p, quint32 n)
+{
+    for (quint32 i = 0; i < n; ++i)
+        if (!SceneIO::coordValid(p[i].x()) || !SceneIO::coordValid(p[i].y()))
+            return false;
+    return true;
+}
+
+// RasterFillShape 的前提：按 (y, x0) 升序、每个区间 x0 <= x1（draw 二分查找行、boundingRect 取首尾行）
+bool spansValid(const RasterFillShape::Span* s, quint32 n)
+{
+    for (quint32 i = 0; i < n; ++i)
+    {
+        if (!SceneIO::coordValid(s[i].y) || !SceneIO::coordValid(s[i].x0) || !SceneIO::coordValid(s[i].x1)
+            || s[i].x0 > s[i].x1)
+            return false;
+        if (i > 0 && (s[i].y < s[i - 1].y || (s[i].y == s[i - 1].y && s[i].x0 < s[i - 1].x0)))
+            return false;
+    }
+    return true;
+}
+
+// 圆弧 / 椭圆 / 七巧板记录的实数：全部有限，圆心（位置）与半径可以安全地转为 int
+bool realsValid(ShapeKind kind, const double* a)
+{
+    switch (kind)
+    {
+    case ShapeKind::Arc:
+        return allFinite(a, ARC_REALS) && SceneIO::coordValid(a[0]) && SceneIO::coordValid(a[1])
+               && SceneIO::radiusValid(a[2]);
+    case ShapeKind::Ellipse:
+        return allFinite(a, ELLIPSE_REALS) && SceneIO::coordValid(a[0]) && SceneIO::coordValid(a[1])
+               && SceneIO::radiusValid(a[2]) && SceneIO::radiusValid(a[3]);
+    case ShapeKind::TangramPiece:
+        return allFinite(a, TANGRAM_REALS) && SceneIO::coordValid(a[0]) && SceneIO::coordValid(a[1]);
+    default:
+        return true;
+    }
+}
+
+void applyStyle(const SceneFile::Record& r, Shape& s)
+{
+    s.color = QColor::fromRgba(r.color);
+    s.penWidth = r.penWidth;
+    s.dashOffset = r.dashOffset;
+    s.lineStyle = LineStyle(r.lineStyle);
+    s.lineCap = LineCap(r.lineCap);
+    s.lineJoin = LineJoin(r.lineJoin);
+}
+
+} // namespace
+
+SceneFile::~SceneFile()
+{
+    close();
+}
+
+bool SceneFile::save(const QString& path, const SceneSnapshot& scene, QString* error)
+{
+    Columns c;
+    c.records.reserve(scene.size());
+    scene.forEach([&c](const Shape& s) { c.append(s); });
+    return writeFile(path, scene.canvasSize(), scene.background(), c, error);
+}
+
+bool SceneFile::save(const QString& path, const DrawEngine& engine, QRgb background, QString* error)
+{
+    Columns c;
+    c.records.reserve(engine.shapeCount());
+    for (const auto& s : engine.getShapes())
+        c.append(*s);
+    return writeFile(path, engine.getCanvas().size(), background, c, error);
+}
+
+bool SceneFile::open(const QString& path, QString* error)
+{
+    close();
+#if Q_BYTE_ORDER != Q_LITTLE_ENDIAN
+    if (error) *error = "binary scene files require a little-endian host";
+    return false;
+#endif
+
+    file.setFileName(path);
+    if (!file.open(QIODevice::ReadOnly))
+    {
+        if (error) *error = QString("cannot open %1").arg(path);
+        return false;
+    }
+    const qint64 size = file.size();
+    if (size < qint64(sizeof(Header)))
+    {
+        if (error) *error = QString("%1: not a scene file").arg(path);
+        file.close();
+        return false;
+    }
+
+    base = file.map(0, size);
+    if (!base)
+    {
+        if (error) *error = QString("cannot map %1").arg(path);
+        file.close();
+        return false;
+    }
+    header = reinterpret_cast<const Header*>(base);
+
+    if (!validate(size, error))
+    {
+        close();
+        return false;
+    }
+    return true;
+}
+
+void SceneFile::close()
+{
+    if (base)
+        file.unmap(const_cast<uchar*>(base));
+    base = nullptr;
+    header = nullptr;
+    if (file.isOpen())
+        file.close();
+}
+
+/**
+ * @brief 校验头部与记录表
+ * 扫描定长记录（每条 40 字节）；点与扫描段数组不读取，保持只在使用时才触发缺页，
+ * 只有圆弧 / 椭圆 / 七巧板的少量实数在这里检查（有限、转 int 不溢出）
+ */
+bool SceneFile::validate(qint64 size, QString* error) const
+{
+    auto fail = [error](const QString& why) {
+        if (error) *error = why;
+        return false;
+    };
+
+    if (header->magic != MAGIC)
+        return fail("not a scene file");
+    if (header->version != VERSION)
+        return fail(QString("unsupported scene file version %1").arg(header->version));
+    if (header->headerSize < sizeof(Header))
+        return fail("truncated header");
+    if (!arrayFits(header->recordsOffset, header->recordCount, sizeof(Record), size)
+        || !arrayFits(header->pointsOffset, header->pointCount, sizeof(QPoint), size)
+        || !arrayFits(header->spansOffset, header->spanCount, sizeof(RasterFillShape::Span), size)
+        || !arrayFits(header->realsOffset, header->realCount, sizeof(double), size))
+        return fail("array out of file bounds");
+
+    const Record* r = records();
+    for (quint64 i = 0; i < header->recordCount; ++i, ++r)
+    {
+        bool ok = r->lineStyle <= quint8(LineStyle::DashDot)
+                  && r->lineCap <= quint8(LineCap::Round)
+                  && r->lineJoin <= quint8(LineJoin::Round)
+                  && SceneIO::penWidthValid(r->penWidth);
+        switch (ShapeKind(r->kind))
+        {
+        case ShapeKind::Line:
+            ok = ok && r->count == 2 && rangeFits(r->first, r->count, header->pointCount);
+            break;
+        case ShapeKind::Polygon:
+            ok = ok && rangeFits(r->first, r->count, header->pointCount);
+            break;
+        case ShapeKind::RasterFill:
+            ok = ok && rangeFits(r->first, r->count, header->spanCount);
+            break;
+        case ShapeKind::Arc:
+            ok = ok && r->count == ARC_REALS && rangeFits(r->first, r->count, header->realCount)
+                 && realsValid(ShapeKind::Arc, reals() + r->first);
+            break;
+        case ShapeKind::Ellipse:
+            ok = ok && r->count == ELLIPSE_REALS && (r->flags & (Pie | Chord)) != (Pie | Chord)
+                 && rangeFits(r->first, r->count, header->realCount)
+                 && realsValid(ShapeKind::Ellipse, reals() + r->first);
+            break;
+        case ShapeKind::TangramPiece:
+            ok = ok && r->count == TANGRAM_REALS && r->piece <= quint8(TangramPieceType::Parallelogram)
+                 && rangeFits(r->first, r->count, header->realCount)
+                 && realsValid(ShapeKind::TangramPiece, reals() + r->first);
+            break;
+        default:
+            ok = false;
+            break;
+        }
+        if (!ok)
+            return fail(QString("record %1 is invalid").arg(i));
+    }
+    return true;
+}
+
+/**
+ * @brief 校验直线 / 多边形的点与种子填充的扫描段
+ * 区间已由 validate() 保证不越界，这里检查内容；只在 loadInto 时读取这两个数组
+ */
+bool SceneFile::validateGeometry(QString* error) const
+{
+    const Record* r = records();
+    for (quint64 i = 0; i < header->recordCount; ++i, ++r)
+    {
+        bool ok = true;
+        switch (ShapeKind(r->kind))
+        {
+        case ShapeKind::Line:
+        case ShapeKind::Polygon:
+            ok = pointsValid(points() + r->first, r->count);
+            break;
+        case ShapeKind::RasterFill:
+            ok = spansValid(spans() + r->first, r->count);
+            break;
+        default:
+            break;
+        }
+        if (!ok)
+        {
+            if (error) *error = QString("record %1 has invalid geometry").arg(i);
+            return false;
+        }
+    }
+    return true;
+}
+
+bool SceneFile::loadInto(DrawEngine& engine, QString* error) const
+{
+    if (!isOpen())
+    {
+        if (error) *error = "scene file is not open";
+        return false;
+    }
+    if (!validateGeometry(error))
+        return false;
+
+    const Record* recs = records();
+    const std::size_t n = recordCount();
+
+    // 整个画布重绘一次，逐个加入时不再合并脏矩形
+    engine.invalidateAll();
+
+    const QPoint* pts = points();
+    const RasterFillShape::Span* sp = spans();
+    const double* re = reals();
+    for (std::size_t i = 0; i < n; ++i)
+    {
+        const Record& r = recs[i];
+        std::shared_ptr<Shape> s;
+
+        switch (ShapeKind(r.kind))
+        {
+        case ShapeKind::Line:
+        {
+            auto line = std::make_shared<LineShape>();
+            line->setEndpoints(pts[r.first], pts[r.first + 1]);
+            line->antialiased = (r.flags & Antialiased) != 0;
+            s = line;
+            break;
+        }
+        case ShapeKind::Arc:
+        {
+            auto arc = std::make_shared<ArcShape>();
+            const double* a = re + r.first;
+            arc->center = QPoint(int(a[0]), int(a[1]));
+            arc->radius = int(a[2]);
+            arc->startAngle = a[3];
+            arc->endAngle = a[4];
+            arc->matrix = QTransform(a[5], a[6], a[7], a[8], a[9], a[10]);
+            s = arc;
+            break;
+        }
+        case ShapeKind::Ellipse:
+        {
+            auto ellipse = std::make_shared<EllipseShape>();
+            const double* a = re + r.first;
+            ellipse->center = QPoint(int(a[0]), int(a[1]));
+            ellipse->radiusX = int(a[2]);
+            ellipse->radiusY = int(a[3]);
+            ellipse->startAngle = a[4];
+            ellipse->endAngle = a[5];
+            ellipse->matrix = QTransform(a[6], a[7], a[8], a[9], a[10], a[11]);
+            ellipse->form = (r.flags & Pie) ? EllipseShape::Form::Pie
+                            : (r.flags & Chord) ? EllipseShape::Form::Chord : EllipseShape::Form::Ellipse;
+            ellipse->filled = (r.flags & Filled) != 0;
+            ellipse->fillColor = QColor::fromRgba(r.fillColor);
+            s = ellipse;
+            break;
+        }
+        case ShapeKind::Polygon:
+        {
+            auto poly = std::make_shared<PolygonShape>();
+            poly->setVertices(std::vector<QPoint>(pts + r.first, pts + r.first + r.count));
+            poly->filled = (r.flags & Filled) != 0;
+            poly->fillColor = QColor::fromRgba(r.fillColor);
+            s = poly;
+            break;
+        }
+        case ShapeKind::RasterFill:
+        {
+            auto fill = std::make_shared<RasterFillShape>();
+            fill->spans.assign(sp + r.first, sp + r.first + r.count);
+            s = fill;
+            break;
+        }
+        case ShapeKind::TangramPiece:
+        {
+            const TangramPieceType type = TangramPieceType(r.piece);
+            auto piece = std::make_shared<TangramPiece>(type, TangramGame::basePolygon(type));
+            const double* a = re + r.first;
+            piece->setPose({QPointF(a[0], a[1]), a[2], (r.flags & Flipped) != 0});
+            piece->filled = (r.flags & Filled) != 0;
+            piece->fillColor = QColor::fromRgba(r.fillColor);
+            s = piece;
+            break;
+        }
+        }
+
+        applyStyle(r, *s);
+        engine.addShapeAt(std::move(s), r.zOrder);
+    }
+    return true;
+}
@@ -0,0 +1,121 @@
+#ifndef SCENEFILE_H
+#define SCENEFILE_H
+
+#include "rasterfillshape.h"
+#include <QFile>
+#include <QPoint>
+#include <QSize>
+#include <QRgb>
+#include <QString>
+#include <cstddef>
+
+class DrawEngine;
+class SceneSnapshot;
+
+/**
+ * @brief SceneFile —— 二进制场景文件（.gscene）
+ *
+ * 文件布局（小端；各数组起点按 8 字节对齐，映射到内存后可以原地使用）：
+ *  - Header：魔数 "GSCN"、版本、画布尺寸与背景色、四个数组的元素个数与文件内偏移
+ *  - records：每个图元一条定长 Record，按绘制顺序排列，保存绘制序号、样式与几何在数组中的区间
+ *  - points：QPoint（两个 qint32）数组 —— 直线的两个端点、多边形的顶点
+ *  - spans：RasterFillShape::Span（y, x0, x1）数组 —— 种子填充区域
+ *  - reals：double 数组 —— 圆弧 [cx, cy, r, start, end, m11, m12, m21, m22, dx, dy]，
+ *    椭圆 [cx, cy, rx, ry, start, end, m11, m12, m21, m22, dx, dy]，七巧板姿态 [x, y, rotation]
+ *
+ * open() 用 QFile::map() 映射整个文件，只校验头部与记录表（类型、枚举值、笔宽 1..64 与数组区间不越界；
+ * 圆弧 / 椭圆 / 七巧板的实数须有限、圆心与半径能安全转为 int），
+ * 点与扫描段数组不做任何解析：points() / spans() / reals() 直接指向映射内存
+ * loadInto() 先检查点与扫描段（坐标在 ±2^20 内、扫描段按 y / x0 升序且 x0 <= x1），再按记录逐个 make_shared
+ * 重建图元，每个图元有独立的生命周期；检查放在这里而不是 open()，打开文件时仍不触碰这两个数组
+ */
+class SceneFile
+{
+public:
+    static constexpr quint32 MAGIC = 0x4e435347;                        // "GSCN"
+    static constexpr quint16 VERSION = 1;
+
+    enum RecordFlag : quint8
+    {
+        Filled = 1,                                                     // 多边形 / 椭圆 / 七巧板拼块填充
+        Flipped = 2,                                                    // 七巧板拼块镜像
+        Antialiased = 4,                                                // 直线使用 Wu 抗锯齿细线
+        Pie = 8,                                                        // 椭圆为扇形
+        Chord = 16                                                      // 椭圆为弓形
+    };
+
+    struct Header
+    {
+        quint32 magic;
+        quint16 version;
+        quint16 headerSize;
+        qint32 width;
+        qint32 height;
+        QRgb background;
+        quint32 reserved;
+        quint64 recordCount, recordsOffset;
+        quint64 pointCount, pointsOffset;
+        quint64 spanCount, spansOffset;
+        quint64 realCount, realsOffset;
+    };
+
+    struct Record
+    {
+        qint64 zOrder;
+        quint32 first;                                                  // 几何在 points / spans / reals 中的起始下标
+        quint32 count;                                                  // 元素个数
+        QRgb color;
+        QRgb fillColor;
+        qint32 penWidth;
+        qint32 dashOffset;
+        quint8 kind;                                                    // ShapeKind
+        quint8 lineStyle;
+        quint8 lineCap;
+        quint8 lineJoin;
+        quint8 flags;                                                   // RecordFlag
+        quint8 piece;                                                   // TangramPieceType
+        quint8 reserved[2];
+    };
+
+    SceneFile() = default;
+    ~SceneFile();
+    SceneFile(const SceneFile&) = delete;
+    SceneFile& operator=(const SceneFile&) = delete;
+
+    // 写出快照 / 引擎中的全部图元（按绘制顺序）
+    static bool save(const QString& path, const SceneSnapshot& scene, QString* error = nullptr);
+    static bool save(const QString& path, const DrawEngine& engine, QRgb background, QString* error = nullptr);
+
+    // 映射并校验文件；失败时 error 给出原因
+    bool open(const QString& path, QString* error = nullptr);
+    void close();
+    bool isOpen() const { return header != nullptr; }
+
+    QSize canvasSize() const { return QSize(header->width, header->height); }
+    QRgb background() const { return header->background; }
+
+    std::size_t recordCount() const { return std::size_t(header->recordCount); }
+    const Record* records() const { return at<Record>(header->recordsOffset); }
+    std::size_t pointCount() const { return std::size_t(header->pointCount); }
+    const QPoint* points() const { return at<QPoint>(header->pointsOffset); }
+    std::size_t spanCount() const { return std::size_t(header->spanCount); }
+    const RasterFillShape::Span* spans() const { return at<RasterFillShape::Span>(header->spansOffset); }
+    std::size_t realCount() const { return std::size_t(header->realCount); }
+    const double* reals() const { return at<double>(header->realsOffset); }
+
+    // 按记录重建图元并以原绘制序号加入 engine；点或扫描段不合法时不加入任何图元，返回 false（error 给出原因）
+    bool loadInto(DrawEngine& engine, QString* error = nullptr) const;
+
+private:
+    template <class T>
+    const T* at(quint64 offset) const { return reinterpret_cast<const T*>(base + offset); }
+
+    bool validate(qint64 size, QString* error) const;
+    bool validateGeometry(QString* error) const;
+
+    QFile file;
+    const uchar* base = nullptr;
+    const Header* header = nullptr;
+};
+
+#endif // SCENEFILE_H
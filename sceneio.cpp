@@ -0,0 +1,524 @@
+#include "sceneio.h"
+#include "drawengine.h"
+#include "lineshape.h"
+#include "arcshape.h"
+#include "ellipseshape.h"
+#include "polygonshape.h"
+#include "rasterfillshape.h"
+#include "tangrampiece.h"
+#include "tangramgame.h"
+#include "scenesnapshot.h"
+
+#include <QFile>
+#include <QJsonDocument>
+#include <QJsonArray>
+#include <QTransform>
+#include <cmath>
+
+namespace {
+
+QString styleName(LineStyle s)
+{
+    switch (s) {
+    case LineStyle::Solid:   return "Solid";
+    case LineStyle::Dash:    return "Dash";
+    case LineStyle::Dot:     return "Dot";
+    case LineStyle::DashDot: return "DashDot";
+    }
+    return "Solid";
+}
+
+LineStyle styleFromName(const QString& s)
+{
+    if (s == "Dash")    return LineStyle::Dash;
+    if (s == "Dot")     return LineStyle::Dot;
+    if (s == "DashDot") return LineStyle::DashDot;
+    return LineStyle::Solid;
+}
+
+QString capName(LineCap c)
+{
+    switch (c) {
+    case LineCap::Flat:   return "Flat";
+    case LineCap::Square: return "Square";
+    case LineCap::Round:  return "Round";
+    }
+    return "Round";
+}
+
+LineCap capFromName(const QString& s)
+{
+    if (s == "Flat")   return LineCap::Flat;
+    if (s == "Square") return LineCap::Square;
+    return LineCap::Round;
+}
+
+QString joinName(LineJoin j)
+{
+    switch (j) {
+    case LineJoin::Miter: return "Miter";
+    case LineJoin::Bevel: return "Bevel";
+    case LineJoin::Round: return "Round";
+    }
+    return "Round";
+}
+
+LineJoin joinFromName(const QString& s)
+{
+    if (s == "Miter") return LineJoin::Miter;
+    if (s == "Bevel") return LineJoin::Bevel;
+    return LineJoin::Round;
+}
+
+// 公共样式字段（color 由调用者处理：ArcShape 使用自己的 color 成员）
+void writeStyle(const Shape& s, QJsonObject& o)
+{
+    o["width"] = s.penWidth;
+    o["style"] = styleName(s.lineStyle);
+    o["cap"] = capName(s.lineCap);
+    o["join"] = joinName(s.lineJoin);
+    o["dashOffset"] = s.dashOffset;
+}
+
+bool finite(double v)
+{
+    return std::isfinite(v);
+}
+
+// 数值字段按 double 读出并检查范围后再使用；记下第一个不合法的字段，shapeFromJson 据此报错
+struct FieldReader
+{
+    const QJsonObject& o;
+    QString bad;
+
+    bool check(bool ok, const QString& key)
+    {
+        if (!ok && bad.isEmpty()) bad = key;
+        return ok;
+    }
+
+    double number(const QString& key, bool (*valid)(double), double def = 0)
+    {
+        const double v = o[key].toDouble(def);
+        return check(valid(v), key) ? v : def;
+    }
+
+    std::vector<QPoint> points(const QString& key)
+    {
+        const QJsonArray arr = o[key].toArray();
+        std::vector<QPoint> pts;
+        pts.reserve(arr.size() / 2);
+        for (int i = 0; i + 1 < arr.size(); i += 2)
+        {
+            const double x = arr[i].toDouble(), y = arr[i + 1].toDouble();
+            if (!check(SceneIO::coordValid(x) && SceneIO::coordValid(y), key))
+                break;
+            pts.emplace_back(qRound(x), qRound(y));
+        }
+        return pts;
+    }
+
+    // "matrix":[m11, m12, m21, m22, dx, dy]，没有该字段时保持 m 不变
+    void matrix(QTransform& m)
+    {
+        const QJsonArray a = o["matrix"].toArray();
+        if (a.size() != 6) return;
+        const QTransform t(a[0].toDouble(), a[1].toDouble(), a[2].toDouble(),
+                           a[3].toDouble(), a[4].toDouble(), a[5].toDouble());
+        if (check(SceneIO::matrixValid(t), "matrix"))
+            m = t;
+    }
+};
+
+void readStyle(FieldReader& in, Shape& s)
+{
+    s.penWidth = qRound(in.number("width", SceneIO::penWidthValid, 1));
+    s.lineStyle = styleFromName(in.o["style"].toString());
+    s.lineCap = capFromName(in.o["cap"].toString());
+    s.lineJoin = joinFromName(in.o["join"].toString());
+    s.dashOffset = qRound(in.number("dashOffset", SceneIO::coordValid));
+}
+
+QJsonArray pointsToJson(const std::vector<QPoint>& pts)
+{
+    QJsonArray arr;
+    for (const QPoint& p : pts) {
+        arr.append(p.x());
+        arr.append(p.y());
+    }
+    return arr;
+}
+
+const char* const FORM_NAMES[] = {"ellipse", "pie", "chord"};
+
+const char* const PIECE_NAMES[] = {
+    "LargeA", "LargeB", "Medium", "Square", "SmallA", "SmallB", "Parallelogram"
+};
+
+} // namespace
+
+bool SceneIO::coordValid(double v)
+{
+    return std::isfinite(v) && v >= -MAX_COORD && v <= MAX_COORD;
+}
+
+bool SceneIO::radiusValid(double v)
+{
+    return std::isfinite(v) && v >= 0 && v <= MAX_COORD;
+}
+
+bool SceneIO::penWidthValid(double w)
+{
+    return std::isfinite(w) && w >= 1 && w <= MAX_PEN_WIDTH;
+}
+
+bool SceneIO::matrixValid(const QTransform& m)
+{
+    return std::isfinite(m.m11()) && std::isfinite(m.m12()) && std::isfinite(m.m21())
+           && std::isfinite(m.m22()) && std::isfinite(m.dx()) && std::isfinite(m.dy());
+}
+
+const char* SceneIO::tangramPieceName(TangramPieceType type)
+{
+    return PIECE_NAMES[static_cast<int>(type)];
+}
+
+bool SceneIO::tangramPieceFromName(const QString& name, TangramPieceType* out)
+{
+    for (int i = 0; i < 7; ++i)
+    {
+        if (name == PIECE_NAMES[i]) {
+            *out = static_cast<TangramPieceType>(i);
+            return true;
+        }
+    }
+    return false;
+}
+
+QJsonObject SceneIO::shapeToJson(const Shape& s)
+{
+    QJsonObject o;
+
+    switch (s.kind())
+    {
+    case ShapeKind::Line:
+    {
+        auto line = static_cast<const LineShape*>(&s);
+        o["type"] = "line";
+        const QPoint a = line->startPoint(), b = line->endPoint();
+        o["x0"] = a.x();
+        o["y0"] = a.y();
+        o["x1"] = b.x();
+        o["y1"] = b.y();
+        o["color"] = line->color.name();
+        if (line->antialiased)
+            o["antialiased"] = true;
+        break;
+    }
+    case ShapeKind::Arc:
+    {
+        auto arc = static_cast<const ArcShape*>(&s);
+        o["type"] = "arc";
+        o["cx"] = arc->center.x();
+        o["cy"] = arc->center.y();
+        o["r"] = arc->radius;
+        o["start"] = arc->startAngle;
+        o["end"] = arc->endAngle;
+        o["color"] = arc->color.name();
+        if (!arc->matrix.isIdentity())                                  // 累积变换 [m11, m12, m21, m22, dx, dy]
+            o["matrix"] = QJsonArray{arc->matrix.m11(), arc->matrix.m12(),
+                                     arc->matrix.m21(), arc->matrix.m22(),
+                                     arc->matrix.dx(), arc->matrix.dy()};
+        break;
+    }
+    case ShapeKind::Ellipse:
+    {
+        auto ellipse = static_cast<const EllipseShape*>(&s);
+        o["type"] = "ellipse";
+        o["cx"] = ellipse->center.x();
+        o["cy"] = ellipse->center.y();
+        o["rx"] = ellipse->radiusX;
+        o["ry"] = ellipse->radiusY;
+        o["form"] = FORM_NAMES[static_cast<int>(ellipse->form)];
+        if (ellipse->form != EllipseShape::Form::Ellipse)
+        {
+            o["start"] = ellipse->startAngle;
+            o["end"] = ellipse->endAngle;
+        }
+        o["filled"] = ellipse->filled;
+        o["fill"] = ellipse->fillColor.name();
+        o["color"] = ellipse->color.name();
+        if (!ellipse->matrix.isIdentity())
+            o["matrix"] = QJsonArray{ellipse->matrix.m11(), ellipse->matrix.m12(),
+                                     ellipse->matrix.m21(), ellipse->matrix.m22(),
+                                     ellipse->matrix.dx(), ellipse->matrix.dy()};
+        break;
+    }
+    case ShapeKind::TangramPiece:
+    {
+        auto piece = static_cast<const TangramPiece*>(&s);
+        TangramPose pose = piece->pose();
+        o["type"] = "tangram";
+        o["piece"] = tangramPieceName(piece->pieceType());
+        o["x"] = pose.position.x();
+        o["y"] = pose.position.y();
+        o["rotation"] = pose.rotationDeg;
+        o["flipped"] = pose.flipped;
+        o["color"] = piece->color.name();
+        o["fill"] = piece->fillColor.name();
+        break;
+    }
+    case ShapeKind::Polygon:
+    {
+        auto poly = static_cast<const PolygonShape*>(&s);
+        o["type"] = "polygon";
+        o["points"] = pointsToJson(poly->vertices());
+        o["filled"] = poly->filled;
+        o["fill"] = poly->fillColor.name();
+        o["color"] = poly->color.name();
+        break;
+    }
+    case ShapeKind::RasterFill:
+    {
+        auto fill = static_cast<const RasterFillShape*>(&s);
+        // 区间按 [y, x0, x1] 三元组依次展开
+        QJsonArray spans;
+        for (const RasterFillShape::Span& sp : fill->spans)
+        {
+            spans.append(sp.y);
+            spans.append(sp.x0);
+            spans.append(sp.x1);
+        }
+        o["type"] = "fill";
+        o["spans"] = spans;
+        o["color"] = fill->color.name();
+        break;
+    }
+    default:
+        return o;                                                       // 未知类型：空对象，调用者跳过
+    }
+
+    writeStyle(s, o);
+    return o;
+}
+
+std::shared_ptr<Shape> SceneIO::shapeFromJson(const QJsonObject& o, QString* error)
+{
+    const QString type = o["type"].toString();
+    std::shared_ptr<Shape> result;
+    FieldReader in{o, QString()};
+    auto coord = [&in](const char* key) { return qRound(in.number(key, SceneIO::coordValid)); };
+    auto radius = [&in](const char* key) { return qRound(in.number(key, SceneIO::radiusValid)); };
+
+    if (type == "line")
+    {
+        auto line = std::make_shared<LineShape>();
+        line->setEndpoints(QPoint(coord("x0"), coord("y0")), QPoint(coord("x1"), coord("y1")));
+        line->color = QColor(o["color"].toString("#000000"));
+        line->antialiased = o["antialiased"].toBool(false);
+        result = line;
+    }
+    else if (type == "arc")
+    {
+        auto arc = std::make_shared<ArcShape>(QPoint(coord("cx"), coord("cy")), radius("r"),
+                                              in.number("start", finite), in.number("end", finite),
+                                              QColor(o["color"].toString("#000000")));
+        in.matrix(arc->matrix);
+        result = arc;
+    }
+    else if (type == "ellipse")
+    {
+        auto ellipse = std::make_shared<EllipseShape>(QPoint(coord("cx"), coord("cy")),
+                                                      radius("rx"), radius("ry"),
+                                                      QColor(o["color"].toString("#000000")));
+        const QString form = o["form"].toString(FORM_NAMES[0]);
+        for (int i = 0; i < 3; ++i)
+        {
+            if (form == FORM_NAMES[i])
+                ellipse->form = static_cast<EllipseShape::Form>(i);
+        }
+        ellipse->startAngle = in.number("start", finite, 0);
+        ellipse->endAngle = in.number("end", finite, 360);
+        ellipse->filled = o["filled"].toBool(false);
+        ellipse->fillColor = QColor(o["fill"].toString("#ffffff"));
+        in.matrix(ellipse->matrix);
+        result = ellipse;
+    }
+    else if (type == "polygon")
+    {
+        auto poly = std::make_shared<PolygonShape>(in.points("points"));
+        poly->filled = o["filled"].toBool(false);
+        poly->fillColor = QColor(o["fill"].toString("#ffffff"));
+        poly->color = QColor(o["color"].toString("#000000"));
+        result = poly;
+    }
+    else if (type == "fill")
+    {
+        std::vector<RasterFillShape::Span> spans;
+        QJsonArray arr = o["spans"].toArray();
+        spans.reserve(arr.size() / 3);
+        for (int i = 0; i + 2 < arr.size(); i += 3)
+        {
+            const double y = arr[i].toDouble(), x0 = arr[i + 1].toDouble(), x1 = arr[i + 2].toDouble();
+            if (!in.check(SceneIO::coordValid(y) && SceneIO::coordValid(x0) && SceneIO::coordValid(x1), "spans"))
+                break;
+            if (x0 <= x1)
+                spans.push_back({qRound(y), qRound(x0), qRound(x1)});
+        }
+        result = std::make_shared<RasterFillShape>(std::move(spans), QColor(o["color"].toString("#000000")));
+    }
+    else if (type == "tangram")
+    {
+        TangramPieceType pt;
+        if (!tangramPieceFromName(o["piece"].toString(), &pt))
+        {
+            if (error) *error = QString("unknown tangram piece '%1'").arg(o["piece"].toString());
+            return nullptr;
+        }
+        auto piece = std::make_shared<TangramPiece>(pt, TangramGame::basePolygon(pt));
+        piece->setPose({QPointF(in.number("x", SceneIO::coordValid), in.number("y", SceneIO::coordValid)),
+                        in.number("rotation", finite), o["flipped"].toBool()});
+        piece->color = QColor(o["color"].toString("#000000"));
+        if (o.contains("fill"))
+            piece->fillColor = QColor(o["fill"].toString());
+        result = piece;
+    }
+    else
+    {
+        if (error) *error = QString("unknown shape type '%1'").arg(type);
+        return nullptr;
+    }
+
+    readStyle(in, *result);
+    if (!in.bad.isEmpty())
+    {
+        if (error) *error = QString("invalid value for '%1'").arg(in.bad);
+        return nullptr;
+    }
+    return result;
+}
+
+bool SceneIO::loadJsonLines(const QString& path, DrawEngine& engine,
+                            SceneHeader* header, QString* error, const Progress& progress)
+{
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly | QIODevice::Text))
+    {
+        if (error) *error = QString("cannot open %1").arg(path);
+        return false;
+    }
+
+    // 整张画布一次标脏，逐个加入的图元不再各自合并脏矩形
+    engine.invalidateAll();
+
+    const qint64 total = file.size();
+    int lineNo = 0;
+    while (!file.atEnd())
+    {
+        QByteArray line = file.readLine().trimmed();
+        ++lineNo;
+        if (progress && lineNo % PROGRESS_STEP == 0 && !progress(file.pos(), total))
+        {
+            if (error) *error = "cancelled";
+            return false;
+        }
+        if (line.isEmpty() || line.startsWith('#')) continue;
+
+        QJsonParseError perr;
+        QJsonDocument doc = QJsonDocument::fromJson(line, &perr);
+        if (perr.error != QJsonParseError::NoError || !doc.isObject())
+        {
+            if (error) *error = QString("line %1: %2").arg(lineNo).arg(perr.errorString());
+            return false;
+        }
+
+        QJsonObject obj = doc.object();
+        if (obj.contains("format"))
+        {
+            if (header)
+            {
+                header->size = QSize(obj["width"].toInt(800), obj["height"].toInt(600));
+                header->background = QColor(obj["background"].toString("#ffffff"));
+            }
+            continue;
+        }
+
+        QString why;
+        auto shape = shapeFromJson(obj, &why);
+        if (!shape)
+        {
+            if (error) *error = QString("line %1: %2").arg(lineNo).arg(why);
+            return false;
+        }
+        engine.addShape(shape);
+    }
+    if (progress) progress(total, total);
+    return true;
+}
+
+namespace {
+
+// 场景头 + forEachShape 依次给出的图元
+template <class ForEachShape>
+bool writeJsonLines(const QString& path, const QSize& size, const QColor& background, qint64 count,
+                    ForEachShape forEachShape, QString* error, const SceneIO::Progress& progress)
+{
+    QFile file(path);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate | QIODevice::Text))
+    {
+        if (error) *error = QString("cannot write %1").arg(path);
+        return false;
+    }
+
+    QJsonObject head;
+    head["format"] = "graphic-scene";
+    head["version"] = 1;
+    head["width"] = size.width();
+    head["height"] = size.height();
+    head["background"] = background.name();
+    file.write(QJsonDocument(head).toJson(QJsonDocument::Compact));
+    file.write("\n");
+
+    qint64 written = 0;
+    bool cancelled = false;
+    forEachShape([&](const Shape& s) {
+        if (cancelled) return;
+        if (progress && ++written % SceneIO::PROGRESS_STEP == 0 && !progress(written, count))
+        {
+            cancelled = true;
+            return;
+        }
+        QJsonObject o = SceneIO::shapeToJson(s);
+        if (o.isEmpty()) return;
+        file.write(QJsonDocument(o).toJson(QJsonDocument::Compact));
+        file.write("\n");
+    });
+    if (cancelled)
+    {
+        if (error) *error = "cancelled";
+        return false;
+    }
+    if (progress) progress(count, count);
+    return true;
+}
+
+} // namespace
+
+bool SceneIO::saveJsonLines(const QString& path, const DrawEngine& engine,
+                            const QColor& background, QString* error, const Progress& progress)
+{
+    return writeJsonLines(path, engine.getCanvas().size(), background, qint64(engine.shapeCount()),
+                          [&engine](auto write) {
+                              for (const auto& s : engine.getShapes())
+                                  write(*s);
+                          },
+                          error, progress);
+}
+
+bool SceneIO::saveJsonLines(const QString& path, const SceneSnapshot& scene, QString* error,
+                            const Progress& progress)
+{
+    return writeJsonLines(path, scene.canvasSize(), QColor::fromRgb(scene.background()), qint64(scene.size()),
+                          [&scene](auto write) { scene.forEach(write); },
+                          error, progress);
+}
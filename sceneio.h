@@ -0,0 +1,78 @@
+#ifndef SCENEIO_H
+#define SCENEIO_H
+
+#include <QString>
+#include <QColor>
+#include <QSize>
+#include <QJsonObject>
+#include <functional>
+#include <memory>
+
+class DrawEngine;
+class Shape;
+class QTransform;
+class SceneSnapshot;
+enum class TangramPieceType;
+
+/**
+ * @brief SceneIO —— 场景的逐行 JSON（JSON Lines）读写
+ *
+ * 文件格式：每行一个 JSON 对象
+ *  - 第一行（可选）为场景头：
+ *      {"format":"graphic-scene","version":1,"width":800,"height":600,"background":"#ffffff"}
+ *  - 其余每行一个图元（公共样式字段 width / style / cap / join / dashOffset），按 shapes 顺序（即绘制顺序）排列，"type" 字段区分类型：
+ *      line / arc / ellipse / polygon / fill / tangram
+ *    ellipse 字段：cx / cy / rx / ry / form（ellipse / pie / chord）/ filled / fill / color，
+ *    form 不是 ellipse 时另有 start / end（参数角，°）
+ *    arc 与 ellipse 的累积变换不是单位矩阵时带 "matrix":[m11, m12, m21, m22, dx, dy]
+ *  - 数值超出读入范围（见 coordValid / radiusValid / penWidthValid）的行按错误处理，不做截断
+ *
+ * 逐行解析、逐个图元写出，不需要一次把整个文件读入内存，供无界面的批量渲染与基准测试使用
+ * 写出 SceneSnapshot 的版本可以在工作线程上运行（自动保存、导出），不阻塞界面线程的编辑
+ */
+namespace SceneIO
+{
+    struct SceneHeader
+    {
+        QSize size = QSize(800, 600);
+        QColor background = Qt::white;
+    };
+
+    // 进度回调：done / total 为已处理的字节数或图元数；返回 false 时中止读写（error 为 "cancelled"）
+    // 每处理 PROGRESS_STEP 个图元以及结束时各调用一次
+    using Progress = std::function<bool(qint64 done, qint64 total)>;
+    constexpr int PROGRESS_STEP = 4096;
+
+    // 读入数值的范围，.gscene / .jsonl / .svg 三个读入路径共用：
+    // 超出 int 的 double 转换是未定义行为，过大的坐标、半径与笔宽还会让光栅化的整数运算溢出
+    constexpr int MAX_PEN_WIDTH = 64;                                   // 界面笔宽为 1..20
+    constexpr double MAX_COORD = 1 << 20;                               // 坐标与半径的绝对值上限
+    bool coordValid(double v);                                          // 有限且在 ±MAX_COORD 内
+    bool radiusValid(double v);                                         // 有限且在 [0, MAX_COORD] 内
+    bool penWidthValid(double w);                                       // 有限且在 [1, MAX_PEN_WIDTH] 内
+    bool matrixValid(const QTransform& m);                              // 六个系数都有限
+
+    // 七巧板拼块类型 <-> 名称（"LargeA" …），JSON 与 SVG 的 piece 字段共用
+    const char* tangramPieceName(TangramPieceType type);
+    bool tangramPieceFromName(const QString& name, TangramPieceType* out);
+
+    // 图元 <-> JSON 对象
+    QJsonObject shapeToJson(const Shape& s);
+    std::shared_ptr<Shape> shapeFromJson(const QJsonObject& obj, QString* error = nullptr);
+
+    // 读取场景：图元依次 addShape 到 engine；header 非空时返回场景头
+    // 返回 false 表示文件无法打开或存在无法解析的行（error 给出行号与原因）
+    bool loadJsonLines(const QString& path, DrawEngine& engine,
+                       SceneHeader* header = nullptr, QString* error = nullptr,
+                       const Progress& progress = Progress());
+
+    // 写出场景（场景头 + 全部图元）
+    bool saveJsonLines(const QString& path, const DrawEngine& engine,
+                       const QColor& background = Qt::white, QString* error = nullptr,
+                       const Progress& progress = Progress());
+    // 写出快照（画布尺寸与背景色取自快照）
+    bool saveJsonLines(const QString& path, const SceneSnapshot& scene, QString* error = nullptr,
+                       const Progress& progress = Progress());
+}
+
+#endif // SCENEIO_H
@@ -0,0 +1,146 @@
+#include "scenesnapshot.h"
+#include "drawengine.h"
+
+#include <algorithm>
+
+void SceneSnapshot::drawTo(DrawEngine& target) const
+{
+    if (!data) return;
+    for (const auto& chunk : data->chunks)
+        for (const auto& s : *chunk)
+            s->draw(&target);
+}
+
+QImage SceneSnapshot::render() const
+{
+    const QSize size = canvasSize();
+    if (size.isEmpty()) return QImage();
+
+    DrawEngine engine(size.width(), size.height(), QColor::fromRgb(background()));
+    drawTo(engine);
+    return engine.getCanvas();
+}
+
+/**
+ * @brief 整体重建块表
+ * ordered 与上一快照都按 zOrder 升序，归并扫描即可找到仍在原位置的图元：
+ * 没有过期标记、zOrder 与 id 都相同的沿用旧副本，其余重新克隆
+ */
+SceneSnapshot SceneSnapshot::rebuild(const SceneSnapshot& previous,
+                                     const std::vector<std::shared_ptr<Shape>>& ordered,
+                                     const QSize& size, QRgb background)
+{
+    auto d = std::make_shared<Data>();
+    d->count = ordered.size();
+    d->size = size;
+    d->background = background;
+    d->chunks.reserve((ordered.size() + CHUNK_SIZE - 1) / CHUNK_SIZE);
+
+    const std::size_t oldCount = previous.size();
+    std::size_t oldIndex = 0;
+    std::shared_ptr<Chunk> chunk;
+
+    for (const auto& s : ordered)
+    {
+        std::shared_ptr<Shape> frozen;
+        if (!s->snapshotStale)
+        {
+            while (oldIndex < oldCount && previous.entry(oldIndex)->zOrder < s->zOrder)
+                ++oldIndex;
+            if (oldIndex < oldCount)
+            {
+                const std::shared_ptr<Shape>& old = previous.entry(oldIndex);
+                if (old->zOrder == s->zOrder && old->id == s->id)
+                    frozen = old;
+            }
+        }
+        if (!frozen)
+            frozen = s->clone();
+        s->snapshotStale = false;
+
+        if (!chunk)
+        {
+            chunk = std::make_shared<Chunk>();
+            chunk->reserve(CHUNK_SIZE);
+        }
+        chunk->push_back(std::move(frozen));
+        if (chunk->size() == CHUNK_SIZE)
+            d->chunks.push_back(std::move(chunk));
+    }
+    if (chunk)
+        d->chunks.push_back(std::move(chunk));
+
+    return SceneSnapshot(std::move(d));
+}
+
+/**
+ * @brief 增量发布：复制块表，只复制含改动图元的块
+ * 改动的图元在上一快照之后没有改变绘制序号（调整顺序会触发整体重建），按 zOrder 二分查找其位置
+ */
+bool SceneSnapshot::patch(const SceneSnapshot& previous,
+                          const std::vector<Shape*>& changed, const std::vector<Shape*>& appended,
+                          const QSize& size, QRgb background, SceneSnapshot& out)
+{
+    if (!previous.data) return false;
+
+    auto d = std::make_shared<Data>(*previous.data);
+    d->size = size;
+    d->background = background;
+
+    // 本次已复制（可写）的块
+    std::vector<std::shared_ptr<Chunk>> copies(d->chunks.size());
+    auto writable = [&](std::size_t c) -> Chunk& {
+        if (!copies[c])
+        {
+            copies[c] = std::make_shared<Chunk>(*d->chunks[c]);
+            d->chunks[c] = copies[c];
+        }
+        return *copies[c];
+    };
+
+    // 先定位全部改动的图元，任一找不到时不做任何修改
+    std::vector<std::pair<std::size_t, std::size_t>> positions;
+    positions.reserve(changed.size());
+    for (Shape* s : changed)
+    {
+        auto c = std::lower_bound(d->chunks.begin(), d->chunks.end(), s->zOrder,
+                                  [](const std::shared_ptr<const Chunk>& chunk, qint64 z) {
+                                      return chunk->back()->zOrder < z;
+                                  });
+        if (c == d->chunks.end()) return false;
+        auto it = std::lower_bound((*c)->begin(), (*c)->end(), s->zOrder,
+                                   [](const std::shared_ptr<Shape>& x, qint64 z) { return x->zOrder < z; });
+        if (it == (*c)->end() || (*it)->zOrder != s->zOrder || (*it)->id != s->id) return false;
+        positions.push_back({std::size_t(c - d->chunks.begin()), std::size_t(it - (*c)->begin())});
+    }
+
+    qint64 topZ = d->count ? previous.entry(d->count - 1)->zOrder : 0;
+    for (std::size_t i = 0; i < appended.size(); ++i)
+    {
+        if (d->count + i > 0 && appended[i]->zOrder <= topZ) return false;
+        topZ = appended[i]->zOrder;
+    }
+
+    for (std::size_t i = 0; i < changed.size(); ++i)
+    {
+        writable(positions[i].first)[positions[i].second] = changed[i]->clone();
+        changed[i]->snapshotStale = false;
+    }
+
+    for (Shape* s : appended)
+    {
+        if (d->chunks.empty() || d->chunks.back()->size() == CHUNK_SIZE)
+        {
+            auto chunk = std::make_shared<Chunk>();
+            chunk->reserve(CHUNK_SIZE);
+            d->chunks.push_back(chunk);
+            copies.push_back(chunk);
+        }
+        writable(d->chunks.size() - 1).push_back(s->clone());
+        s->snapshotStale = false;
+        ++d->count;
+    }
+
+    out = SceneSnapshot(std::move(d));
+    return true;
+}
@@ -0,0 +1,90 @@
+#ifndef SCENESNAPSHOT_H
+#define SCENESNAPSHOT_H
+
+#include "shape.h"
+#include <QImage>
+#include <QSize>
+#include <QRgb>
+#include <vector>
+#include <memory>
+#include <cstddef>
+
+/**
+ * @brief SceneSnapshot —— 某一时刻场景的只读快照（写时复制）
+ *
+ * 由 DrawEngine::snapshot() 生成。快照里的图元都是冻结的副本（Shape::clone()），
+ * 不属于任何引擎、发布后不再被修改，因此可以交给其它线程遍历（自动保存、导出、后台渲染），
+ * 与继续编辑场景的界面线程之间不需要任何锁
+ *
+ * 结构共享：
+ *  - 按绘制顺序排列的副本分成固定大小的块，块与块表都是不可变对象，快照本身只是一个 shared_ptr，复制为 O(1)
+ *  - 发布新快照时只克隆上一次之后改动过的图元，并只复制它们所在的块与块表；
+ *    未改动的块与副本由新旧快照共享，最后一个引用它们的快照释放时一起释放
+ */
+class SceneSnapshot
+{
+public:
+    static constexpr std::size_t CHUNK_SIZE = 256;                      // 每块的图元个数
+
+    // 空快照（没有图元）
+    SceneSnapshot() = default;
+
+    std::size_t size() const { return data ? data->count : 0; }
+    bool isEmpty() const { return size() == 0; }
+
+    // 第 i 个图元（按绘制顺序，底层在前）
+    const Shape& at(std::size_t i) const { return *entry(i); }
+
+    // 按绘制顺序遍历
+    template <class F>
+    void forEach(F f) const
+    {
+        if (!data) return;
+        for (const auto& chunk : data->chunks)
+            for (const auto& s : *chunk)
+                f(static_cast<const Shape&>(*s));
+    }
+
+    // 生成快照时的画布尺寸与背景色
+    QSize canvasSize() const { return data ? data->size : QSize(); }
+    QRgb background() const { return data ? data->background : 0xffffffff; }
+
+    // 两个快照是否共享同一份内容（场景在两次 snapshot() 之间没有变化）
+    bool sameAs(const SceneSnapshot& other) const { return data == other.data; }
+
+    // 在调用线程上把全部图元画到 target（通常是工作线程自己创建的 DrawEngine）
+    void drawTo(DrawEngine& target) const;
+    // 在调用线程上渲染整张画布
+    QImage render() const;
+
+private:
+    friend class DrawEngine;
+
+    using Chunk = std::vector<std::shared_ptr<Shape>>;
+
+    struct Data
+    {
+        std::vector<std::shared_ptr<const Chunk>> chunks;               // 除最后一块外都是满块
+        std::size_t count = 0;
+        QSize size;
+        QRgb background = 0xffffffff;
+    };
+
+    explicit SceneSnapshot(std::shared_ptr<const Data> d) : data(std::move(d)) {}
+
+    const std::shared_ptr<Shape>& entry(std::size_t i) const { return (*data->chunks[i / CHUNK_SIZE])[i % CHUNK_SIZE]; }
+
+    // 按绘制顺序重新生成：没有过期标记且仍在原位置的图元沿用上一快照中的副本
+    static SceneSnapshot rebuild(const SceneSnapshot& previous,
+                                 const std::vector<std::shared_ptr<Shape>>& ordered,
+                                 const QSize& size, QRgb background);
+
+    // 在上一快照基础上替换改动过的图元、在顶部追加新图元；找不到改动的图元时返回 false
+    static bool patch(const SceneSnapshot& previous,
+                      const std::vector<Shape*>& changed, const std::vector<Shape*>& appended,
+                      const QSize& size, QRgb background, SceneSnapshot& out);
+
+    std::shared_ptr<const Data> data;
+};
+
+#endif // SCENESNAPSHOT_H
@@ -0,0 +1,1387 @@
+#include "scenesvg.h"
+#include "drawengine.h"
+#include "lineshape.h"
+#include "arcshape.h"
+#include "ellipseshape.h"
+#include "polygonshape.h"
+#include "rasterfillshape.h"
+#include "tangrampiece.h"
+#include "tangramgame.h"
+#include "scenesnapshot.h"
+
+#include <QFile>
+#include <QStringList>
+#include <QXmlStreamWriter>
+#include <QXmlStreamReader>
+#include <QtMath>
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+namespace {
+
+// ---------------------------------------------------------------- 导出
+
+QString num(double v)
+{
+    return QString::number(v, 'g', 12);
+}
+
+// 像素 v 的中心坐标
+QString pixel(int v)
+{
+    return num(v + 0.5);
+}
+
+const char* capName(LineCap c)
+{
+    switch (c) {
+    case LineCap::Flat:   return "butt";
+    case LineCap::Square: return "square";
+    case LineCap::Round:  return "round";
+    }
+    return "round";
+}
+
+const char* joinName(LineJoin j)
+{
+    switch (j) {
+    case LineJoin::Miter: return "miter";
+    case LineJoin::Bevel: return "bevel";
+    case LineJoin::Round: return "round";
+    }
+    return "round";
+}
+
+// 线型节奏（1 画 / 0 空）压缩成交替的画 / 空长度；节奏按线宽步进，所以长度乘以线宽
+QString dashArray(LineStyle style, int width)
+{
+    int len = 1;
+    const int* pat = DrawEngine::linePattern(style, len);
+    if (len <= 1) return QString();
+
+    QStringList runs;
+    int run = 1;
+    for (int i = 1; i <= len; ++i)
+    {
+        if (i < len && pat[i] == pat[i - 1])
+            ++run;
+        else
+        {
+            runs << QString::number(run * width);
+            run = 1;
+        }
+    }
+    return runs.join(' ');
+}
+
+void writeStroke(QXmlStreamWriter& w, const Shape& s)
+{
+    w.writeAttribute("stroke", s.color.name());
+    w.writeAttribute("stroke-width", QString::number(s.penWidth));
+    w.writeAttribute("stroke-linecap", capName(s.lineCap));
+    w.writeAttribute("stroke-linejoin", joinName(s.lineJoin));
+    const QString dash = dashArray(s.lineStyle, s.penWidth);
+    if (!dash.isEmpty())
+    {
+        w.writeAttribute("stroke-dasharray", dash);
+        if (s.dashOffset != 0)
+            w.writeAttribute("stroke-dashoffset", QString::number(s.dashOffset * s.penWidth));
+    }
+}
+
+QString pointList(const std::vector<QPoint>& pts)
+{
+    QString s;
+    s.reserve(int(pts.size()) * 14);
+    for (const QPoint& p : pts)
+    {
+        if (!s.isEmpty()) s += ' ';
+        s += pixel(p.x());
+        s += ',';
+        s += pixel(p.y());
+    }
+    return s;
+}
+
+/**
+ * @brief 圆弧：整圆写成 <circle>，其余写成一段 A 命令的 <path>
+ * matrix 为单位矩阵时直接写像素中心坐标；否则写源圆弧，matrix 放进 transform，
+ * 线宽是画布像素，不随 matrix 缩放（non-scaling-stroke）
+ * data-angles 保存原始起止角，读回时不经反三角函数换算
+ */
+bool writeArc(QXmlStreamWriter& w, const ArcShape& arc)
+{
+    const double sweep = arc.sweepAngle();
+    if (arc.radius <= 0 || sweep <= 0) return false;                   // 不绘制任何像素的圆弧没有 SVG 表示
+
+    const bool identity = arc.matrix.isIdentity();
+    const double off = identity ? 0.5 : 0.0;
+    const double cx = arc.center.x() + off;
+    const double cy = arc.center.y() + off;
+    const double r = arc.radius;
+
+    if (sweep >= 360.0)
+    {
+        w.writeStartElement("circle");
+        w.writeAttribute("cx", num(cx));
+        w.writeAttribute("cy", num(cy));
+        w.writeAttribute("r", num(r));
+    }
+    else
+    {
+        const double a0 = qDegreesToRadians(arc.startAngle);
+        const double a1 = qDegreesToRadians(arc.startAngle + sweep);
+        w.writeStartElement("path");
+        w.writeAttribute("d", QString("M%1 %2A%3 %3 0 %4 1 %5 %6")
+                                  .arg(num(cx + r * std::cos(a0)), num(cy + r * std::sin(a0)), num(r))
+                                  .arg(sweep > 180.0 ? 1 : 0)
+                                  .arg(num(cx + r * std::cos(a1)), num(cy + r * std::sin(a1))));
+    }
+    w.writeAttribute("data-angles", num(arc.startAngle) + ' ' + num(arc.endAngle));
+    if (!identity)
+    {
+        const QTransform& m = arc.matrix;
+        w.writeAttribute("transform", QString("translate(0.5 0.5) matrix(%1 %2 %3 %4 %5 %6)")
+                                          .arg(num(m.m11()), num(m.m12()), num(m.m21()),
+                                               num(m.m22()), num(m.dx()), num(m.dy())));
+        w.writeAttribute("vector-effect", "non-scaling-stroke");
+    }
+    w.writeAttribute("fill", "none");
+    writeStroke(w, arc);
+    w.writeEndElement();
+    return true;
+}
+
+/**
+ * @brief 椭圆：整椭圆写成 <ellipse>，扇形 / 弓形写成闭合的 <path>（扇形经过圆心）
+ * 坐标与 transform 的约定同 writeArc；data-ellipse 保存源几何 [cx, cy, rx, ry, start, end] 与形状，
+ * 读回时按它重建 EllipseShape，不经折线化
+ */
+bool writeEllipse(QXmlStreamWriter& w, const EllipseShape& ellipse)
+{
+    const double sweep = ellipse.sweepAngle();
+    if (ellipse.radiusX <= 0 || ellipse.radiusY <= 0 || sweep <= 0) return false;
+
+    const bool identity = ellipse.matrix.isIdentity();
+    const double off = identity ? 0.5 : 0.0;
+    const double cx = ellipse.center.x() + off;
+    const double cy = ellipse.center.y() + off;
+    const double rx = ellipse.radiusX, ry = ellipse.radiusY;
+
+    if (sweep >= 360.0)
+    {
+        w.writeStartElement("ellipse");
+        w.writeAttribute("cx", num(cx));
+        w.writeAttribute("cy", num(cy));
+        w.writeAttribute("rx", num(rx));
+        w.writeAttribute("ry", num(ry));
+    }
+    else
+    {
+        const double a0 = qDegreesToRadians(ellipse.startAngle);
+        const double a1 = qDegreesToRadians(ellipse.startAngle + sweep);
+        const QString arc = QString("M%1 %2A%3 %4 0 %5 1 %6 %7")
+                                .arg(num(cx + rx * std::cos(a0)), num(cy + ry * std::sin(a0)), num(rx), num(ry))
+                                .arg(sweep > 180.0 ? 1 : 0)
+                                .arg(num(cx + rx * std::cos(a1)), num(cy + ry * std::sin(a1)));
+        w.writeStartElement("path");
+        w.writeAttribute("d", ellipse.form == EllipseShape::Form::Pie
+                                  ? arc + QString("L%1 %2Z").arg(num(cx), num(cy))
+                                  : arc + 'Z');
+    }
+    w.writeAttribute("data-kind", "ellipse");
+    w.writeAttribute("data-ellipse", QString("%1 %2 %3 %4 %5 %6 %7")
+                                         .arg(ellipse.center.x()).arg(ellipse.center.y())
+                                         .arg(ellipse.radiusX).arg(ellipse.radiusY)
+                                         .arg(num(ellipse.startAngle), num(ellipse.endAngle))
+                                         .arg(int(ellipse.form)));
+    if (!identity)
+    {
+        const QTransform& m = ellipse.matrix;
+        w.writeAttribute("transform", QString("translate(0.5 0.5) matrix(%1 %2 %3 %4 %5 %6)")
+                                          .arg(num(m.m11()), num(m.m12()), num(m.m21()),
+                                               num(m.m22()), num(m.dx()), num(m.dy())));
+        w.writeAttribute("vector-effect", "non-scaling-stroke");
+    }
+    w.writeAttribute("fill", ellipse.filled ? ellipse.fillColor.name() : QString("none"));
+    writeStroke(w, ellipse);
+    w.writeEndElement();
+    return true;
+}
+
+void writeShape(QXmlStreamWriter& w, const Shape& s)
+{
+    switch (s.kind())
+    {
+    case ShapeKind::Line:
+    {
+        auto line = static_cast<const LineShape*>(&s);
+        w.writeStartElement("line");
+        const QPoint a = line->startPoint(), b = line->endPoint();
+        w.writeAttribute("x1", pixel(a.x()));
+        w.writeAttribute("y1", pixel(a.y()));
+        w.writeAttribute("x2", pixel(b.x()));
+        w.writeAttribute("y2", pixel(b.y()));
+        if (line->antialiased)
+            w.writeAttribute("data-antialiased", "1");                  // Wu 抗锯齿细线，SVG 本身没有对应属性
+        writeStroke(w, s);
+        w.writeEndElement();
+        break;
+    }
+    case ShapeKind::Arc:
+        writeArc(w, *static_cast<const ArcShape*>(&s));
+        break;
+    case ShapeKind::Ellipse:
+        writeEllipse(w, *static_cast<const EllipseShape*>(&s));
+        break;
+    case ShapeKind::Polygon:
+    case ShapeKind::TangramPiece:
+    {
+        auto poly = static_cast<const PolygonShape*>(&s);
+        w.writeStartElement("polygon");
+        if (s.kind() == ShapeKind::TangramPiece)
+        {
+            auto piece = static_cast<const TangramPiece*>(&s);
+            const TangramPose pose = piece->pose();
+            w.writeAttribute("data-kind", "tangram");
+            w.writeAttribute("data-piece", SceneIO::tangramPieceName(piece->pieceType()));
+            w.writeAttribute("data-pose", QString("%1 %2 %3 %4")
+                                              .arg(num(pose.position.x()), num(pose.position.y()),
+                                                   num(pose.rotationDeg))
+                                              .arg(pose.flipped ? 1 : 0));
+        }
+        w.writeAttribute("points", pointList(poly->vertices()));
+        w.writeAttribute("fill", poly->filled ? poly->fillColor.name() : QString("none"));
+        writeStroke(w, s);
+        w.writeEndElement();
+        break;
+    }
+    case ShapeKind::RasterFill:
+    {
+        // 每个 span 一个单位高的矩形子路径：像素 [x0, x1] 覆盖 SVG 中的 [x0, x1 + 1]
+        auto fill = static_cast<const RasterFillShape*>(&s);
+        QString d;
+        d.reserve(int(fill->spans.size()) * 24);
+        for (const RasterFillShape::Span& sp : fill->spans)
+        {
+            const QString width = QString::number(sp.x1 - sp.x0 + 1);
+            d += 'M';
+            d += QString::number(sp.x0);
+            d += ' ';
+            d += QString::number(sp.y);
+            d += 'h';
+            d += width;
+            d += "v1h-";
+            d += width;
+            d += 'z';
+        }
+        w.writeStartElement("path");
+        w.writeAttribute("data-kind", "fill");
+        w.writeAttribute("d", d);
+        w.writeAttribute("fill", fill->color.name());
+        w.writeAttribute("stroke", "none");
+        w.writeAttribute("shape-rendering", "crispEdges");
+        w.writeEndElement();
+        break;
+    }
+    }
+}
+
+// 文档头 + 背景 + forEachShape 依次给出的图元
+template <class ForEachShape>
+bool writeSvg(const QString& path, const QSize& size, const QColor& background, qint64 count,
+              ForEachShape forEachShape, QString* error, const SceneIO::Progress& progress)
+{
+    QFile file(path);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate))
+    {
+        if (error) *error = QString("cannot write %1").arg(path);
+        return false;
+    }
+
+    QXmlStreamWriter w(&file);
+    w.setAutoFormatting(true);
+    w.setAutoFormattingIndent(1);
+    w.writeStartDocument();
+    w.writeStartElement("svg");
+    w.writeDefaultNamespace("http://www.w3.org/2000/svg");
+    w.writeAttribute("version", "1.1");
+    w.writeAttribute("width", QString::number(size.width()));
+    w.writeAttribute("height", QString::number(size.height()));
+    w.writeAttribute("viewBox", QString("0 0 %1 %2").arg(size.width()).arg(size.height()));
+
+    w.writeStartElement("rect");
+    w.writeAttribute("data-kind", "background");
+    w.writeAttribute("width", QString::number(size.width()));
+    w.writeAttribute("height", QString::number(size.height()));
+    w.writeAttribute("fill", background.name());
+    w.writeEndElement();
+
+    qint64 written = 0;
+    bool cancelled = false;
+    forEachShape([&](const Shape& s) {
+        if (cancelled) return;
+        if (progress && ++written % SceneIO::PROGRESS_STEP == 0 && !progress(written, count))
+        {
+            cancelled = true;
+            return;
+        }
+        writeShape(w, s);
+    });
+    if (cancelled)
+    {
+        if (error) *error = "cancelled";
+        return false;
+    }
+
+    w.writeEndElement();
+    w.writeEndDocument();
+    if (w.hasError())
+    {
+        if (error) *error = QString("cannot write %1").arg(path);
+        return false;
+    }
+    if (progress) progress(count, count);
+    return true;
+}
+
+// ---------------------------------------------------------------- 导入
+
+// 属性值中的数字、标志位与命令字母（逗号与空白都是分隔符）
+class SvgScanner
+{
+public:
+    explicit SvgScanner(const QString& s) : text(s.toLatin1()), p(text.constData()), end(p + text.size()) {}
+
+    bool atEnd()
+    {
+        skip();
+        return p >= end;
+    }
+
+    bool number(double* v)
+    {
+        skip();
+        const char* s = p;
+        if (p < end && (*p == '+' || *p == '-')) ++p;
+        bool digits = false;
+        while (p < end && isDigit(*p)) { ++p; digits = true; }
+        if (p < end && *p == '.')
+        {
+            ++p;
+            while (p < end && isDigit(*p)) { ++p; digits = true; }
+        }
+        if (!digits)
+        {
+            p = s;
+            return false;
+        }
+        if (p < end && (*p == 'e' || *p == 'E'))
+        {
+            const char* e = p++;
+            if (p < end && (*p == '+' || *p == '-')) ++p;
+            if (p < end && isDigit(*p))
+                while (p < end && isDigit(*p)) ++p;
+            else
+                p = e;
+        }
+        bool ok = false;
+        *v = QByteArray::fromRawData(s, int(p - s)).toDouble(&ok);
+        return ok;
+    }
+
+    // 圆弧的 large-arc / sweep 标志：单个 0 或 1，后面可以紧跟下一个数
+    bool flag(bool* v)
+    {
+        skip();
+        if (p >= end || (*p != '0' && *p != '1')) return false;
+        *v = *p++ == '1';
+        return true;
+    }
+
+    // 下一个字符是字母时读出（路径命令），否则返回 0
+    char command()
+    {
+        skip();
+        if (p < end && isLetter(*p)) return *p++;
+        return 0;
+    }
+
+    // 变换列表中的函数名
+    QByteArray word()
+    {
+        skip();
+        const char* s = p;
+        while (p < end && isLetter(*p)) ++p;
+        return QByteArray(s, int(p - s));
+    }
+
+    bool consume(char c)
+    {
+        skip();
+        if (p >= end || *p != c) return false;
+        ++p;
+        return true;
+    }
+
+    // 数字之后紧跟的单位（px / mm / %）
+    QByteArray rest() const { return QByteArray(p, int(end - p)).trimmed(); }
+
+private:
+    static bool isDigit(char c) { return c >= '0' && c <= '9'; }
+    static bool isLetter(char c) { return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z'); }
+
+    void skip()
+    {
+        while (p < end && (*p == ' ' || *p == ',' || *p == '\t' || *p == '\n' || *p == '\r')) ++p;
+    }
+
+    QByteArray text;
+    const char* p;
+    const char* end;
+};
+
+// 长度（绝对单位按 96 dpi 换算为像素），百分比或无法解析时返回 false
+bool parseLength(const QString& s, double* out)
+{
+    SvgScanner in(s);
+    double v;
+    if (!in.number(&v)) return false;
+    const QByteArray unit = in.rest();
+    double k = 0;
+    if (unit.isEmpty() || unit == "px") k = 1.0;
+    else if (unit == "pt") k = 96.0 / 72.0;
+    else if (unit == "pc") k = 16.0;
+    else if (unit == "mm") k = 96.0 / 25.4;
+    else if (unit == "cm") k = 96.0 / 2.54;
+    else if (unit == "in") k = 96.0;
+    if (k == 0) return false;
+    *out = v * k;
+    return true;
+}
+
+/**
+ * @brief transform 属性：matrix / translate / scale / rotate / skewX / skewY 的列表
+ * 列表中靠右的变换先作用于坐标；QTransform 按行向量相乘，先作用的放在左边
+ */
+QTransform parseTransform(const QString& s)
+{
+    QTransform result;
+    SvgScanner in(s);
+    while (!in.atEnd())
+    {
+        const QByteArray name = in.word();
+        if (name.isEmpty() || !in.consume('(')) break;
+        double a[6] = {0, 0, 0, 0, 0, 0};
+        int n = 0;
+        while (n < 6 && in.number(&a[n])) ++n;
+        if (!in.consume(')') || n == 0) break;
+
+        QTransform t;
+        if (name == "matrix" && n == 6)
+            t = QTransform(a[0], a[1], a[2], a[3], a[4], a[5]);
+        else if (name == "translate")
+            t = QTransform::fromTranslate(a[0], n > 1 ? a[1] : 0.0);
+        else if (name == "scale")
+            t = QTransform::fromScale(a[0], n > 1 ? a[1] : a[0]);
+        else if (name == "rotate")
+        {
+            t = QTransform().rotate(a[0]);
+            if (n >= 3)
+                t = QTransform::fromTranslate(-a[1], -a[2]) * t * QTransform::fromTranslate(a[1], a[2]);
+        }
+        else if (name == "skewX")
+            t = QTransform(1, 0, std::tan(qDegreesToRadians(a[0])), 1, 0, 0);
+        else if (name == "skewY")
+            t = QTransform(1, std::tan(qDegreesToRadians(a[0])), 0, 1, 0, 0);
+        result = t * result;
+    }
+    return result;
+}
+
+// 颜色：none 为无效颜色；无法识别（渐变、currentColor）时返回 false，保持继承值
+bool parseColor(const QString& value, QColor* out)
+{
+    const QString v = value.trimmed();
+    if (v == "none")
+    {
+        *out = QColor();
+        return true;
+    }
+    if (v.startsWith("rgb("))
+    {
+        SvgScanner in(v.mid(4));
+        double c[3];
+        for (double& x : c)
+            if (!in.number(&x)) return false;
+        const double k = v.contains('%') ? 255.0 / 100.0 : 1.0;
+        *out = QColor(qRound(qBound(0.0, c[0] * k, 255.0)), qRound(qBound(0.0, c[1] * k, 255.0)),
+                      qRound(qBound(0.0, c[2] * k, 255.0)));
+        return true;
+    }
+    QColor c(v);
+    if (!c.isValid()) return false;
+    *out = c;
+    return true;
+}
+
+// 继承的表现属性
+struct SvgStyle
+{
+    QColor stroke;                                                      // 无效颜色表示 none（SVG 默认）
+    QColor fill = Qt::black;
+    double strokeWidth = 1.0;
+    LineCap cap = LineCap::Flat;                                        // SVG 默认 butt / miter
+    LineJoin join = LineJoin::Miter;
+    std::vector<double> dash;
+    double dashOffset = 0.0;
+};
+
+void applyProperty(SvgStyle& st, const QString& name, const QString& value)
+{
+    const QString v = value.trimmed();
+    if (v.isEmpty() || v == "inherit") return;
+
+    if (name == "stroke")
+        parseColor(v, &st.stroke);
+    else if (name == "fill")
+        parseColor(v, &st.fill);
+    else if (name == "stroke-width")
+    {
+        double w;
+        if (parseLength(v, &w) && w >= 0) st.strokeWidth = w;
+    }
+    else if (name == "stroke-linecap")
+        st.cap = v == "round" ? LineCap::Round : v == "square" ? LineCap::Square : LineCap::Flat;
+    else if (name == "stroke-linejoin")
+        st.join = v == "round" ? LineJoin::Round : v == "bevel" ? LineJoin::Bevel : LineJoin::Miter;
+    else if (name == "stroke-dasharray")
+    {
+        st.dash.clear();
+        SvgScanner in(v);
+        double d;
+        while (in.number(&d))
+            st.dash.push_back(std::max(0.0, d));
+        if (st.dash.size() % 2)                                         // 奇数个长度按规范重复一遍
+            st.dash.insert(st.dash.end(), st.dash.begin(), st.dash.end());
+    }
+    else if (name == "stroke-dashoffset")
+    {
+        SvgScanner in(v);
+        in.number(&st.dashOffset);
+    }
+}
+
+const char* const STYLE_PROPERTIES[] = {
+    "stroke", "fill", "stroke-width", "stroke-linecap", "stroke-linejoin",
+    "stroke-dasharray", "stroke-dashoffset"
+};
+
+// 表现属性，随后是 style 属性中的同名声明（优先级更高）
+void applyPresentation(SvgStyle& st, const QXmlStreamAttributes& a)
+{
+    for (const char* name : STYLE_PROPERTIES)
+        if (a.hasAttribute(QLatin1String(name)))
+            applyProperty(st, QString::fromLatin1(name), a.value(QLatin1String(name)).toString());
+
+    const QString style = a.value(QLatin1String("style")).toString();
+    if (style.isEmpty()) return;
+    for (const QString& decl : style.split(';'))
+    {
+        const int colon = decl.indexOf(':');
+        if (colon > 0)
+            applyProperty(st, decl.left(colon).trimmed(), decl.mid(colon + 1));
+    }
+}
+
+// 元素所处的坐标系与样式
+struct Frame
+{
+    QTransform ctm;                                                     // 元素坐标 -> 画布（SVG 用户坐标）
+    SvgStyle style;
+};
+
+// 椭圆弧（中心参数化，角度单位 °，delta 为负表示逆时针）
+struct EllipseArc
+{
+    QPointF center;
+    double rx, ry;
+    double phi;
+    double theta;
+    double delta;
+
+    QPointF at(double deg) const
+    {
+        const double t = qDegreesToRadians(deg), f = qDegreesToRadians(phi);
+        const double x = rx * std::cos(t), y = ry * std::sin(t);
+        return QPointF(center.x() + x * std::cos(f) - y * std::sin(f),
+                       center.y() + x * std::sin(f) + y * std::cos(f));
+    }
+};
+
+/**
+ * @brief 端点参数化的圆弧换算为中心参数化（SVG 1.1 附录 F.6.5）
+ * 半径不足以连接两端点时按比例放大
+ */
+EllipseArc arcFromEndpoints(const QPointF& p1, const QPointF& p2, double rx, double ry,
+                            double phi, bool large, bool sweep)
+{
+    rx = std::fabs(rx);
+    ry = std::fabs(ry);
+    const double f = qDegreesToRadians(phi);
+    const double cf = std::cos(f), sf = std::sin(f);
+    const double dx = (p1.x() - p2.x()) / 2, dy = (p1.y() - p2.y()) / 2;
+    const double x1 = cf * dx + sf * dy;
+    const double y1 = -sf * dx + cf * dy;
+
+    const double lambda = x1 * x1 / (rx * rx) + y1 * y1 / (ry * ry);
+    if (lambda > 1)
+    {
+        rx *= std::sqrt(lambda);
+        ry *= std::sqrt(lambda);
+    }
+
+    const double numer = rx * rx * ry * ry - rx * rx * y1 * y1 - ry * ry * x1 * x1;
+    const double denom = rx * rx * y1 * y1 + ry * ry * x1 * x1;
+    double coef = denom > 0 ? std::sqrt(std::max(0.0, numer / denom)) : 0.0;
+    if (large == sweep) coef = -coef;
+    const double cx1 = coef * rx * y1 / ry;
+    const double cy1 = -coef * ry * x1 / rx;
+
+    EllipseArc e;
+    e.center = QPointF(cf * cx1 - sf * cy1 + (p1.x() + p2.x()) / 2,
+                       sf * cx1 + cf * cy1 + (p1.y() + p2.y()) / 2);
+    e.rx = rx;
+    e.ry = ry;
+    e.phi = phi;
+    e.theta = qRadiansToDegrees(std::atan2((y1 - cy1) / ry, (x1 - cx1) / rx));
+    double end = qRadiansToDegrees(std::atan2((-y1 - cy1) / ry, (-x1 - cx1) / rx));
+    double delta = std::fmod(end - e.theta, 360.0);
+    if (sweep && delta < 0) delta += 360.0;
+    if (!sweep && delta > 0) delta -= 360.0;
+    e.delta = delta;
+    return e;
+}
+
+// 路径的一个子路径：折线化后的点，以及只有一段圆弧时的精确参数
+struct SubPath
+{
+    std::vector<QPointF> points;
+    bool closed = false;
+    int segments = 0;
+    bool arcSegment = false;                                            // 唯一的一段是圆弧
+    EllipseArc arc;
+};
+
+// 曲线折线化时与原曲线的最大偏差（像素）
+constexpr double FLATNESS = 0.5;
+
+// 折线段数 n 向上取整并限制在 [lo, 1024]：先在 double 上限定范围再转 int，坐标极大或为 NaN 时也不越界
+int segmentCount(double n, int lo)
+{
+    return std::isnan(n) ? lo : int(qBound(double(lo), std::ceil(n), 1024.0));
+}
+
+// 三次贝塞尔曲线的折线段数（Wang 公式）；scale 为每单位用户坐标的像素数
+int cubicSegments(const QPointF& p0, const QPointF& c1, const QPointF& c2, const QPointF& p3, double scale)
+{
+    const QPointF a = p0 - c1 * 2 + c2, b = c1 - c2 * 2 + p3;
+    const double d = std::max(std::hypot(a.x(), a.y()), std::hypot(b.x(), b.y())) * scale;
+    return segmentCount(std::sqrt(0.75 * d / FLATNESS), 1);
+}
+
+// 半径 radius 像素、扫过 sweepDeg 的圆弧的折线段数：每段弦高不超过 FLATNESS
+int arcSegments(double sweepDeg, double radius)
+{
+    const double step = radius > FLATNESS ? 2 * std::acos(1 - FLATNESS / radius) : M_PI / 2;
+    return segmentCount(qDegreesToRadians(std::fabs(sweepDeg)) / step, 2);
+}
+
+/**
+ * @brief 解析 path 的 d 属性（绝对 / 相对的 M L H V C S Q T A Z）
+ * 曲线按 scale（每单位用户坐标的像素数）折线化，偏差不超过 FLATNESS 像素；
+ * 遇到无法解析的内容时到此为止（与 SVG 规范一致）
+ */
+std::vector<SubPath> parsePath(const QString& d, double scale)
+{
+    std::vector<SubPath> out;
+    SvgScanner in(d);
+    QPointF cur, start, ctrl;
+    char cmd = 0, prev = 0;
+    bool needNew = true;
+
+    auto current = [&]() -> SubPath& {
+        if (needNew)
+        {
+            out.emplace_back();
+            out.back().points.push_back(cur);
+            needNew = false;
+        }
+        return out.back();
+    };
+    auto lineTo = [&](const QPointF& p) {
+        SubPath& sp = current();
+        sp.points.push_back(p);
+        ++sp.segments;
+        sp.arcSegment = false;
+        cur = p;
+    };
+    auto cubicTo = [&](const QPointF& c1, const QPointF& c2, const QPointF& p) {
+        SubPath& sp = current();
+        const QPointF p0 = cur;
+        const int n = cubicSegments(p0, c1, c2, p, scale);
+        for (int i = 1; i <= n; ++i)
+        {
+            const double t = double(i) / n, u = 1 - t;
+            sp.points.push_back(p0 * (u * u * u) + c1 * (3 * u * u * t) + c2 * (3 * u * t * t) + p * (t * t * t));
+        }
+        ++sp.segments;
+        sp.arcSegment = false;
+        cur = p;
+    };
+
+    while (true)
+    {
+        const char c = in.command();
+        if (c)
+            cmd = c;
+        else if (!cmd || cmd == 'Z' || cmd == 'z' || in.atEnd())
+            break;                                                      // 数字之前没有命令，或 Z 后面跟着数字
+
+        const bool rel = cmd >= 'a';
+        const QPointF base = rel ? cur : QPointF(0, 0);
+        double v[7];
+        auto read = [&](int n) {
+            for (int i = 0; i < n; ++i)
+                if (!in.number(&v[i])) return false;
+            return true;
+        };
+
+        bool ok = true;
+        switch (cmd & ~0x20)                                            // 转为大写
+        {
+        case 'M':
+            if (!(ok = read(2))) break;
+            cur = base + QPointF(v[0], v[1]);
+            start = cur;
+            needNew = true;
+            current();
+            cmd = rel ? 'l' : 'L';                                      // 之后成对的坐标是 lineto
+            break;
+        case 'L':
+            if ((ok = read(2))) lineTo(base + QPointF(v[0], v[1]));
+            break;
+        case 'H':
+            if ((ok = read(1))) lineTo(QPointF(rel ? cur.x() + v[0] : v[0], cur.y()));
+            break;
+        case 'V':
+            if ((ok = read(1))) lineTo(QPointF(cur.x(), rel ? cur.y() + v[0] : v[0]));
+            break;
+        case 'C':
+            if (!(ok = read(6))) break;
+            ctrl = base + QPointF(v[2], v[3]);
+            cubicTo(base + QPointF(v[0], v[1]), ctrl, base + QPointF(v[4], v[5]));
+            break;
+        case 'S':
+        {
+            if (!(ok = read(4))) break;
+            const bool smooth = (prev & ~0x20) == 'C' || (prev & ~0x20) == 'S';
+            const QPointF c1 = smooth ? cur * 2 - ctrl : cur;
+            ctrl = base + QPointF(v[0], v[1]);
+            cubicTo(c1, ctrl, base + QPointF(v[2], v[3]));
+            break;
+        }
+        case 'Q':
+        case 'T':
+        {
+            const bool quad = (cmd & ~0x20) == 'Q';
+            if (!(ok = read(quad ? 4 : 2))) break;
+            QPointF q;
+            if (quad)
+                q = base + QPointF(v[0], v[1]);
+            else
+                q = (prev & ~0x20) == 'Q' || (prev & ~0x20) == 'T' ? cur * 2 - ctrl : cur;
+            const QPointF p = base + (quad ? QPointF(v[2], v[3]) : QPointF(v[0], v[1]));
+            ctrl = q;
+            cubicTo(cur + (q - cur) * (2.0 / 3.0), p + (q - p) * (2.0 / 3.0), p);    // 二次曲线升阶为三次
+            break;
+        }
+        case 'A':
+        {
+            bool large = false, sweep = false;
+            ok = read(3) && in.flag(&large) && in.flag(&sweep) && in.number(&v[3]) && in.number(&v[4]);
+            if (!ok) break;
+            const QPointF p = base + QPointF(v[3], v[4]);
+            if (v[0] == 0 || v[1] == 0)
+            {
+                lineTo(p);                                              // 半径为 0 时按直线处理
+                break;
+            }
+            if (p == cur) break;                                        // 端点重合的圆弧不绘制
+
+            const EllipseArc e = arcFromEndpoints(cur, p, v[0], v[1], v[2], large, sweep);
+            SubPath& sp = current();
+            const int n = arcSegments(e.delta, std::max(e.rx, e.ry) * scale);
+            for (int i = 1; i < n; ++i)
+                sp.points.push_back(e.at(e.theta + e.delta * i / n));
+            sp.points.push_back(p);
+            sp.arcSegment = ++sp.segments == 1;
+            sp.arc = e;
+            cur = p;
+            break;
+        }
+        case 'Z':
+            if (!out.empty() && !needNew)
+            {
+                out.back().closed = true;
+                cur = start;
+                needNew = true;                                         // Z 之后不是 M 的命令从起点开始新子路径
+            }
+            break;
+        default:
+            ok = false;
+            break;
+        }
+        if (!ok) break;
+        prev = cmd;
+    }
+    return out;
+}
+
+/**
+ * @brief 边读边建的导入器
+ * 坐标映射：SVG 中以 (x + 0.5, y + 0.5) 为中心的单位方块是像素 (x, y)，
+ * 所以元素坐标经 ctm 后向下取整得到像素；圆弧的 matrix 额外平移 -0.5
+ * 坐标、半径超出 SceneIO 的读入范围（或为 NaN / inf）时不做转换，记下原因，load() 以出错的行号失败；
+ * 线宽超出范围时限制到 [1, MAX_PEN_WIDTH]
+ */
+class SvgImporter
+{
+public:
+    SvgImporter(DrawEngine& e, SceneIO::SceneHeader* h) : engine(e), header(h) {}
+
+    void element(const QString& name, const QXmlStreamAttributes& a, const Frame& f);
+    // 第一个超出读入范围的数值（空表示没有）
+    const QString& rejection() const { return rejected; }
+
+private:
+    bool reject(const char* what)
+    {
+        if (rejected.isEmpty())
+            rejected = QString("%1 out of range").arg(what);
+        return false;
+    }
+
+    bool toPixel(const QTransform& ctm, const QPointF& p, QPoint* out)
+    {
+        const QPointF q = ctm.map(p);
+        if (!SceneIO::coordValid(q.x()) || !SceneIO::coordValid(q.y()))
+            return reject("coordinate");
+        *out = QPoint(int(std::floor(q.x())), int(std::floor(q.y())));
+        return true;
+    }
+
+    static double number(const QXmlStreamAttributes& a, const char* name, double def = 0.0)
+    {
+        double v;
+        return parseLength(a.value(QLatin1String(name)).toString(), &v) ? v : def;
+    }
+
+    // 每单位用户坐标对应的像素数（线宽与折线化精度用）
+    static double scaleOf(const QTransform& ctm)
+    {
+        return std::sqrt(std::fabs(ctm.determinant()));
+    }
+
+    bool applyStroke(Shape& s, const Frame& f, const QColor& color, const QXmlStreamAttributes& a);
+    void addPoints(const SubPath& sp, const Frame& f, const QXmlStreamAttributes& a);
+    void addPolygon(const std::vector<QPointF>& pts, const Frame& f, const QXmlStreamAttributes& a);
+    void addArc(const EllipseArc& e, const Frame& f, const QXmlStreamAttributes& a);
+    bool addEllipse(const Frame& f, const QXmlStreamAttributes& a);
+    void addSpans(const std::vector<SubPath>& paths, const Frame& f);
+
+    DrawEngine& engine;
+    SceneIO::SceneHeader* header;
+    QString rejected;
+};
+
+bool SvgImporter::applyStroke(Shape& s, const Frame& f, const QColor& color, const QXmlStreamAttributes& a)
+{
+    const SvgStyle& st = f.style;
+    const double width = std::max(st.strokeWidth, 1e-6);
+    const bool nonScaling = a.value(QLatin1String("vector-effect")) == QLatin1String("non-scaling-stroke");
+    const double pen = st.strokeWidth * (nonScaling ? 1.0 : scaleOf(f.ctm));
+    if (!std::isfinite(pen))
+        return reject("stroke-width");
+    s.color = color;
+    s.penWidth = qRound(qBound(1.0, pen, double(SceneIO::MAX_PEN_WIDTH)));
+    s.lineCap = st.cap;
+    s.lineJoin = st.join;
+
+    // 画 / 空段数与比例对应到最接近的线型：四段为点划线，两段按画是否长于空区分虚线与点线
+    s.lineStyle = LineStyle::Solid;
+    s.dashOffset = 0;
+    double total = 0;
+    for (double d : st.dash) total += d;
+    if (total <= 0) return true;
+    if (st.dash.size() >= 4)
+        s.lineStyle = LineStyle::DashDot;
+    else
+        s.lineStyle = st.dash[0] >= st.dash[1] ? LineStyle::Dash : LineStyle::Dot;
+    const double offset = st.dashOffset / width;
+    if (!SceneIO::coordValid(offset))
+        return reject("stroke-dashoffset");
+    s.dashOffset = qRound(offset);
+    return true;
+}
+
+void SvgImporter::addPolygon(const std::vector<QPointF>& pts, const Frame& f, const QXmlStreamAttributes& a)
+{
+    const SvgStyle& st = f.style;
+    if (!st.stroke.isValid() && !st.fill.isValid()) return;
+
+    std::vector<QPoint> vertices;
+    vertices.reserve(pts.size());
+    for (const QPointF& p : pts)
+    {
+        QPoint q;
+        if (!toPixel(f.ctm, p, &q)) return;
+        if (vertices.empty() || vertices.back() != q)
+            vertices.push_back(q);
+    }
+    while (vertices.size() > 1 && vertices.back() == vertices.front())
+        vertices.pop_back();
+    if (vertices.size() < 3) return;
+
+    std::shared_ptr<PolygonShape> poly;
+    TangramPieceType type;
+    if (a.value(QLatin1String("data-kind")) == QLatin1String("tangram")
+        && SceneIO::tangramPieceFromName(a.value(QLatin1String("data-piece")).toString(), &type))
+    {
+        // 本程序导出的七巧板拼块：按姿态重建，顶点由拼块自己计算
+        SvgScanner in(a.value(QLatin1String("data-pose")).toString());
+        double pose[4] = {0, 0, 0, 0};
+        for (double& v : pose)
+            in.number(&v);
+        if (!SceneIO::coordValid(pose[0]) || !SceneIO::coordValid(pose[1]) || !std::isfinite(pose[2]))
+        {
+            reject("data-pose");
+            return;
+        }
+        auto piece = std::make_shared<TangramPiece>(type, TangramGame::basePolygon(type));
+        piece->setPose({QPointF(pose[0], pose[1]), pose[2], pose[3] != 0});
+        poly = piece;
+    }
+    else
+    {
+        poly = std::make_shared<PolygonShape>(vertices);
+    }
+    poly->filled = st.fill.isValid();
+    if (poly->filled)
+        poly->fillColor = st.fill;
+    if (!applyStroke(*poly, f, st.stroke.isValid() ? st.stroke : st.fill, a)) return;
+    engine.addShape(poly);
+}
+
+void SvgImporter::addPoints(const SubPath& sp, const Frame& f, const QXmlStreamAttributes& a)
+{
+    const SvgStyle& st = f.style;
+    if (sp.arcSegment && !sp.closed && !st.fill.isValid())
+    {
+        addArc(sp.arc, f, a);
+        return;
+    }
+    if ((sp.closed || st.fill.isValid()) && sp.points.size() >= 3)
+    {
+        addPolygon(sp.points, f, a);
+        return;
+    }
+    if (!st.stroke.isValid()) return;
+
+    // 开放子路径：每段一条直线
+    const bool antialiased = a.value(QLatin1String("data-antialiased")) == QLatin1String("1");
+    for (std::size_t i = 1; i < sp.points.size(); ++i)
+    {
+        QPoint p0, p1;
+        if (!toPixel(f.ctm, sp.points[i - 1], &p0) || !toPixel(f.ctm, sp.points[i], &p1))
+            return;
+        if (i > 1 && p0 == p1) continue;
+        auto line = std::make_shared<LineShape>();
+        line->setEndpoints(p0, p1);
+        line->antialiased = antialiased;
+        if (!applyStroke(*line, f, st.stroke, a)) return;
+        engine.addShape(line);
+    }
+}
+
+/**
+ * @brief 椭圆弧 -> ArcShape
+ * 源圆弧是半径 R 的圆，椭圆的半轴比、旋转、圆心与 ctm 都放进 matrix；
+ * 圆心取映射后位置的整数部分，剩余的变换为单位矩阵时（本程序导出的圆弧）matrix 归为单位矩阵
+ */
+void SvgImporter::addArc(const EllipseArc& e, const Frame& f, const QXmlStreamAttributes& a)
+{
+    if (!f.style.stroke.isValid()) return;
+
+    const double sweep = std::min(std::fabs(e.delta), 360.0);
+    double start = std::fmod(e.delta >= 0 ? e.theta : e.theta + e.delta, 360.0);
+    if (start < 0) start += 360.0;
+    double end = start + sweep;
+    if (sweep >= 360.0 - 1e-9)
+    {
+        start = 0.0;
+        end = 360.0;
+    }
+    else if (end >= 360.0)
+    {
+        end -= 360.0;                                                   // start > end 表示跨越 0°
+    }
+
+    // data-angles 为导出时的原始起止角，扫过角度一致时直接使用
+    SvgScanner angles(a.value(QLatin1String("data-angles")).toString());
+    double a0, a1;
+    if (angles.number(&a0) && angles.number(&a1) && e.delta > 0
+        && std::fabs(ArcShape::sweepOf(a0, a1) - sweep) < 1e-6)
+    {
+        start = a0;
+        end = a1;
+    }
+
+    // 以原点为圆心、半径 rmax 的源圆经 m 映射为像素坐标中的椭圆弧
+    const double rmax = std::max(e.rx, e.ry);
+    QTransform m = QTransform::fromScale(e.rx / rmax, e.ry / rmax) * QTransform().rotate(e.phi)
+                   * QTransform::fromTranslate(e.center.x(), e.center.y())
+                   * f.ctm * QTransform::fromTranslate(-0.5, -0.5);
+
+    // m 为相似变换时缩放并入半径；半径不是整数时余下的比例留在 matrix
+    double radius = rmax;
+    const double k = std::hypot(m.m11(), m.m12());
+    if (std::fabs(k - std::hypot(m.m21(), m.m22())) < 1e-9 * k
+        && std::fabs(m.m11() * m.m21() + m.m12() * m.m22()) < 1e-9 * k * k)
+    {
+        radius *= k;
+        m = QTransform::fromScale(1 / k, 1 / k) * m;
+    }
+    if (!SceneIO::radiusValid(radius) || !SceneIO::matrixValid(m)
+        || !SceneIO::coordValid(m.dx()) || !SceneIO::coordValid(m.dy()))
+    {
+        reject("arc");
+        return;
+    }
+    const int r = std::max(1, qRound(radius));
+    if (std::fabs(radius - r) > 1e-6)
+        m = QTransform::fromScale(radius / r, radius / r) * m;
+
+    const QPoint c(qRound(m.dx()), qRound(m.dy()));
+    QTransform rest = QTransform::fromTranslate(-c.x(), -c.y()) * m;
+
+    const double eps = 1e-6;
+    if (std::fabs(rest.m11() - 1) < eps && std::fabs(rest.m22() - 1) < eps && std::fabs(rest.m12()) < eps
+        && std::fabs(rest.m21()) < eps && std::fabs(rest.dx()) < eps && std::fabs(rest.dy()) < eps)
+        rest = QTransform();
+
+    auto arc = std::make_shared<ArcShape>(c, r, start, end);
+    arc->matrix = rest;
+    if (!applyStroke(*arc, f, f.style.stroke, a)) return;
+    engine.addShape(arc);
+}
+
+/**
+ * @brief 本程序导出的椭圆（data-kind="ellipse"）：按 data-ellipse 重建源几何，元素坐标到像素的映射放进 matrix
+ * 导出时单位矩阵的椭圆坐标带 +0.5 且没有 transform 属性，其余的 transform 已含在 ctm 中
+ */
+bool SvgImporter::addEllipse(const Frame& f, const QXmlStreamAttributes& a)
+{
+    SvgScanner in(a.value(QLatin1String("data-ellipse")).toString());
+    double v[7];
+    for (double& x : v)
+    {
+        if (!in.number(&x)) return false;
+    }
+    if (v[2] <= 0 || v[3] <= 0 || v[6] < 0 || v[6] > int(EllipseShape::Form::Chord)) return false;
+    // 数值本身越界（而不是格式不对）时记为出错并视为已处理，不再按普通 <ellipse> 读取
+    if (!SceneIO::coordValid(v[0]) || !SceneIO::coordValid(v[1]) || !SceneIO::radiusValid(v[2])
+        || !SceneIO::radiusValid(v[3]) || !std::isfinite(v[4]) || !std::isfinite(v[5]) || !std::isfinite(v[6]))
+    {
+        reject("data-ellipse");
+        return true;
+    }
+
+    const double off = a.hasAttribute(QLatin1String("transform")) ? 0.0 : 0.5;
+    QTransform m = QTransform::fromTranslate(off, off) * f.ctm * QTransform::fromTranslate(-0.5, -0.5);
+    const double eps = 1e-6;
+    if (std::fabs(m.m11() - 1) < eps && std::fabs(m.m22() - 1) < eps && std::fabs(m.m12()) < eps
+        && std::fabs(m.m21()) < eps && std::fabs(m.dx()) < eps && std::fabs(m.dy()) < eps)
+        m = QTransform();
+    if (!SceneIO::matrixValid(m))
+    {
+        reject("transform");
+        return true;
+    }
+
+    auto ellipse = std::make_shared<EllipseShape>(QPoint(int(v[0]), int(v[1])), int(v[2]), int(v[3]));
+    ellipse->startAngle = v[4];
+    ellipse->endAngle = v[5];
+    ellipse->form = EllipseShape::Form(int(v[6]));
+    ellipse->matrix = m;
+    ellipse->filled = f.style.fill.isValid();
+    if (ellipse->filled)
+        ellipse->fillColor = f.style.fill;
+    if (applyStroke(*ellipse, f, f.style.stroke.isValid() ? f.style.stroke : f.style.fill, a))
+        engine.addShape(ellipse);
+    return true;
+}
+
+// 本程序导出的种子填充：每个子路径是一组整行像素的矩形，像素中心落在矩形内的像素属于该区间
+void SvgImporter::addSpans(const std::vector<SubPath>& paths, const Frame& f)
+{
+    std::vector<RasterFillShape::Span> spans;
+    spans.reserve(paths.size());
+    for (const SubPath& sp : paths)
+    {
+        if (sp.points.empty()) continue;
+        double left = HUGE_VAL, top = HUGE_VAL, right = -HUGE_VAL, bottom = -HUGE_VAL;
+        for (const QPointF& p : sp.points)
+        {
+            const QPointF q = f.ctm.map(p);
+            left = std::min(left, q.x());
+            right = std::max(right, q.x());
+            top = std::min(top, q.y());
+            bottom = std::max(bottom, q.y());
+        }
+        if (!SceneIO::coordValid(left) || !SceneIO::coordValid(right)
+            || !SceneIO::coordValid(top) || !SceneIO::coordValid(bottom))
+        {
+            reject("coordinate");
+            return;
+        }
+        const int x0 = int(std::ceil(left - 0.5)), x1 = int(std::ceil(right - 0.5)) - 1;
+        const int y0 = int(std::ceil(top - 0.5)), y1 = int(std::ceil(bottom - 0.5)) - 1;
+        if (x0 > x1) continue;
+        for (int y = y0; y <= y1; ++y)
+            spans.push_back({y, x0, x1});
+    }
+    if (spans.empty()) return;
+
+    auto less = [](const RasterFillShape::Span& a, const RasterFillShape::Span& b) {
+        return a.y != b.y ? a.y < b.y : a.x0 < b.x0;
+    };
+    if (!std::is_sorted(spans.begin(), spans.end(), less))
+        std::sort(spans.begin(), spans.end(), less);
+    engine.addShape(std::make_shared<RasterFillShape>(std::move(spans),
+                                                      f.style.fill.isValid() ? f.style.fill : QColor(Qt::black)));
+}
+
+void SvgImporter::element(const QString& name, const QXmlStreamAttributes& a, const Frame& f)
+{
+    const QString kind = a.value(QLatin1String("data-kind")).toString();
+    const double scale = scaleOf(f.ctm);
+    if (kind == QLatin1String("ellipse") && addEllipse(f, a))
+        return;
+
+    if (name == "line")
+    {
+        SubPath sp;
+        sp.points = {QPointF(number(a, "x1"), number(a, "y1")), QPointF(number(a, "x2"), number(a, "y2"))};
+        sp.segments = 1;
+        Frame lineFrame = f;
+        lineFrame.style.fill = QColor();                                // line 没有填充
+        addPoints(sp, lineFrame, a);
+    }
+    else if (name == "polyline" || name == "polygon")
+    {
+        SubPath sp;
+        SvgScanner in(a.value(QLatin1String("points")).toString());
+        double x, y;
+        while (in.number(&x) && in.number(&y))
+            sp.points.emplace_back(x, y);
+        sp.segments = int(sp.points.size()) - 1;
+        sp.closed = name == "polygon";
+        addPoints(sp, f, a);
+    }
+    else if (name == "rect")
+    {
+        if (kind == QLatin1String("background"))
+        {
+            if (header && f.style.fill.isValid()) header->background = f.style.fill;
+            return;
+        }
+        const double x = number(a, "x"), y = number(a, "y"), w = number(a, "width"), h = number(a, "height");
+        if (w <= 0 || h <= 0) return;
+        addPolygon({QPointF(x, y), QPointF(x + w, y), QPointF(x + w, y + h), QPointF(x, y + h)}, f, a);
+    }
+    else if (name == "circle" || name == "ellipse")
+    {
+        EllipseArc e;
+        e.center = QPointF(number(a, "cx"), number(a, "cy"));
+        e.rx = name == "circle" ? number(a, "r") : number(a, "rx");
+        e.ry = name == "circle" ? e.rx : number(a, "ry");
+        e.phi = 0;
+        e.theta = 0;
+        e.delta = 360;
+        if (e.rx <= 0 || e.ry <= 0) return;
+        if (!f.style.fill.isValid())
+        {
+            addArc(e, f, a);
+            return;
+        }
+        // 有填充时按折线化的多边形填充
+        SubPath sp;
+        const int n = std::max(8, arcSegments(360.0, std::max(e.rx, e.ry) * scale));
+        for (int i = 0; i < n; ++i)
+            sp.points.push_back(e.at(360.0 * i / n));
+        addPolygon(sp.points, f, a);
+    }
+    else if (name == "path")
+    {
+        const std::vector<SubPath> paths = parsePath(a.value(QLatin1String("d")).toString(), scale);
+        if (kind == QLatin1String("fill"))
+        {
+            addSpans(paths, f);
+            return;
+        }
+        for (const SubPath& sp : paths)
+            addPoints(sp, f, a);
+    }
+}
+
+// 不含可绘制图元、整个跳过的元素
+bool skippedElement(const QString& name)
+{
+    static const char* const names[] = {
+        "defs", "symbol", "clipPath", "mask", "pattern", "marker", "style", "script", "title", "desc",
+        "metadata", "linearGradient", "radialGradient", "filter", "text", "image", "foreignObject"
+    };
+    for (const char* n : names)
+        if (name == QLatin1String(n)) return true;
+    return false;
+}
+
+// 根元素：width / height 与 viewBox（preserveAspectRatio 只支持默认的居中等比与 none）
+Frame rootFrame(const QXmlStreamAttributes& a, SceneIO::SceneHeader* header)
+{
+    Frame f;
+    double w = -1, h = -1;
+    parseLength(a.value(QLatin1String("width")).toString(), &w);
+    parseLength(a.value(QLatin1String("height")).toString(), &h);
+
+    SvgScanner in(a.value(QLatin1String("viewBox")).toString());
+    double vb[4];
+    if (in.number(&vb[0]) && in.number(&vb[1]) && in.number(&vb[2]) && in.number(&vb[3]) && vb[2] > 0 && vb[3] > 0)
+    {
+        if (w <= 0) w = vb[2];
+        if (h <= 0) h = vb[3];
+        double sx = w / vb[2], sy = h / vb[3], tx = 0, ty = 0;
+        if (!a.value(QLatin1String("preserveAspectRatio")).startsWith(QLatin1String("none")))
+        {
+            sx = sy = std::min(sx, sy);
+            tx = (w - vb[2] * sx) / 2;
+            ty = (h - vb[3] * sy) / 2;
+        }
+        f.ctm = QTransform::fromTranslate(-vb[0], -vb[1]) * QTransform::fromScale(sx, sy)
+                * QTransform::fromTranslate(tx, ty);
+    }
+    if (header && w > 0 && h > 0 && w <= SceneIO::MAX_COORD && h <= SceneIO::MAX_COORD)
+        header->size = QSize(int(std::ceil(w)), int(std::ceil(h)));
+
+    applyPresentation(f.style, a);
+    return f;
+}
+
+} // namespace
+
+bool SceneSvg::save(const QString& path, const DrawEngine& engine, const QColor& background,
+                    QString* error, const SceneIO::Progress& progress)
+{
+    return writeSvg(path, engine.getCanvas().size(), background, qint64(engine.shapeCount()),
+                    [&engine](auto write) {
+                        for (const auto& s : engine.getShapes())
+                            write(*s);
+                    },
+                    error, progress);
+}
+
+bool SceneSvg::save(const QString& path, const SceneSnapshot& scene,
+                    QString* error, const SceneIO::Progress& progress)
+{
+    return writeSvg(path, scene.canvasSize(), QColor::fromRgb(scene.background()), qint64(scene.size()),
+                    [&scene](auto write) { scene.forEach(write); },
+                    error, progress);
+}
+
+bool SceneSvg::load(const QString& path, DrawEngine& engine, SceneIO::SceneHeader* header,
+                    QString* error, const SceneIO::Progress& progress)
+{
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly))
+    {
+        if (error) *error = QString("cannot open %1").arg(path);
+        return false;
+    }
+
+    // 整张画布一次标脏，逐个加入的图元不再各自合并脏矩形
+    engine.invalidateAll();
+
+    const qint64 total = file.size();
+    QXmlStreamReader xml(&file);
+    SvgImporter importer(engine, header);
+    std::vector<Frame> stack;                                           // 每个打开的元素一层
+    qint64 elements = 0;
+
+    while (!xml.atEnd())
+    {
+        const QXmlStreamReader::TokenType token = xml.readNext();
+        if (token == QXmlStreamReader::EndElement)
+        {
+            if (!stack.empty()) stack.pop_back();
+            continue;
+        }
+        if (token != QXmlStreamReader::StartElement) continue;
+
+        if (progress && ++elements % SceneIO::PROGRESS_STEP == 0 && !progress(file.pos(), total))
+        {
+            if (error) *error = "cancelled";
+            return false;
+        }
+
+        const QString name = xml.name().toString();
+        const QXmlStreamAttributes a = xml.attributes();
+        if (stack.empty())
+        {
+            if (name != "svg")
+            {
+                if (error) *error = QString("line %1: not an SVG document").arg(xml.lineNumber());
+                return false;
+            }
+            stack.push_back(rootFrame(a, header));
+            continue;
+        }
+        if (skippedElement(name))
+        {
+            xml.skipCurrentElement();
+            continue;
+        }
+
+        Frame f = stack.back();
+        const QString transform = a.value(QLatin1String("transform")).toString();
+        if (!transform.isEmpty())
+            f.ctm = parseTransform(transform) * f.ctm;
+        applyPresentation(f.style, a);
+        importer.element(name, a, f);
+        if (!importer.rejection().isEmpty())
+        {
+            if (error) *error = QString("line %1: %2").arg(xml.lineNumber()).arg(importer.rejection());
+            return false;
+        }
+        stack.push_back(std::move(f));
+    }
+
+    if (xml.hasError())
+    {
+        if (error) *error = QString("line %1: %2").arg(xml.lineNumber()).arg(xml.errorString());
+        return false;
+    }
+    if (progress) progress(total, total);
+    return true;
+}
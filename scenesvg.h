@@ -0,0 +1,38 @@
+#ifndef SCENESVG_H
+#define SCENESVG_H
+
+#include "sceneio.h"
+
+/**
+ * @brief SceneSvg —— 场景与 SVG 的流式导出 / 导入
+ *
+ * 导出：QXmlStreamWriter 逐个图元写出元素，不在内存中拼出整个文档
+ *  - 像素 (x, y) 对应 SVG 中以 (x + 0.5, y + 0.5) 为中心的单位方块，1 像素线在其它工具中也落在像素格上
+ *  - line -> <line>（抗锯齿细线带 data-antialiased="1"），polygon -> <polygon>，arc -> <path> 圆弧段（整圆为 <circle>，累积变换写入 transform）
+ *  - fill -> 每个 span 一个单位高矩形子路径的 <path>；tangram -> 带 data-piece / data-pose 的 <polygon>
+ *  - 线宽、线帽、连接与线型（stroke-dasharray，按 DrawEngine::linePattern 的节奏乘以线宽）写成描边属性
+ *  - 背景为第一个元素 <rect data-kind="background">
+ *
+ * 导入：QXmlStreamReader 边解析边 addShape，内存只与当前元素有关，可读入数百 MB 的文件
+ *  - 支持 line / polyline / polygon / rect / circle / ellipse / path（M L H V C S Q T A Z，含相对命令），
+ *    以及 <g> 与元素上的 transform、表现属性与 style 属性的继承；其余元素（文字、图片、defs 等）跳过
+ *  - 单段圆弧子路径、circle 与 ellipse 还原为 ArcShape（椭圆与非等比缩放进入 matrix），
+ *    其余曲线折线化：闭合或有填充的子路径成为 PolygonShape，开放子路径拆成 LineShape
+ *  - stroke-dasharray 按画 / 空段数与比例映射到最接近的 LineStyle
+ *  - 坐标、半径超出 SceneIO 的读入范围或不是有限值时加载失败（error 给出行号），线宽限制到 1..MAX_PEN_WIDTH
+ */
+namespace SceneSvg
+{
+    // 写出场景 / 快照（按绘制顺序）
+    bool save(const QString& path, const DrawEngine& engine, const QColor& background = Qt::white,
+              QString* error = nullptr, const SceneIO::Progress& progress = SceneIO::Progress());
+    bool save(const QString& path, const SceneSnapshot& scene,
+              QString* error = nullptr, const SceneIO::Progress& progress = SceneIO::Progress());
+
+    // 读取 SVG：图元依次 addShape 到 engine；header 非空时返回画布尺寸与背景色
+    // 返回 false 表示文件无法打开、XML 不合法或被 progress 中止（error 给出行号与原因）
+    bool load(const QString& path, DrawEngine& engine, SceneIO::SceneHeader* header = nullptr,
+              QString* error = nullptr, const SceneIO::Progress& progress = SceneIO::Progress());
+}
+
+#endif // SCENESVG_H
@@ -1,36 +1,27 @@
 #include "selecttool.h"
 #include "drawengine.h"
 #include "shape.h"
-#include "lineshape.h"
-#include "arcshape.h"
-#include "polygonshape.h"
 
 #include <QMouseEvent>
 #include <QPainter>
 #include <algorithm>
 
-static QPointF transform_point_about_ref(const QPointF &p,
-                                         const QPointF &ref,
-                                         double sx, double sy,
-                                         double angleDeg,
-                                         double tx, double ty)
+// 绕参考点 ref：先缩放 (sx, sy)，再旋转 angleDeg，最后平移 (tx, ty)
+// x' = R·S·(x - ref) + ref + t，展开为一个仿射矩阵，所有图元共用
+static QTransform transform_about_ref(const QPointF &ref,
+                                      double sx, double sy,
+                                      double angleDeg,
+                                      double tx, double ty)
 {
-    double x = p.x() - ref.x();
-    double y = p.y() - ref.y();
-
-    x *= sx;
-    y *= sy;
-
     double a = angleDeg * M_PI / 180.0;
     double cosA = std::cos(a);
     double sinA = std::sin(a);
-    double xr = x * cosA - y * sinA;
-    double yr = x * sinA + y * cosA;
 
-    double xf = xr + ref.x() + tx;
-    double yf = yr + ref.y() + ty;
-
-    return QPointF(xf, yf);
+    double m11 = sx * cosA, m12 = sx * sinA;
+    double m21 = -sy * sinA, m22 = sy * cosA;
+    double dx = ref.x() + tx - (m11 * ref.x() + m21 * ref.y());
+    double dy = ref.y() + ty - (m12 * ref.x() + m22 * ref.y());
+    return QTransform(m11, m12, m21, m22, dx, dy);
 }
 
 
@@ -59,36 +50,14 @@ void SelectTool::onMousePress(QMouseEvent* e, DrawEngine* engine)
 
         for (auto &sp : selectedShapes)
         {
-            // 只对具有顶点的 shape 做查找：LineShape (2 pts), PolygonShape (vertices), BezierShape (controlPoints)
-            // 需要 dynamic cast 检查具体类型
-            if (auto line = std::dynamic_pointer_cast<LineShape>(sp)) {
-                QPoint vs[2] = { line->start, line->end };
-                for (int i=0;i<2;++i) {
-                    double dx = vs[i].x() - clicked.x();
-                    double dy = vs[i].y() - clicked.y();
-                    double d2 = dx*dx + dy*dy;
-                    if (d2 <= bestDist2) { bestDist2 = d2; bestShape = sp; bestIndex = i; }
-                }
-            } else if (auto poly = std::dynamic_pointer_cast<PolygonShape>(sp)) {
-                for (int i=0;i<(int)poly->vertices.size();++i) {
-                    QPoint v = poly->vertices[i];
-                    double dx = v.x() - clicked.x(), dy = v.y() - clicked.y();
-                    double d2 = dx*dx + dy*dy;
-                    if (d2 <= bestDist2) { bestDist2 = d2; bestShape = sp; bestIndex = i; }
-                }
-            } /*else if (auto bez = std::dynamic_pointer_cast<BezierShape>(sp)) {
-                for (int i=0;i<(int)bez->controlPoints.size();++i) {
-                    QPointF v = bez->controlPoints[i];
-                    double dx = v.x() - clicked.x(), dy = v.y() - clicked.y();
-                    double d2 = dx*dx + dy*dy;
-                    if (d2 <= bestDist2) { bestDist2 = d2; bestShape = sp; bestIndex = i; }
-                }
-            }*/
-            // ArcShape: 可以检测圆心是否接近
-            else if (auto arc = std::dynamic_pointer_cast<ArcShape>(sp)) {
-                double dx = arc->center.x() - clicked.x(), dy = arc->center.y() - clicked.y();
+            // 控制点：直线端点、多边形顶点、圆弧圆心等（由图元自己提供）
+            const int n = sp->controlPointCount();
+            for (int i = 0; i < n; ++i)
+            {
+                QPointF v = sp->controlPoint(i);
+                double dx = v.x() - clicked.x(), dy = v.y() - clicked.y();
                 double d2 = dx*dx + dy*dy;
-                if (d2 <= bestDist2) { bestDist2 = d2; bestShape = sp; bestIndex = 0; } // vertexIndex 0 表示圆心
+                if (d2 <= bestDist2) { bestDist2 = d2; bestShape = sp; bestIndex = i; }
             }
         }
 
@@ -96,16 +65,7 @@ void SelectTool::onMousePress(QMouseEvent* e, DrawEngine* engine)
             // pick 成功，记录为顶点引用
             pickedRefShape = bestShape;
             pickedRefVertexIndex = bestIndex;
-
-            if (auto line = std::dynamic_pointer_cast<LineShape>(bestShape)) {
-                pickedRefPoint = (bestIndex==0) ? QPointF(line->start) : QPointF(line->end);
-            } else if (auto poly = std::dynamic_pointer_cast<PolygonShape>(bestShape)) {
-                pickedRefPoint = QPointF(poly->vertices[bestIndex]);
-            } /*else if (auto bez = std::dynamic_pointer_cast<BezierShape>(bestShape)) {
-                pickedRefPoint = bez->controlPoints[bestIndex];
-            }*/ else if (auto arc = std::dynamic_pointer_cast<ArcShape>(bestShape)) {
-                pickedRefPoint = QPointF(arc->center);
-            }
+            pickedRefPoint = bestShape->controlPoint(bestIndex);
         } else {
             // 没找到顶点，直接把点击点当作 canvas point
             pickedRefShape.reset();
@@ -152,18 +112,11 @@ void SelectTool::onMouseRelease(QMouseEvent* e, DrawEngine* engine)
 
     selectedShapes.clear();
 
-    auto shapes = engine->getShapes();
     if (dx <= CLICK_THRESH && dy <= CLICK_THRESH)
     {
-        // 单击：从后向前选（顶层优先）
-        for (auto it = shapes.rbegin(); it != shapes.rend(); ++it)
-        {
-            if ((*it)->contains(dragEnd))
-            {
-                selectedShapes.push_back(*it);
-                break;
-            }
-        }
+        // 单击：空间索引给出点附近的图元，取最上层命中的一个
+        if (auto hit = engine->shapeAt(dragEnd))
+            selectedShapes.push_back(hit);
     }
     else
     {
@@ -173,7 +126,8 @@ void SelectTool::onMouseRelease(QMouseEvent* e, DrawEngine* engine)
         int ymin = std::min(dragStart.y(), dragEnd.y());
         int ymax = std::max(dragStart.y(), dragEnd.y());
 
-        for (auto &sp : shapes)
+        // 重心落在矩形内的图元，其包围盒必与矩形相交：只检查索引返回的候选
+        for (auto &sp : engine->shapesInRect(QRect(QPoint(xmin, ymin), QPoint(xmax, ymax))))
         {
             QPointF c = sp->centroid();
             if (c.x() >= xmin && c.x() <= xmax && c.y() >= ymin && c.y() <= ymax)
@@ -185,75 +139,79 @@ void SelectTool::onMouseRelease(QMouseEvent* e, DrawEngine* engine)
     useCustomRef = false;
 }
 
-void SelectTool::applyTransformToSelection_params(double tx, double ty,
-                                                  double sx, double sy,
-                                                  double angleDeg,
-                                                  const QPointF &ref,
-                                                  DrawEngine* engine)
+void SelectTool::applyTransformToSelection(const QTransform& t, DrawEngine* engine)
 {
     if (!engine) return;
 
-    // 遍历所有被选图形并对其几何顶点做逐点变换
-    for (auto &sp : selectedShapes)
-    {
-        // LineShape
-        if (auto line = std::dynamic_pointer_cast<LineShape>(sp))
-        {
-            QPointF s = transform_point_about_ref(QPointF(line->start), ref, sx, sy, angleDeg, tx, ty);
-            QPointF e = transform_point_about_ref(QPointF(line->end),   ref, sx, sy, angleDeg, tx, ty);
-
-            line->start = QPoint(int(std::round(s.x())), int(std::round(s.y())));
-            line->end   = QPoint(int(std::round(e.x())), int(std::round(e.y())));
-
-            engine->redrawShape(line);
-            continue;
-        }
-
-        // PolygonShape
-        if (auto poly = std::dynamic_pointer_cast<PolygonShape>(sp))
-        {
-            for (auto &pt : poly->vertices)
-            {
-                QPointF qf = transform_point_about_ref(QPointF(pt), ref, sx, sy, angleDeg, tx, ty);
-                pt = QPoint(int(std::round(qf.x())), int(std::round(qf.y())));
-            }
-            engine->redrawShape(poly);
-            continue;
-        }
+    if (selectedShapes.empty()) return;
 
-        // ArcShape
-        if (auto arc = std::dynamic_pointer_cast<ArcShape>(sp))
-        {
-            QPointF newCenter = transform_point_about_ref(QPointF(arc->center), ref, sx, sy, angleDeg, tx, ty);
+    // 可逆变换只记录矩阵；不可逆（缩放为 0）时逐个记录变换前后的几何
+    History& history = engine->getHistory();
+    const bool invertible = t.isInvertible();
+    std::vector<GeometryState> before;
+    if (!invertible)
+    {
+        before.reserve(selectedShapes.size());
+        for (auto &sp : selectedShapes)
+            before.push_back(GeometryState::capture(*sp));
+    }
 
-            double scaleApprox = (std::abs(sx) + std::abs(sy)) * 0.5;
-            double newR = arc->radius * scaleApprox;
+    // 逐个图元施加：各自把变换累积到自己的矩阵，再由自己的源几何解析顶点（PointTransform）并通知引擎重绘
+    for (auto &sp : selectedShapes)
+        sp->transform(t);
 
-            arc->center = QPoint(int(std::round(newCenter.x())), int(std::round(newCenter.y())));
-            arc->radius = std::max(0, int(std::round(newR)));
+    if (invertible)
+    {
+        history.push(std::make_unique<TransformCommand>(selectedShapes, t));
+        return;
+    }
+    history.beginMacro();
+    for (std::size_t i = 0; i < selectedShapes.size(); ++i)
+    {
+        auto cmd = std::make_unique<GeometryCommand>(selectedShapes[i], before[i],
+                                                     GeometryState::capture(*selectedShapes[i]));
+        if (!cmd->isEmpty())
+            history.push(std::move(cmd));
+    }
+    history.endMacro();
+}
 
-            arc->startAngle += angleDeg;
-            arc->endAngle   += angleDeg;
+void SelectTool::applyPenToSelection(DrawEngine* engine)
+{
+    if (!engine || selectedShapes.empty()) return;
 
-            if (arc->startAngle >= 360.0) arc->startAngle = fmod(arc->startAngle, 360.0);
-            if (arc->endAngle >= 360.0)   arc->endAngle   = fmod(arc->endAngle,   360.0);
+    const int width = engine->getPenWidth();
+    const LineStyle style = engine->getLineStyle();
+    const LineCap cap = engine->getLineCap();
+    const LineJoin join = engine->getLineJoin();
 
-            engine->redrawShape(arc);
+    // 样式没有变化的图元不记录；apply() 会通知引擎重绘
+    History& history = engine->getHistory();
+    history.beginMacro();
+    for (auto &sp : selectedShapes)
+    {
+        const ShapeStyle before = ShapeStyle::capture(*sp);
+        if (before.penWidth == width && before.lineStyle == style
+            && before.lineCap == cap && before.lineJoin == join)
             continue;
-        }
-
-        // BezierShape
-        // if (auto bez = std::dynamic_pointer_cast<BezierShape>(sp))
-        // {
-        //     for (auto &cp : bez->controlPoints)
-        //     {
-        //         QPointF qf = transform_point_about_ref(cp, ref, sx, sy, angleDeg, tx, ty);
-        //         cp = QPointF(qf.x(), qf.y());
-        //     }
-        //     engine->redrawShape(bez);
-        //     continue;
-        // }
+        ShapeStyle after = before;
+        after.penWidth = width;
+        after.lineStyle = style;
+        after.lineCap = cap;
+        after.lineJoin = join;
+        after.apply(*sp);
+        history.push(std::make_unique<StyleCommand>(sp, before, after));
     }
+    history.endMacro();
+}
+
+void SelectTool::applyTransformToSelection_params(double tx, double ty,
+                                                  double sx, double sy,
+                                                  double angleDeg,
+                                                  const QPointF &ref,
+                                                  DrawEngine* engine)
+{
+    applyTransformToSelection(transform_about_ref(ref, sx, sy, angleDeg, tx, ty), engine);
 }
 
 
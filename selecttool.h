@@ -26,6 +26,9 @@ public:
                                                       const QPointF &ref,
                                           DrawEngine* engine);
 
+    // 把引擎当前的画笔（线宽 / 线型 / 线帽 / 连接）应用到全部选中图元，记为一步撤销
+    void applyPenToSelection(DrawEngine* engine);
+
     // Set reference point for transforms (used when user picks a custom point)
     void setReferencePoint(const QPointF& p) { referencePoint = p; useCustomRef = true; }
 
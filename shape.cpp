@@ -0,0 +1,19 @@
+#include "shape.h"
+#include "drawengine.h"
+
+/**
+ * @brief 通知所属引擎图元已修改
+ * 未加入任何引擎的图元（例如工具中尚未提交的临时对象）直接忽略
+ */
+void Shape::invalidate()
+{
+    if (owner)
+        owner->shapeChanged(this);
+}
+
+std::shared_ptr<Shape> Shape::clone() const
+{
+    std::shared_ptr<Shape> c = cloneShape();
+    c->owner = nullptr;
+    return c;
+}
@@ -2,11 +2,19 @@
 #define SHAPE_H
 
 #include <QPoint>
+#include <QRect>
 #include <QColor>
 #include <QTransform>
+#include <algorithm>
+#include <cmath>
+#include "shaperegistry.h"
 
 enum class LineStyle {Solid, Dash, Dot, DashDot};
 enum class LineCap {Flat, Square, Round};
+enum class LineJoin {Miter, Bevel, Round};
+
+// 具体图元类型标签：工具与场景读写按标签分派，不做 RTTI 转换
+enum class ShapeKind : quint8 {Line, Arc, Polygon, RasterFill, TangramPiece, Ellipse};
 
 class DrawEngine;
 
@@ -16,13 +24,22 @@ class DrawEngine;
  * 所有具体图形（直线、矩形、圆、多边形等）都应继承自该类，
  * 并实现其纯虚函数：
  *  - draw()：定义如何在 DrawEngine 的像素画布上绘制自己；
- *  - contains()：定义如何判断某个点是否落在该图形内部，用于选中或编辑功能。
+ *  - contains()：定义如何判断某个点是否落在该图形内部，用于选中或编辑功能；
+ *  - boundingRect()：返回绘制时可能写到的像素范围，用于脏矩形重绘。
+ *
+ * 几何编辑（变换、裁剪、控制点）是虚函数，工具只通过这些接口操作图元，
+ * 新的图元类型实现它们即可接入全部工具；不支持某项编辑的图元使用默认实现。
+ *
+ * 修改几何或样式字段后必须调用 invalidate()，所属 DrawEngine 才会重绘对应区域。
  */
 class Shape
 {
 public:
     virtual ~Shape() = default;
 
+    // 具体图元类型（构造时确定）
+    ShapeKind kind() const { return shapeKind; }
+
     /**
      * @brief 在 DrawEngine 的画布上绘制该图形
      * @param engine 绘图引擎指针（提供 setPixel 接口）
@@ -39,11 +56,75 @@ public:
     // 返回图形重心（浮点坐标，便于变换）
     virtual QPointF centroid() const { return QPointF(0.0, 0.0); }
 
+    /**
+     * @brief 图形在画布上的像素包围盒（包含线宽扩展）
+     * @return 空矩形表示不绘制任何像素
+     */
+    virtual QRect boundingRect() const = 0;
+
+    // 是否把光栅化结果录制进引擎的光栅缓存（本身已是 span 形式的图元返回 false）
+    virtual bool cacheRaster() const { return true; }
+
+    /**
+     * @brief 对几何做仿射变换：累积到 matrix，再由源几何重新解析绘制用坐标；修改后自行调用 invalidate()
+     * 源几何不被改写，反复变换不会累积取整误差。默认实现不做任何事（不可变换的图元）
+     */
+    virtual void transform(const QTransform&) {}
+
+    /**
+     * @brief 裁剪到矩形窗口（闭区间），修改后自行调用 invalidate()
+     * @return false 表示图元完全位于窗口外，应由调用者删除；不支持裁剪的图元保持不变并返回 true
+     */
+    virtual bool clipToRect(const QRect&, const DrawEngine&) { return true; }
+
+    // 控制点（端点、顶点、圆心），用于拾取参考点等编辑操作
+    virtual int controlPointCount() const { return 0; }
+    virtual QPointF controlPoint(int) const { return QPointF(); }
+
+    // 深拷贝（场景快照使用）：副本不属于任何引擎，id / zOrder 等字段与原图元相同
+    std::shared_ptr<Shape> clone() const;
+
+    /**
+     * @brief 通知所属 DrawEngine：几何或样式已改变
+     * 引擎会把旧包围盒与新包围盒都加入脏区域，下一帧只重绘这部分
+     */
+    void invalidate();
+
+    // 描边向几何路径外扩展的最大像素数（用于包围盒）：
+    // 半线宽，方头线帽在斜线上最多外延 √2 倍，斜接连接最多外延 Stroker::MITER_LIMIT (4) 倍
+    int strokeRadius() const
+    {
+        if (penWidth <= 1) return 1;
+        double k = lineJoin == LineJoin::Miter ? 4.0 : (lineCap == LineCap::Square ? 1.415 : 1.0);
+        return int(std::ceil(penWidth * 0.5 * k)) + 1;
+    }
+
     QColor color = Qt::black;                                       // 绘制颜色
     int penWidth = 1;                                               // 线宽
     LineStyle lineStyle = LineStyle::Solid;                         // 线型
     LineCap lineCap = LineCap::Round;                               // 线帽
+    LineJoin lineJoin = LineJoin::Round;                            // 折线连接（多边形描边）
     int dashOffset = 0;
+
+    // 源几何上累积的仿射变换（直线、多边形、圆弧使用；重新设置几何时归为单位矩阵）
+    QTransform matrix;
+
+    // 以下字段由 DrawEngine 维护
+    DrawEngine* owner = nullptr;                                    // 所属引擎（addShape 时设置）
+    QRect paintedBounds;                                            // 最近一次登记到引擎的包围盒
+    ShapeId id = 0;                                                 // 在所属引擎图元表中的句柄
+    qint64 zOrder = 0;                                              // 绘制序号（越大越靠上层）
+    bool recentlyChanged = true;                                    // 刚被修改（编辑中），暂不写入光栅缓存
+    bool snapshotStale = true;                                      // 上一次发布的场景快照中没有它的当前状态
+
+protected:
+    explicit Shape(ShapeKind k) : shapeKind(k) {}
+
+    // 按具体类型拷贝构造
+    virtual std::shared_ptr<Shape> cloneShape() const = 0;
+
+private:
+    ShapeKind shapeKind;
 };
 
 #endif // SHAPE_H
@@ -0,0 +1,140 @@
+#include "shaperegistry.h"
+#include "shape.h"
+#include <algorithm>
+
+namespace {
+
+inline quint32 slotIndex(ShapeId id) { return quint32(id & 0xffffffffu) - 1; }
+inline quint32 slotGeneration(ShapeId id) { return quint32(id >> 32); }
+inline ShapeId makeId(quint32 index, quint32 generation) { return (ShapeId(generation) << 32) | (index + 1); }
+
+} // namespace
+
+const ShapeRegistry::Slot* ShapeRegistry::slotOf(ShapeId id) const
+{
+    if ((id & 0xffffffffu) == 0) return nullptr;
+    const quint32 index = slotIndex(id);
+    if (index >= table.size()) return nullptr;
+    const Slot& slot = table[index];
+    if (!slot.shape || slot.generation != slotGeneration(id)) return nullptr;
+    return &slot;
+}
+
+ShapeRegistry::Slot* ShapeRegistry::slotOf(ShapeId id)
+{
+    return const_cast<Slot*>(static_cast<const ShapeRegistry*>(this)->slotOf(id));
+}
+
+ShapeId ShapeRegistry::allocate(const std::shared_ptr<Shape>& s)
+{
+    quint32 index;
+    if (!freeSlots.empty())
+    {
+        index = freeSlots.back();
+        freeSlots.pop_back();
+    }
+    else
+    {
+        index = quint32(table.size());
+        table.emplace_back();
+    }
+    table[index].shape = s;
+    s->id = makeId(index, table[index].generation);
+    return s->id;
+}
+
+ShapeId ShapeRegistry::add(const std::shared_ptr<Shape>& s)
+{
+    if (!s) return 0;
+    ShapeId id = allocate(s);
+    s->zOrder = order.empty() ? (topZ = bottomZ = 0) : ++topZ;
+    order.emplace(s->zOrder, s.get());
+    snapshotValid = false;
+    return id;
+}
+
+ShapeId ShapeRegistry::addAt(const std::shared_ptr<Shape>& s, qint64 z)
+{
+    if (!s || order.count(z)) return 0;
+    ShapeId id = allocate(s);
+    s->zOrder = z;
+    order.emplace(z, s.get());
+    if (order.size() == 1)
+        topZ = bottomZ = z;
+    topZ = std::max(topZ, z);
+    bottomZ = std::min(bottomZ, z);
+    snapshotValid = false;
+    return id;
+}
+
+std::shared_ptr<Shape> ShapeRegistry::remove(ShapeId id)
+{
+    Slot* slot = slotOf(id);
+    if (!slot) return nullptr;
+
+    std::shared_ptr<Shape> s = std::move(slot->shape);
+    slot->shape.reset();
+    ++slot->generation;
+    freeSlots.push_back(slotIndex(id));
+    order.erase(s->zOrder);
+    s->id = 0;
+    snapshotValid = false;
+    return s;
+}
+
+std::shared_ptr<Shape> ShapeRegistry::find(ShapeId id) const
+{
+    const Slot* slot = slotOf(id);
+    return slot ? slot->shape : nullptr;
+}
+
+void ShapeRegistry::setZOrder(Shape* s, qint64 z)
+{
+    order.erase(s->zOrder);
+    s->zOrder = z;
+    order.emplace(z, s);
+    snapshotValid = false;
+}
+
+void ShapeRegistry::bringToFront(ShapeId id)
+{
+    Slot* slot = slotOf(id);
+    if (!slot || slot->shape->zOrder == topZ) return;
+    setZOrder(slot->shape.get(), ++topZ);
+}
+
+void ShapeRegistry::sendToBack(ShapeId id)
+{
+    Slot* slot = slotOf(id);
+    if (!slot || slot->shape->zOrder == bottomZ) return;
+    setZOrder(slot->shape.get(), --bottomZ);
+}
+
+void ShapeRegistry::clear()
+{
+    for (Slot& slot : table)
+    {
+        if (slot.shape)
+            slot.shape->id = 0;
+    }
+    table.clear();
+    freeSlots.clear();
+    order.clear();
+    topZ = 0;
+    bottomZ = 1;
+    snapshot.clear();
+    snapshotValid = true;
+}
+
+const std::vector<std::shared_ptr<Shape>>& ShapeRegistry::ordered() const
+{
+    if (!snapshotValid)
+    {
+        snapshot.clear();
+        snapshot.reserve(order.size());
+        for (const auto& kv : order)
+            snapshot.push_back(slotOf(kv.second->id)->shape);
+        snapshotValid = true;
+    }
+    return snapshot;
+}
@@ -0,0 +1,78 @@
+#ifndef SHAPEREGISTRY_H
+#define SHAPEREGISTRY_H
+
+#include <QtGlobal>
+#include <vector>
+#include <map>
+#include <memory>
+#include <cstddef>
+
+class Shape;
+
+// 图元句柄：低 32 位为槽位下标 + 1，高 32 位为槽位代数；0 表示无效
+using ShapeId = quint64;
+
+/**
+ * @brief ShapeRegistry —— DrawEngine 的图元表
+ *
+ * - 槽位表（slot map）：图元登记后得到稳定的 ShapeId，按 id 查找 / 删除为 O(1)，
+ *   槽位释放后代数加一，旧 id 不会误指向复用该槽位的新图元
+ * - 绘制顺序：以 Shape::zOrder 为键的有序表，置顶 / 置底只修改一个图元的键，O(log n)
+ *   置顶取当前最大键 + 1，置底取当前最小键 - 1，其余图元的键保持不变
+ * - ordered() 按绘制顺序返回全部图元，结果缓存到下一次增删或调整顺序为止
+ */
+class ShapeRegistry
+{
+public:
+    // 登记图元并放到最上层
+    ShapeId add(const std::shared_ptr<Shape>& s);
+    // 按指定绘制序号登记（撤销删除等需要回到原位置的场景），序号已被占用时返回 0
+    ShapeId addAt(const std::shared_ptr<Shape>& s, qint64 z);
+
+    // 注销图元，返回其 shared_ptr（id 无效时返回 nullptr）
+    std::shared_ptr<Shape> remove(ShapeId id);
+
+    std::shared_ptr<Shape> find(ShapeId id) const;
+    bool contains(ShapeId id) const { return slotOf(id) != nullptr; }
+
+    void bringToFront(ShapeId id);
+    void sendToBack(ShapeId id);
+
+    void clear();
+    std::size_t size() const { return order.size(); }
+    bool empty() const { return order.empty(); }
+
+    // 按绘制顺序（底层在前）排列的全部图元
+    const std::vector<std::shared_ptr<Shape>>& ordered() const;
+
+    // 按绘制顺序遍历，不生成快照
+    template <class F>
+    void forEach(F f) const
+    {
+        for (const auto& kv : order)
+            f(kv.second);
+    }
+
+private:
+    struct Slot
+    {
+        std::shared_ptr<Shape> shape;
+        quint32 generation = 1;
+    };
+
+    const Slot* slotOf(ShapeId id) const;
+    Slot* slotOf(ShapeId id);
+    ShapeId allocate(const std::shared_ptr<Shape>& s);
+    void setZOrder(Shape* s, qint64 z);
+
+    std::vector<Slot> table;
+    std::vector<quint32> freeSlots;
+    std::map<qint64, Shape*> order;                                     // zOrder -> 图元
+    qint64 topZ = 0;                                                    // 已分配的最大序号
+    qint64 bottomZ = 1;                                                 // 已分配的最小序号
+
+    mutable std::vector<std::shared_ptr<Shape>> snapshot;
+    mutable bool snapshotValid = true;
+};
+
+#endif // SHAPEREGISTRY_H
@@ -0,0 +1,159 @@
+#include "spatialindex.h"
+#include "shape.h"
+#include <algorithm>
+
+SpatialIndex::SpatialIndex()
+{
+    clear();
+}
+
+SpatialIndex::~SpatialIndex() = default;
+
+void SpatialIndex::clear()
+{
+    where.clear();
+    root = std::make_unique<Node>();
+    root->x = -WORLD_SIZE / 2;
+    root->y = -WORLD_SIZE / 2;
+    root->size = WORLD_SIZE;
+    // 根节点还挂着中心在世界范围外的图元，松散边界取整个整数平面
+    root->loose = QRect(QPoint(-(1 << 30), -(1 << 30)), QPoint(1 << 30, 1 << 30));
+}
+
+SpatialIndex::Node* SpatialIndex::makeChild(Node* parent, int q)
+{
+    auto c = std::make_unique<Node>();
+    c->size = parent->size / 2;
+    c->x = parent->x + ((q & 1) ? c->size : 0);
+    c->y = parent->y + ((q & 2) ? c->size : 0);
+    c->loose = QRect(c->x - c->size / 2, c->y - c->size / 2, c->size * 2, c->size * 2);
+    c->parent = parent;
+    c->quadrant = q;
+    parent->child[q] = std::move(c);
+    return parent->child[q].get();
+}
+
+SpatialIndex::Node* SpatialIndex::targetNode(const QRect& bounds, bool create)
+{
+    const QPoint c = bounds.center();
+    const int extent = std::max(std::max(bounds.width(), bounds.height()), MIN_CELL);
+
+    Node* node = root.get();
+    if (bounds.isEmpty() || c.x() < node->x || c.y() < node->y ||
+        c.x() >= node->x + node->size || c.y() >= node->y + node->size)
+        return node;
+
+    // 子格子边长仍能容纳包围盒时继续下降
+    while (node->size / 2 >= extent)
+    {
+        const int half = node->size / 2;
+        const int q = (c.x() >= node->x + half ? 1 : 0) | (c.y() >= node->y + half ? 2 : 0);
+        if (!node->child[q])
+        {
+            if (!create) return nullptr;
+            makeChild(node, q);
+        }
+        node = node->child[q].get();
+    }
+    return node;
+}
+
+void SpatialIndex::insertAt(Node* node, const std::shared_ptr<Shape>& s, const QRect& bounds)
+{
+    where[s.get()] = {node, node->items.size()};
+    node->items.push_back({s, bounds});
+    for (Node* n = node; n; n = n->parent)
+        ++n->total;
+}
+
+void SpatialIndex::removeAt(const Location& loc)
+{
+    Node* node = loc.node;
+    auto& items = node->items;
+    if (loc.slot + 1 != items.size())
+    {
+        items[loc.slot] = std::move(items.back());
+        where[items[loc.slot].shape.get()].slot = loc.slot;
+    }
+    items.pop_back();
+
+    // 更新计数；释放最高的一棵空子树（根节点保留）
+    Node* emptyTop = nullptr;
+    for (Node* n = node; n; n = n->parent)
+    {
+        if (--n->total == 0 && n->parent)
+            emptyTop = n;
+    }
+    if (emptyTop)
+        emptyTop->parent->child[emptyTop->quadrant].reset();
+}
+
+void SpatialIndex::insert(const std::shared_ptr<Shape>& s, const QRect& bounds)
+{
+    if (!s) return;
+    remove(s.get());
+    insertAt(targetNode(bounds, true), s, bounds);
+}
+
+void SpatialIndex::update(const Shape* s, const QRect& bounds)
+{
+    auto it = where.find(s);
+    if (it == where.end()) return;
+
+    // 仍属于同一个节点（例如小幅拖动）：原地更新包围盒
+    Location loc = it->second;
+    if (targetNode(bounds, false) == loc.node)
+    {
+        loc.node->items[loc.slot].bounds = bounds;
+        return;
+    }
+
+    std::shared_ptr<Shape> keep = loc.node->items[loc.slot].shape;
+    where.erase(it);
+    removeAt(loc);
+    insertAt(targetNode(bounds, true), keep, bounds);
+}
+
+void SpatialIndex::remove(const Shape* s)
+{
+    auto it = where.find(s);
+    if (it == where.end()) return;
+    Location loc = it->second;
+    where.erase(it);
+    removeAt(loc);
+}
+
+namespace {
+
+inline void appendResult(std::vector<Shape*>& out, const std::shared_ptr<Shape>& s) { out.push_back(s.get()); }
+inline void appendResult(std::vector<std::shared_ptr<Shape>>& out, const std::shared_ptr<Shape>& s) { out.push_back(s); }
+
+} // namespace
+
+template <class Out>
+void SpatialIndex::queryNode(const Node* node, const QRect& r, Out& out) const
+{
+    if (node->total == 0 || !node->loose.intersects(r)) return;
+    for (const Item& it : node->items)
+    {
+        if (it.bounds.intersects(r))
+            appendResult(out, it.shape);
+    }
+    for (const auto& c : node->child)
+    {
+        if (c)
+            queryNode(c.get(), r, out);
+    }
+}
+
+void SpatialIndex::query(const QRect& r, std::vector<Shape*>& out) const
+{
+    if (!r.isEmpty())
+        queryNode(root.get(), r, out);
+}
+
+void SpatialIndex::query(const QRect& r, std::vector<std::shared_ptr<Shape>>& out) const
+{
+    if (!r.isEmpty())
+        queryNode(root.get(), r, out);
+}
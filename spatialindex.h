@@ -0,0 +1,86 @@
+#ifndef SPATIALINDEX_H
+#define SPATIALINDEX_H
+
+#include <QRect>
+#include <vector>
+#include <memory>
+#include <unordered_map>
+#include <cstddef>
+
+class Shape;
+
+/**
+ * @brief SpatialIndex —— 按图元包围盒组织的松散四叉树（loose quadtree）
+ *
+ * 点选、框选、裁剪以及脏区域重绘都只关心与某个矩形相交的图元，
+ * 线性扫描全部图元在图元很多时代价与图元总数成正比。
+ *
+ * - 第 d 层节点的格子边长为 WORLD_SIZE >> d，松散边界向四周各扩展半个格子
+ * - 图元放在格子边长不小于其包围盒最大边长的最深一层、包围盒中心所在的格子里，
+ *   因此必然落在该节点的松散边界内；插入/删除/移动都只涉及一条根到叶的路径
+ * - 中心超出世界范围或包围盒为空的图元直接挂在根节点上
+ * - 每个节点记录子树中的图元个数，查询时跳过空子树，空子树在删除时释放
+ *
+ * 索引由 DrawEngine 在 addShape / removeShape / shapeChanged 时增量维护，键为图元指针，
+ * 同时持有图元的 shared_ptr，供工具查询后直接使用。
+ */
+class SpatialIndex
+{
+public:
+    SpatialIndex();
+    ~SpatialIndex();
+
+    // 登记图元；包围盒为空（不占据任何像素）的图元挂在根节点上，任何查询都不会返回它
+    void insert(const std::shared_ptr<Shape>& s, const QRect& bounds);
+    // 图元包围盒变化（未登记的图元忽略）
+    void update(const Shape* s, const QRect& bounds);
+    void remove(const Shape* s);
+    void clear();
+
+    // 把包围盒与 r 相交的图元追加到 out（顺序不定）
+    void query(const QRect& r, std::vector<Shape*>& out) const;
+    void query(const QRect& r, std::vector<std::shared_ptr<Shape>>& out) const;
+
+    std::size_t size() const { return where.size(); }
+
+private:
+    static constexpr int WORLD_SIZE = 1 << 22;                          // 根格子边长（像素），覆盖 ±2M
+    static constexpr int MIN_CELL = 64;                                 // 最深一层的格子边长
+
+    struct Item
+    {
+        std::shared_ptr<Shape> shape;
+        QRect bounds;
+    };
+
+    struct Node
+    {
+        int x = 0, y = 0, size = 0;                                     // 格子左上角与边长
+        QRect loose;                                                    // 松散边界
+        Node* parent = nullptr;
+        int quadrant = 0;                                               // 在父节点中的位置
+        std::size_t total = 0;                                          // 子树中的图元个数
+        std::vector<Item> items;
+        std::unique_ptr<Node> child[4];
+    };
+
+    struct Location
+    {
+        Node* node;
+        std::size_t slot;
+    };
+
+    // 图元应放入的节点；create 为 false 时不创建缺失的节点（返回 nullptr）
+    Node* targetNode(const QRect& bounds, bool create);
+    Node* makeChild(Node* parent, int q);
+    void insertAt(Node* node, const std::shared_ptr<Shape>& s, const QRect& bounds);
+    void removeAt(const Location& loc);
+
+    template <class Out>
+    void queryNode(const Node* node, const QRect& r, Out& out) const;
+
+    std::unique_ptr<Node> root;
+    std::unordered_map<const Shape*, Location> where;
+};
+
+#endif // SPATIALINDEX_H
@@ -0,0 +1,397 @@
+#include "stroker.h"
+#include "scanlinefiller.h"
+#include "drawengine.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <QtMath>
+
+namespace {
+
+double length(const QPointF& v)
+{
+    return std::sqrt(v.x() * v.x() + v.y() * v.y());
+}
+
+double cross(const QPointF& a, const QPointF& b)
+{
+    return a.x() * b.y() - a.y() * b.x();
+}
+
+// 半径 r 的圆弧分段数：弦高 r(1 - cos(θ/2)) <= 0.25
+int arcSegments(double r, double sweepRad)
+{
+    if (r <= 0.5) return std::max(1, int(std::ceil(std::abs(sweepRad) / (M_PI / 4))));
+    double step = 2.0 * std::acos(std::max(-1.0, 1.0 - 0.25 / r));
+    return std::max(1, int(std::ceil(std::abs(sweepRad) / step)));
+}
+
+} // namespace
+
+Stroker::Stroker(double width, LineCap c, LineJoin j)
+    : halfWidth(width * 0.5), cap(c), join(j)
+{
+    // 圆头线帽 / 圆角连接共用同一组圆周顶点，只计算一次
+    if (cap == LineCap::Round || join == LineJoin::Round)
+    {
+        int n = std::max(8, arcSegments(halfWidth, 2 * M_PI));
+        circle.reserve(n);
+        for (int i = 0; i < n; ++i)
+        {
+            double a = 2 * M_PI * i / n;
+            circle.emplace_back(halfWidth * std::cos(a), halfWidth * std::sin(a));
+        }
+    }
+}
+
+std::vector<QPointF> Stroker::arcPolyline(const QPointF& c, double r, double startDeg, double sweepDeg)
+{
+    double a0 = qDegreesToRadians(startDeg);
+    double sweep = qDegreesToRadians(sweepDeg);
+    int n = arcSegments(r, sweep);
+
+    std::vector<QPointF> pts;
+    pts.reserve(n + 1);
+    for (int i = 0; i <= n; ++i)
+    {
+        double a = a0 + sweep * i / n;
+        pts.emplace_back(c.x() + r * std::cos(a), c.y() + r * std::sin(a));
+    }
+    return pts;
+}
+
+double Stroker::polylineDistance(const std::vector<QPointF>& pts, bool closed, const QPointF& p)
+{
+    const std::size_t n = pts.size();
+    if (n == 0) return std::numeric_limits<double>::infinity();
+
+    double best = std::hypot(p.x() - pts[0].x(), p.y() - pts[0].y());
+    const std::size_t segments = closed ? n : n - 1;
+    for (std::size_t i = 0; i < segments; ++i)
+    {
+        const QPointF a = pts[i];
+        const QPointF d = pts[(i + 1) % n] - a;
+        const double len2 = d.x() * d.x() + d.y() * d.y();
+        double t = 0.0;
+        if (len2 > 0)
+            t = std::clamp(((p.x() - a.x()) * d.x() + (p.y() - a.y()) * d.y()) / len2, 0.0, 1.0);
+        best = std::min(best, std::hypot(p.x() - a.x() - d.x() * t, p.y() - a.y() - d.y() * t));
+    }
+    return best;
+}
+
+void Stroker::appendArc(const QPointF& c, double a0, double sweep) const
+{
+    // 取预计算圆周上角度严格位于 (a0, a0 + sweep) 内的顶点（sweep 可为负）
+    const int n = int(circle.size());
+    const double step = 2 * M_PI / n;
+    const double eps = 1e-9;
+    auto at = [&](long k) { return c + circle[((k % n) + n) % n]; };
+
+    if (sweep > 0)
+    {
+        for (long k = long(std::floor(a0 / step)) + 1; k * step < a0 + sweep - eps; ++k)
+            if (k * step > a0 + eps) scratch.push_back(at(k));
+    }
+    else
+    {
+        for (long k = long(std::ceil(a0 / step)) - 1; k * step > a0 + sweep + eps; --k)
+            if (k * step < a0 - eps) scratch.push_back(at(k));
+    }
+}
+
+void Stroker::flushScratch(ScanlineFiller& out) const
+{
+    // 统一为正向环绕后加入填充器（非零规则下所有部件取并集）
+    double area = 0;
+    for (size_t i = 0, j = scratch.size() - 1; i < scratch.size(); j = i++)
+        area += cross(scratch[j], scratch[i]);
+    if (area < 0)
+        std::reverse(scratch.begin(), scratch.end());
+    out.addContour(scratch);
+    scratch.clear();
+}
+
+void Stroker::addSegment(const QPointF& a, const QPointF& b, bool capStart, bool capEnd,
+                         ScanlineFiller& out) const
+{
+    QPointF d = b - a;
+    double len = length(d);
+    if (len <= 0) return;
+    QPointF u(d.x() / len * halfWidth, d.y() / len * halfWidth);        // 沿线方向，长 halfWidth
+    QPointF n(-u.y(), u.x());                                           // 法线方向，长 halfWidth
+    double an = std::atan2(n.y(), n.x());                               // +n 的角度
+
+    // 线帽并入线段轮廓（凸多边形）：a+n -> b+n -> [终点线帽] -> b-n -> a-n -> [起点线帽]
+    scratch.clear();
+    scratch.push_back(a + n);
+    scratch.push_back(b + n);
+    if (capEnd && cap == LineCap::Square)
+    {
+        scratch.push_back(b + n + u);
+        scratch.push_back(b - n + u);
+    }
+    else if (capEnd && cap == LineCap::Round)
+        appendArc(b, an, -M_PI);                                        // 从 +n 经 +u 转到 -n
+    scratch.push_back(b - n);
+    scratch.push_back(a - n);
+    if (capStart && cap == LineCap::Square)
+    {
+        scratch.push_back(a - n - u);
+        scratch.push_back(a + n - u);
+    }
+    else if (capStart && cap == LineCap::Round)
+        appendArc(a, an - M_PI, -M_PI);                                 // 从 -n 经 -u 转到 +n
+    flushScratch(out);
+}
+
+void Stroker::addDot(const QPointF& p, ScanlineFiller& out) const
+{
+    // 零长度路径：只有线帽（圆点或方块）
+    scratch.clear();
+    if (cap == LineCap::Round)
+    {
+        for (const QPointF& d : circle)
+            scratch.push_back(p + d);
+    }
+    else if (cap == LineCap::Square)
+    {
+        scratch.push_back(p + QPointF(-halfWidth, -halfWidth));
+        scratch.push_back(p + QPointF(halfWidth, -halfWidth));
+        scratch.push_back(p + QPointF(halfWidth, halfWidth));
+        scratch.push_back(p + QPointF(-halfWidth, halfWidth));
+    }
+    if (!scratch.empty())
+        flushScratch(out);
+}
+
+void Stroker::addJoin(const QPointF& prev, const QPointF& v, const QPointF& next, ScanlineFiller& out) const
+{
+    QPointF d1 = v - prev, d2 = next - v;
+    double l1 = length(d1), l2 = length(d2);
+    if (l1 <= 0 || l2 <= 0) return;
+    d1 /= l1;
+    d2 /= l2;
+
+    double turn = cross(d1, d2);
+    if (std::abs(turn) < 1e-12 && QPointF::dotProduct(d1, d2) > 0)
+        return;                                                         // 共线同向：相邻线段矩形已经相接
+
+    // 外侧是转向的反方向
+    double side = turn > 0 ? -1.0 : 1.0;
+    QPointF n1(-d1.y() * halfWidth * side, d1.x() * halfWidth * side);
+    QPointF n2(-d2.y() * halfWidth * side, d2.x() * halfWidth * side);
+
+    scratch.clear();
+    scratch.push_back(v);
+    scratch.push_back(v + n1);
+
+    if (join == LineJoin::Round)
+    {
+        // 外侧扇形：从 n1 沿较短方向转到 n2
+        double a1 = std::atan2(n1.y(), n1.x());
+        double delta = std::atan2(n2.y(), n2.x()) - a1;
+        while (delta > M_PI) delta -= 2 * M_PI;
+        while (delta <= -M_PI) delta += 2 * M_PI;
+        appendArc(v, a1, delta);
+    }
+    else if (join == LineJoin::Miter)
+    {
+        // 斜接点：两条外侧偏移线的交点，距顶点 halfWidth / cos(θ/2)
+        QPointF bis = n1 + n2;
+        double bl = length(bis);
+        double cosHalf = bl / (2 * halfWidth);
+        if (bl > 0 && cosHalf > 1.0 / MITER_LIMIT)
+            scratch.push_back(v + bis * (halfWidth / cosHalf / bl));
+        // 超过斜接上限时退化为斜切
+    }
+
+    scratch.push_back(v + n2);
+    flushScratch(out);
+}
+
+void Stroker::strokeSolid(const std::vector<QPointF>& input, bool closed, ScanlineFiller& out) const
+{
+    // 去掉连续重复点
+    std::vector<QPointF> pts;
+    pts.reserve(input.size());
+    for (const QPointF& p : input)
+        if (pts.empty() || p != pts.back())
+            pts.push_back(p);
+    if (closed && pts.size() > 1 && pts.front() == pts.back())
+        pts.pop_back();
+
+    int n = int(pts.size());
+    if (n == 0) return;
+    if (n == 1)
+    {
+        addDot(pts[0], out);
+        return;
+    }
+    if (closed && n < 3) closed = false;
+
+    if (curve && strokeCurve(pts, closed, out))
+        return;
+
+    if (closed)
+    {
+        for (int i = 0; i < n; ++i)
+        {
+            addSegment(pts[i], pts[(i + 1) % n], false, false, out);
+            addJoin(pts[(i + n - 1) % n], pts[i], pts[(i + 1) % n], out);
+        }
+        return;
+    }
+
+    for (int i = 0; i + 1 < n; ++i)
+        addSegment(pts[i], pts[i + 1], i == 0, i + 2 == n, out);
+    for (int i = 1; i + 1 < n; ++i)
+        addJoin(pts[i - 1], pts[i], pts[i + 1], out);
+}
+
+/**
+ * @brief 曲线的整体偏移轮廓
+ * 顶点处的偏移方向取相邻两段法线的角平分线，长度 halfWidth / cos(θ/2)，使偏移线与两段都平行
+ * 局部曲率半径（较短的相邻段长 / 转角）小于 halfWidth 时内侧偏移线自交，转角超过 60° 时不再是光滑曲线，
+ * 两种情况都返回 false 由调用方逐段描边
+ */
+bool Stroker::strokeCurve(const std::vector<QPointF>& pts, bool closed, ScanlineFiller& out) const
+{
+    const int n = int(pts.size());
+    const int segs = closed ? n : n - 1;
+    if (segs < 1) return false;
+
+    std::vector<QPointF> dirs(segs);                                    // 各段单位方向
+    std::vector<double> lens(segs);
+    for (int i = 0; i < segs; ++i)
+    {
+        const QPointF d = pts[(i + 1) % n] - pts[i];
+        lens[i] = length(d);
+        if (lens[i] <= 0) return false;
+        dirs[i] = d / lens[i];
+    }
+
+    const double minCosHalf = std::cos(M_PI / 6);
+    std::vector<QPointF> offsets(n);
+    for (int i = 0; i < n; ++i)
+    {
+        const int in = closed ? (i + segs - 1) % segs : std::max(0, i - 1);
+        const int outSeg = closed ? i : std::min(i, segs - 1);
+        const QPointF nIn(-dirs[in].y(), dirs[in].x());
+        const QPointF nOut(-dirs[outSeg].y(), dirs[outSeg].x());
+        const QPointF bis = nIn + nOut;
+        const double bl = length(bis);
+        const double cosHalf = bl / 2;                                  // |nIn + nOut| = 2cos(θ/2)
+        if (cosHalf < minCosHalf) return false;
+        if (in != outSeg)
+        {
+            const double turn = 2 * std::acos(std::min(1.0, cosHalf));
+            if (turn > 0 && std::min(lens[in], lens[outSeg]) / turn < halfWidth) return false;
+        }
+        offsets[i] = bis * (halfWidth / cosHalf / bl);
+    }
+
+    scratch.clear();
+    if (closed)
+    {
+        // 外环与反向的内环：环内部的环绕数为 0
+        for (int i = 0; i < n; ++i)
+            scratch.push_back(pts[i] + offsets[i]);
+        out.addContour(scratch);
+        scratch.clear();
+        for (int i = n - 1; i >= 0; --i)
+            scratch.push_back(pts[i] - offsets[i]);
+        out.addContour(scratch);
+        scratch.clear();
+        return true;
+    }
+
+    const QPointF uEnd = dirs[segs - 1] * halfWidth, nEnd(-uEnd.y(), uEnd.x());
+    const QPointF uStart = dirs[0] * halfWidth, nStart(-uStart.y(), uStart.x());
+    const QPointF& last = pts[n - 1];
+    const QPointF& first = pts[0];
+
+    for (int i = 0; i < n; ++i)
+        scratch.push_back(pts[i] + offsets[i]);
+    if (cap == LineCap::Square)
+    {
+        scratch.push_back(last + nEnd + uEnd);
+        scratch.push_back(last - nEnd + uEnd);
+    }
+    else if (cap == LineCap::Round)
+        appendArc(last, std::atan2(nEnd.y(), nEnd.x()), -M_PI);
+    for (int i = n - 1; i >= 0; --i)
+        scratch.push_back(pts[i] - offsets[i]);
+    if (cap == LineCap::Square)
+    {
+        scratch.push_back(first - nStart - uStart);
+        scratch.push_back(first + nStart - uStart);
+    }
+    else if (cap == LineCap::Round)
+        appendArc(first, std::atan2(nStart.y(), nStart.x()) - M_PI, -M_PI);
+    flushScratch(out);
+    return true;
+}
+
+void Stroker::stroke(const std::vector<QPointF>& pts, bool closed,
+                     LineStyle style, int dashOffset, ScanlineFiller& out) const
+{
+    if (style == LineStyle::Solid || pts.empty())
+    {
+        strokeSolid(pts, closed, out);
+        return;
+    }
+
+    // 按节奏表切分：第 k 格覆盖路径长度 [k*cell, (k+1)*cell)，格内画/不画由 pattern[(k + offset) % len] 决定
+    int plen = 0;
+    const int* pattern = DrawEngine::linePattern(style, plen);
+    const double cell = std::max(1.0, 2 * halfWidth);
+
+    std::vector<QPointF> path = pts;
+    if (closed && path.size() > 1)
+        path.push_back(path.front());
+
+    auto isOn = [&](long long k) {
+        long long idx = (k + dashOffset) % plen;
+        if (idx < 0) idx += plen;
+        return pattern[idx] != 0;
+    };
+
+    std::vector<QPointF> dash;
+    double dist = 0;                                                    // 当前线段起点处的累计长度
+    long long k = 0;                                                    // 当前格编号
+    bool on = isOn(0);
+    if (on) dash.push_back(path[0]);
+
+    for (size_t i = 0; i + 1 < path.size(); ++i)
+    {
+        QPointF a = path[i], b = path[i + 1];
+        double segLen = length(b - a);
+        if (segLen <= 0) continue;
+
+        // 依次处理落在本线段内的格边界
+        while ((k + 1) * cell < dist + segLen)
+        {
+            ++k;
+            double t = (k * cell - dist) / segLen;
+            QPointF p = a + (b - a) * t;
+            bool nextOn = isOn(k);
+            if (on && !nextOn)
+            {
+                dash.push_back(p);
+                strokeSolid(dash, false, out);
+                dash.clear();
+            }
+            else if (!on && nextOn)
+                dash.push_back(p);
+            on = nextOn;
+        }
+
+        if (on) dash.push_back(b);
+        dist += segLen;
+    }
+
+    if (on && !dash.empty())
+        strokeSolid(dash, false, out);
+}
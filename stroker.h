@@ -0,0 +1,74 @@
+#ifndef STROKER_H
+#define STROKER_H
+
+#include <QPointF>
+#include <vector>
+#include "shape.h"
+
+class ScanlineFiller;
+
+/**
+ * @brief Stroker —— 把折线描边转换为填充轮廓
+ *
+ * 线宽为 width 的描边由以下凸多边形部件的并集构成（统一为正向环绕，用非零规则填充即得并集）：
+ *  - 每条线段：沿法线方向偏移 ±width/2 的矩形；
+ *  - 开放折线两端的线帽并入首尾线段的多边形：Flat 无、Square 外延 width/2、Round 半圆；
+ *  - 折线内部顶点（闭合折线的所有顶点）处外侧的连接：
+ *      Miter 斜接（尖角超过 MITER_LIMIT 时退化为 Bevel）、Bevel 斜切三角形、Round 扇形。
+ *
+ * 线型（虚线等）按路径长度切分：与 DrawEngine::shouldDrawAtStep 相同的节奏表，
+ * 每格长度为 width 像素，切出的每一段单独加线帽。
+ *
+ * 曲线模式（setCurve）用于圆弧 / 椭圆弧这类相邻段夹角很小的折线：每段实线生成一个整体轮廓
+ * （外侧偏移线 -> 终点线帽 -> 反向的内侧偏移线 -> 起点线帽，整圆为内外两个环），部件之间不重叠，
+ * 供覆盖率光栅化使用；曲率半径小于半线宽（内侧偏移线会自交）或转角过大时退回逐段部件。
+ */
+class Stroker
+{
+public:
+    // 斜接长度上限（相对半线宽），超过时改用斜切连接
+    static constexpr double MITER_LIMIT = 4.0;
+
+    Stroker(double width, LineCap cap, LineJoin join);
+
+    // 曲线模式开关（默认关闭）
+    void setCurve(bool on) { curve = on; }
+
+    // 描边折线，部件轮廓加入 out；closed 为 true 时首尾相连（无线帽）
+    void stroke(const std::vector<QPointF>& pts, bool closed,
+                LineStyle style, int dashOffset, ScanlineFiller& out) const;
+
+    // 圆弧折线化：圆心 c、半径 r，从 startDeg 起扫过 sweepDeg（y 轴向下，角度顺时针增加）
+    // 分段数保证弦高误差不超过 1/4 像素
+    static std::vector<QPointF> arcPolyline(const QPointF& c, double r, double startDeg, double sweepDeg);
+
+    // 点 p 到折线的最短距离（曲线图元点选用）；closed 为 true 时包含末点到首点的一段
+    static double polylineDistance(const std::vector<QPointF>& pts, bool closed, const QPointF& p);
+
+private:
+    // 实线描边
+    void strokeSolid(const std::vector<QPointF>& pts, bool closed, ScanlineFiller& out) const;
+    // 曲线模式下的整体偏移轮廓（pts 已去重），不适用时返回 false
+    bool strokeCurve(const std::vector<QPointF>& pts, bool closed, ScanlineFiller& out) const;
+
+    // 线段矩形，capStart / capEnd 为 true 时把对应端的线帽并入同一个凸多边形
+    void addSegment(const QPointF& a, const QPointF& b, bool capStart, bool capEnd, ScanlineFiller& out) const;
+    // 折线顶点处的连接（只补外侧）
+    void addJoin(const QPointF& prev, const QPointF& v, const QPointF& next, ScanlineFiller& out) const;
+    // 零长度路径的线帽
+    void addDot(const QPointF& p, ScanlineFiller& out) const;
+
+    // 向 scratch 追加圆周上角度位于 (a0, a0 + sweep) 内的顶点
+    void appendArc(const QPointF& c, double a0, double sweep) const;
+    // scratch 中的凸多边形统一为正向环绕后加入填充器
+    void flushScratch(ScanlineFiller& out) const;
+
+    double halfWidth;
+    LineCap cap;
+    LineJoin join;
+    bool curve = false;
+    std::vector<QPointF> circle;                                        // 圆形轮廓相对圆心的顶点偏移
+    mutable std::vector<QPointF> scratch;                               // 生成部件轮廓时复用的缓冲区
+};
+
+#endif // STROKER_H
@@ -135,6 +135,11 @@ TangramGame::TangramGame(DrawEngine* engine, QObject* parent)
     connect(&animationTimer, &QTimer::timeout, this, &TangramGame::onAnimationTick);
 }
 
+std::vector<QPointF> TangramGame::basePolygon(TangramPieceType type)
+{
+    return basePolygonFor(type);
+}
+
 void TangramGame::initialize()
 {
     ensurePiecesLoaded();
@@ -255,10 +260,17 @@ void TangramGame::scatter()
 
 std::shared_ptr<TangramPiece> TangramGame::pieceAt(const QPoint& canvasPos) const
 {
-    for (int i = static_cast<int>(piecesStorage.size()) - 1; i >= 0; --i)
+    if (!drawEngine) return nullptr;
+
+    // 引擎的空间索引按绘制顺序给出覆盖该点的图元，从最上层开始找属于本局的拼块
+    const QRect probe(canvasPos, QSize(1, 1));
+    auto candidates = drawEngine->shapesInRect(probe);
+    for (auto it = candidates.rbegin(); it != candidates.rend(); ++it)
     {
-        const auto& piece = piecesStorage[static_cast<std::size_t>(i)];
-        if (piece && piece->contains(canvasPos))
+        if ((*it)->kind() != ShapeKind::TangramPiece)
+            continue;
+        auto piece = std::static_pointer_cast<TangramPiece>(*it);
+        if (indexOfPiece(piece) >= 0 && piece->contains(canvasPos))
             return piece;
     }
     return nullptr;
@@ -267,8 +279,7 @@ std::shared_ptr<TangramPiece> TangramGame::pieceAt(const QPoint& canvasPos) cons
 void TangramGame::bringToFront(const std::shared_ptr<TangramPiece>& piece)
 {
     if (!drawEngine || !piece) return;
-    if (drawEngine->removeShape(piece))
-        drawEngine->addShape(piece);
+    drawEngine->bringToFront(piece);
 }
 
 bool TangramGame::snapPieceToTarget(const std::shared_ptr<TangramPiece>& piece,
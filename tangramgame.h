@@ -37,6 +37,9 @@ public:
     void stopDemo();
     bool isAnimating() const { return demoPhase != DemoPhase::Idle; }
 
+    // 拼板的局部坐标基础多边形（场景文件加载时用于重建拼板）
+    static std::vector<QPointF> basePolygon(TangramPieceType type);
+
 signals:
     void requestCanvasUpdate();
 
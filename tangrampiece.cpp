@@ -15,7 +15,8 @@ inline QPointF rotatePoint(const QPointF& p, double angleDeg)
 }
 
 TangramPiece::TangramPiece(TangramPieceType t, const std::vector<QPointF>& baseVerts)
-    : type(t),
+    : PolygonShape(ShapeKind::TangramPiece),
+      type(t),
       baseVertices(baseVerts),
       position(0.0, 0.0),
       rotationDeg(0.0),
@@ -79,8 +80,8 @@ void TangramPiece::setFlipped(bool value)
 
 void TangramPiece::rebuildVertices()
 {
-    vertices.clear();
-    vertices.reserve(static_cast<int>(baseVertices.size()));
+    std::vector<QPoint> pts;
+    pts.reserve(baseVertices.size());
 
     for (const auto& v : baseVertices)
     {
@@ -90,8 +91,11 @@ void TangramPiece::rebuildVertices()
 
         QPointF rotated = rotatePoint(local, rotationDeg);
         QPointF world = rotated + position;
-        vertices.emplace_back(qRound(world.x()), qRound(world.y()));
+        pts.emplace_back(qRound(world.x()), qRound(world.y()));
     }
+    setVertices(std::move(pts));                                               // 姿态即源几何，不累积变换
+
+    invalidate();                                                              // 姿态变化：通知引擎重绘新旧位置
 }
 
 QPointF TangramPiece::computePolygonCentroid(const std::vector<QPointF>& pts) const
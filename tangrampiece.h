@@ -43,6 +43,9 @@ public:
 
     QPointF currentCentroid() const { return position; }
 
+protected:
+    std::shared_ptr<Shape> cloneShape() const override { resolve(); return std::make_shared<TangramPiece>(*this); }
+
 private:
     void rebuildVertices();
     QPointF computePolygonCentroid(const std::vector<QPointF>& pts) const;
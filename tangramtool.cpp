@@ -170,7 +170,7 @@ void TangramTool::drawOverlay(QPainter* painter, QWidget* widget)
         painter->save();
         painter->setPen(QPen(Qt::darkBlue, 2, Qt::DashLine));
 
-        const auto& verts = highlight->vertices;
+        const auto& verts = highlight->vertices();
         if (!verts.empty())
         {
             QPolygon poly;
@@ -212,7 +212,7 @@ bool TangramTool::hasOverlapWithOthers(const std::shared_ptr<TangramPiece>& piec
 
     auto buildPoly = [](const TangramPiece& p) {
         QPolygonF poly;
-        for (const auto& v : p.vertices)
+        for (const auto& v : p.vertices())
             poly << QPointF(v);
         return poly;
     };
@@ -0,0 +1,155 @@
+#include "tilerenderer.h"
+#include "drawengine.h"
+#include "shape.h"
+
+#include <QThread>
+#include <atomic>
+#include <algorithm>
+
+TileRenderer::TileRenderer()
+    : workerCount(std::max(1, QThread::idealThreadCount()))
+{
+    pool.setMaxThreadCount(workerCount);
+}
+
+TileRenderer::~TileRenderer()
+{
+    pool.waitForDone();
+}
+
+void TileRenderer::setThreadCount(int n)
+{
+    workerCount = std::max(1, n);
+    pool.setMaxThreadCount(workerCount);
+}
+
+void TileRenderer::parallelFor(int count, const std::function<void(int, int)>& fn)
+{
+    if (count <= 0) return;
+
+    std::atomic<int> next(0);
+    auto run = [&](int worker) {
+        for (int i = next.fetch_add(1); i < count; i = next.fetch_add(1))
+            fn(i, worker);
+    };
+
+    int helpers = std::min(workerCount, count) - 1;
+    for (int w = 1; w <= helpers; ++w)
+        pool.start([&run, w]() { run(w); });
+
+    run(0);
+    pool.waitForDone();
+}
+
+void TileRenderer::prepareWorkers(DrawEngine& engine)
+{
+    while ((int)workers.size() < workerCount)
+        workers.push_back(std::make_unique<DrawEngine>(0, 0));
+
+    for (auto& w : workers)
+        w->attachView(engine);
+}
+
+void TileRenderer::render(DrawEngine& engine, const std::vector<QRect>& rects)
+{
+    if (rects.empty()) return;
+    prepareWorkers(engine);
+
+    // 1) 与任一脏矩形相交的图元（保持绘制顺序）
+    std::vector<Shape*> shapes;
+    engine.collectShapes(rects, shapes);
+
+    // 2) 取出缓存的 span；未命中的并行录制
+    //    spans 在本帧内持有 shared_ptr，缓存淘汰不会影响正在回放的数据
+    //    本身已是 span 形式的图元（cacheRaster() 为 false）不录制也不缓存，回放时在各 tile 中直接绘制
+    const int n = (int)shapes.size();
+    std::vector<std::shared_ptr<const SpanList>> spans(n);
+    std::vector<int> missing;
+    for (int i = 0; i < n; ++i)
+    {
+        Shape* s = shapes[i];
+        if (!s->cacheRaster())
+        {
+            s->recentlyChanged = false;
+            continue;
+        }
+        if (!s->recentlyChanged)
+            spans[i] = engine.rasterCache.find(s);
+        if (!spans[i])
+            missing.push_back(i);
+    }
+
+    parallelFor((int)missing.size(), [&](int k, int w) {
+        int i = missing[k];
+        spans[i] = workers[w]->recordShape(shapes[i]);
+    });
+
+    for (int i : missing)
+    {
+        Shape* s = shapes[i];
+        if (s->recentlyChanged)
+            s->recentlyChanged = false;                 // 编辑中的图元本帧不缓存
+        else if (engine.rasterCache.budget() > 0)
+            engine.rasterCache.insert(s, spans[i]);
+    }
+
+    // 3) 按 tile 分箱
+    const QRect canvasRect(0, 0, engine.canvasW, engine.canvasH);
+    const int tilesX = (engine.canvasW + TILE_SIZE - 1) / TILE_SIZE;
+    const int tilesY = (engine.canvasH + TILE_SIZE - 1) / TILE_SIZE;
+    if (tilesX <= 0 || tilesY <= 0) return;
+
+    std::vector<std::vector<int>> bins(tilesX * tilesY);
+    for (int i = 0; i < n; ++i)
+    {
+        QRect b = shapes[i]->paintedBounds.intersected(canvasRect);
+        if (b.isEmpty()) continue;
+        for (int ty = b.top() / TILE_SIZE; ty <= b.bottom() / TILE_SIZE; ++ty)
+            for (int tx = b.left() / TILE_SIZE; tx <= b.right() / TILE_SIZE; ++tx)
+                bins[ty * tilesX + tx].push_back(i);
+    }
+
+    // 工作项：一个 tile 及其与各脏矩形的交集
+    // 同一 tile 内的所有裁剪区域由同一个线程依次处理，不同 tile 的内存互不相交
+    std::vector<std::vector<QRect>> clipsPerTile(tilesX * tilesY);
+    for (const QRect& r0 : rects)
+    {
+        QRect r = r0.intersected(canvasRect);
+        if (r.isEmpty()) continue;
+        for (int ty = r.top() / TILE_SIZE; ty <= r.bottom() / TILE_SIZE; ++ty)
+        {
+            for (int tx = r.left() / TILE_SIZE; tx <= r.right() / TILE_SIZE; ++tx)
+            {
+                QRect tile(tx * TILE_SIZE, ty * TILE_SIZE, TILE_SIZE, TILE_SIZE);
+                clipsPerTile[ty * tilesX + tx].push_back(r.intersected(tile));
+            }
+        }
+    }
+
+    std::vector<int> items;
+    for (int t = 0; t < (int)clipsPerTile.size(); ++t)
+        if (!clipsPerTile[t].empty())
+            items.push_back(t);
+
+    // 4) 并行回放
+    parallelFor((int)items.size(), [&](int k, int w) {
+        const int tile = items[k];
+        DrawEngine& view = *workers[w];
+        for (const QRect& clip : clipsPerTile[tile])
+        {
+            view.setClipRect(clip);
+            for (int y = view.clipY0; y <= view.clipY1; ++y)
+                view.fillSpan(y, view.clipX0, view.clipX1, engine.background);
+
+            for (int i : bins[tile])
+            {
+                if (!shapes[i]->paintedBounds.intersects(clip))
+                    continue;
+                if (spans[i])
+                    view.blitSpans(*spans[i]);
+                else
+                    shapes[i]->draw(&view);                     // 只写 clip 内的行（draw 按 currentClip() 截取）
+            }
+        }
+    });
+}
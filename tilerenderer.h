@@ -0,0 +1,52 @@
+#ifndef TILERENDERER_H
+#define TILERENDERER_H
+
+#include <QRect>
+#include <QThreadPool>
+#include <vector>
+#include <memory>
+#include <functional>
+
+class DrawEngine;
+
+/**
+ * @brief TileRenderer —— 多线程分块重绘
+ *
+ * 把画布按固定大小切成 tile，在线程池上并行重绘脏区域：
+ * 1. 收集与脏区域相交的图元（保持 shapes 顺序）；
+ * 2. 并行把缓存未命中的图元录制为 span 列表（每个图元只由一个线程光栅化），
+ *    随后在调用线程中写入 RasterCache；本身已是 span 形式的图元（cacheRaster() 为 false）跳过这一步；
+ * 3. 按 tile 分箱：每个 tile 得到与其相交的图元下标列表（仍按 shapes 顺序）；
+ * 4. 并行处理 (tile ∩ 脏矩形)：清空背景并按顺序回放 span，cacheRaster() 为 false 的图元
+ *    以该裁剪矩形直接 draw()，只写本块内的行。
+ *    各工作项的裁剪区域互不重叠，因此写入的是互不相交的画布内存，无需加锁。
+ *
+ * 回放的 span 与串行路径完全相同、顺序相同，输出与串行路径逐像素一致。
+ */
+class TileRenderer
+{
+public:
+    static const int TILE_SIZE = 128;
+
+    TileRenderer();
+    ~TileRenderer();
+
+    // 重绘 engine 画布上的 rects（互不重叠的脏矩形）
+    void render(DrawEngine& engine, const std::vector<QRect>& rects);
+
+    int threadCount() const { return workerCount; }
+    void setThreadCount(int n);
+
+private:
+    // 在 [0, count) 上并行执行 fn(index, workerIndex)，调用线程也参与
+    void parallelFor(int count, const std::function<void(int, int)>& fn);
+
+    // 保证每个工作线程都有一个附着在 engine 画布上的 DrawEngine 视图
+    void prepareWorkers(DrawEngine& engine);
+
+    QThreadPool pool;
+    int workerCount;
+    std::vector<std::unique_ptr<DrawEngine>> workers;
+};
+
+#endif // TILERENDERER_H